@@ -44,6 +44,7 @@ THE SOFTWARE.
 #include "MPU6050.h"
 #include "i2cdev_chibi.h"
 #include "chprintf.h"
+#include "helper_dmpimage.h"
 
 // for memcmp
 #include <string.h>
@@ -53,9 +54,25 @@ THE SOFTWARE.
 */
 uint8_t MPUdevAddr;
 uint8_t MPUbuffer[14];
+#if MPU6050_STATIC_SCRATCH
+uint8_t *MPUscratch;        // see MPUsetScratch()
+#endif
 			
 uint16_t MPUfifoCount;     	// count of all bytes currently in FIFO
 uint8_t  MPUfifoBuffer[64];	// FIFO storage buffer
+uint8_t  MPUverifyBuffer[MPU6050_DMP_MEMORY_CHUNK_SIZE];	// memory block readback
+
+// full-scale ranges as last written through MPUsetFullScale*Range() (power-on
+// default is 0) and the matching SI scale factors, so unit conversion never
+// has to read GYRO_CONFIG/ACCEL_CONFIG back over the bus
+uint8_t MPUgyroRange = MPU6050_GYRO_FS_250;
+uint8_t MPUaccelRange = MPU6050_ACCEL_FS_2;
+float MPUgyroScale = MPU6050_DEG_TO_RAD / 131.0f;
+float MPUaccelScale = MPU6050_STANDARD_GRAVITY / 16384.0f;
+
+// byte offsets of the magnetometer X/Y/Z words in EXT_SENS_DATA, set up by
+// MPUmagInitialize() (the HMC5883L for one outputs X, Z, Y)
+uint8_t MPUmagAxisOffset[3] = { 0, 2, 4 };
 
 /** Default constructor, uses default I2C address.
  * @see MPU6050_DEFAULT_ADDRESS
@@ -74,6 +91,16 @@ void MPU6050(uint8_t address) {
     MPUdevAddr = address;
 }
 
+#if MPU6050_STATIC_SCRATCH
+/** Supply the burst read buffers, see MPU6050_STATIC_SCRATCH.
+ * Call once before any other driver function that reads more than a word.
+ * @param arena Buffer of exactly MPU6050_SCRATCH_SIZE bytes, e.g. &buffer for a static array
+ */
+void MPUsetScratch(uint8_t (*arena)[MPU6050_SCRATCH_SIZE]) {
+    MPUscratch = *arena;
+}
+#endif
+
 /** Power on and prepare for general usage.
  * This will activate the device and take it out of sleep mode (which must be done
  * after start-up). This function also sets both the accelerometer and the gyroscope
@@ -263,6 +290,8 @@ uint8_t MPUgetFullScaleGyroRange() {
     return MPUbuffer[0];
 }
 /** Set full-scale gyroscope range.
+ * The cached scale follows only if the write succeeds, so it keeps
+ * matching the range the device actually uses.
  * @param range New full-scale gyroscope range value
  * @see getFullScaleRange()
  * @see MPU6050_GYRO_FS_250
@@ -271,7 +300,9 @@ uint8_t MPUgetFullScaleGyroRange() {
  * @see MPU6050_GCONFIG_FS_SEL_LENGTH
  */
 void MPUsetFullScaleGyroRange(uint8_t range) {
-    I2CdevwriteBits(MPUdevAddr, MPU6050_RA_GYRO_CONFIG, MPU6050_GCONFIG_FS_SEL_BIT, MPU6050_GCONFIG_FS_SEL_LENGTH, range);
+    if (!I2CdevwriteBits(MPUdevAddr, MPU6050_RA_GYRO_CONFIG, MPU6050_GCONFIG_FS_SEL_BIT, MPU6050_GCONFIG_FS_SEL_LENGTH, range)) return;
+    MPUgyroRange = range & 0x03;
+    MPUgyroScale = MPUgetGyroScaleForRange(MPUgyroRange);
 }
 
 // ACCEL_CONFIG register
@@ -343,11 +374,14 @@ uint8_t MPUgetFullScaleAccelRange() {
     return MPUbuffer[0];
 }
 /** Set full-scale accelerometer range.
+ * The cached scale follows only if the write succeeds.
  * @param range New full-scale accelerometer range setting
  * @see getFullScaleAccelRange()
  */
 void MPUsetFullScaleAccelRange(uint8_t range) {
-    I2CdevwriteBits(MPUdevAddr, MPU6050_RA_ACCEL_CONFIG, MPU6050_ACONFIG_AFS_SEL_BIT, MPU6050_ACONFIG_AFS_SEL_LENGTH, range);
+    if (!I2CdevwriteBits(MPUdevAddr, MPU6050_RA_ACCEL_CONFIG, MPU6050_ACONFIG_AFS_SEL_BIT, MPU6050_ACONFIG_AFS_SEL_LENGTH, range)) return;
+    MPUaccelRange = range & 0x03;
+    MPUaccelScale = MPUgetAccelScaleForRange(MPUaccelRange);
 }
 /** Get the high-pass filter configuration.
  * The DHPF is a filter module in the path leading to motion detectors (Free
@@ -1721,7 +1755,9 @@ bool_t MPUgetIntDataReadyStatus() {
 // ACCEL_*OUT_* registers
 
 /** Get raw 9-axis motion sensor readings (accel/gyro/compass).
- * FUNCTION NOT FULLY IMPLEMENTED YET.
+ * Reads ACCEL_XOUT_H through EXT_SENS_DATA_05 in one 20-byte burst, so the
+ * magnetometer has to be the first (or only) auxiliary sensor, set up by
+ * MPUmagInitialize(). Without it mx/my/mz hold whatever is in EXT_SENS_DATA.
  * @param ax 16-bit signed integer container for accelerometer X-axis value
  * @param ay 16-bit signed integer container for accelerometer Y-axis value
  * @param az 16-bit signed integer container for accelerometer Z-axis value
@@ -1735,10 +1771,20 @@ bool_t MPUgetIntDataReadyStatus() {
  * @see getAcceleration()
  * @see getRotation()
  * @see MPU6050_RA_ACCEL_XOUT_H
+ * @see MPUmagInitialize()
  */
 void MPUgetMotion9(int16_t* ax, int16_t* ay, int16_t* az, int16_t* gx, int16_t* gy, int16_t* gz, int16_t* mx, int16_t* my, int16_t* mz) {
-    MPUgetMotion6(ax, ay, az, gx, gy, gz);
-    // TODO: magnetometer integration
+    MPU_SCRATCH(buffer, MPU6050_SCRATCH_BURST, 20);
+    I2CdevreadBytes(MPUdevAddr, MPU6050_RA_ACCEL_XOUT_H, 20, buffer, I2CDEV_DEFAULT_READ_TIMEOUT);
+    *ax = (((int16_t)buffer[0]) << 8) | buffer[1];
+    *ay = (((int16_t)buffer[2]) << 8) | buffer[3];
+    *az = (((int16_t)buffer[4]) << 8) | buffer[5];
+    *gx = (((int16_t)buffer[8]) << 8) | buffer[9];
+    *gy = (((int16_t)buffer[10]) << 8) | buffer[11];
+    *gz = (((int16_t)buffer[12]) << 8) | buffer[13];
+    *mx = (((int16_t)buffer[14 + MPUmagAxisOffset[0]]) << 8) | buffer[15 + MPUmagAxisOffset[0]];
+    *my = (((int16_t)buffer[14 + MPUmagAxisOffset[1]]) << 8) | buffer[15 + MPUmagAxisOffset[1]];
+    *mz = (((int16_t)buffer[14 + MPUmagAxisOffset[2]]) << 8) | buffer[15 + MPUmagAxisOffset[2]];
 }
 /** Get raw 6-axis motion sensor readings (accel/gyro).
  * Retrieves all currently available motion sensor values.
@@ -1761,6 +1807,24 @@ void MPUgetMotion6(int16_t* ax, int16_t* ay, int16_t* az, int16_t* gx, int16_t*
     *gy = (((int16_t)MPUbuffer[10]) << 8) | MPUbuffer[11];
     *gz = (((int16_t)MPUbuffer[12]) << 8) | MPUbuffer[13];
 }
+/** Get raw 6-axis motion sensor readings and the die temperature.
+ * Same 14-byte burst as MPUgetMotion6(), the temperature registers sit between
+ * accel and gyro data anyway, so this costs no extra bus transaction compared
+ * to a separate MPUgetTemperature() call.
+ * @param ax 16-bit signed integer container for accelerometer X-axis value
+ * @param ay 16-bit signed integer container for accelerometer Y-axis value
+ * @param az 16-bit signed integer container for accelerometer Z-axis value
+ * @param gx 16-bit signed integer container for gyroscope X-axis value
+ * @param gy 16-bit signed integer container for gyroscope Y-axis value
+ * @param gz 16-bit signed integer container for gyroscope Z-axis value
+ * @param t 16-bit signed integer container for the raw TEMP_OUT value
+ * @see MPUgetMotion6()
+ * @see MPUgetTemperature()
+ */
+void MPUgetMotion6Temp(int16_t* ax, int16_t* ay, int16_t* az, int16_t* gx, int16_t* gy, int16_t* gz, int16_t* t) {
+    MPUgetMotion6(ax, ay, az, gx, gy, gz);
+    *t = (((int16_t)MPUbuffer[6]) << 8) | MPUbuffer[7];
+}
 /** Get 3-axis accelerometer readings.
  * These registers store the most recent accelerometer measurements.
  * Accelerometer measurements are written to these registers at the Sample Rate
@@ -1786,10 +1850,10 @@ void MPUgetMotion6(int16_t* ax, int16_t* ay, int16_t* az, int16_t* gx, int16_t*
  * <pre>
  * AFS_SEL | Full Scale Range | LSB Sensitivity
  * --------+------------------+----------------
- * 0       | +/- 2g           | 8192 LSB/mg
- * 1       | +/- 4g           | 4096 LSB/mg
- * 2       | +/- 8g           | 2048 LSB/mg
- * 3       | +/- 16g          | 1024 LSB/mg
+ * 0       | +/- 2g           | 16384 LSB/g
+ * 1       | +/- 4g           | 8192 LSB/g
+ * 2       | +/- 8g           | 4096 LSB/g
+ * 3       | +/- 16g          | 2048 LSB/g
  * </pre>
  *
  * @param x 16-bit signed integer container for X-axis acceleration
@@ -2379,6 +2443,11 @@ void MPUresetSensors() {
  */
 void MPUreset() {
     I2CdevwriteBit(MPUdevAddr, MPU6050_RA_PWR_MGMT_1, MPU6050_PWR1_DEVICE_RESET_BIT, TRUE);
+    // registers are back at their power-on values
+    MPUgyroRange = MPU6050_GYRO_FS_250;
+    MPUaccelRange = MPU6050_ACCEL_FS_2;
+    MPUgyroScale = MPUgetGyroScaleForRange(MPUgyroRange);
+    MPUaccelScale = MPUgetAccelScaleForRange(MPUaccelRange);
 }
 /** Get sleep mode status.
  * Setting the SLEEP bit in the register puts the device into very low power
@@ -2733,6 +2802,93 @@ void MPUsetDeviceID(uint8_t id) {
     I2CdevwriteBits(MPUdevAddr, MPU6050_RA_WHO_AM_I, MPU6050_WHO_AM_I_BIT, MPU6050_WHO_AM_I_LENGTH, id);
 }
 
+// ======== UNIT CONVERSION (cached full-scale ranges) ========
+
+// sensitivity in LSB per deg/s (gyro) and LSB per g (accel), indexed by FS_SEL/AFS_SEL
+static const float MPUgyroLSB[4] = { 131.0f, 65.5f, 32.8f, 16.4f };
+static const float MPUaccelLSB[4] = { 16384.0f, 8192.0f, 4096.0f, 2048.0f };
+
+/** Get gyroscope scale factor for a full-scale setting.
+ * @param range Full-scale gyroscope range (MPU6050_GYRO_FS_*)
+ * @return Angular rate in rad/s per LSB
+ */
+float MPUgetGyroScaleForRange(uint8_t range) {
+    return MPU6050_DEG_TO_RAD / MPUgyroLSB[range & 0x03];
+}
+/** Get accelerometer scale factor for a full-scale setting.
+ * @param range Full-scale accelerometer range (MPU6050_ACCEL_FS_*)
+ * @return Acceleration in m/s^2 per LSB
+ */
+float MPUgetAccelScaleForRange(uint8_t range) {
+    return MPU6050_STANDARD_GRAVITY / MPUaccelLSB[range & 0x03];
+}
+/** Get cached gyroscope scale factor.
+ * Tracks MPUsetFullScaleGyroRange(), no bus access.
+ * @return Angular rate in rad/s per LSB
+ */
+float MPUgetGyroScale() {
+    return MPUgyroScale;
+}
+/** Get cached accelerometer scale factor.
+ * Tracks MPUsetFullScaleAccelRange(), no bus access.
+ * @return Acceleration in m/s^2 per LSB
+ */
+float MPUgetAccelScale() {
+    return MPUaccelScale;
+}
+/** Re-read GYRO_CONFIG and ACCEL_CONFIG into the scale cache.
+ * Only needed if the ranges were changed without MPUsetFullScale*Range(),
+ * e.g. by another driver or after attaching to an already running sensor.
+ */
+void MPUrefreshScaleCache() {
+    MPUgyroRange = MPUgetFullScaleGyroRange();
+    MPUaccelRange = MPUgetFullScaleAccelRange();
+    MPUgyroScale = MPUgetGyroScaleForRange(MPUgyroRange);
+    MPUaccelScale = MPUgetAccelScaleForRange(MPUaccelRange);
+}
+/** Convert a block of raw accelerometer counts to m/s^2.
+ * Works on any flat array (e.g. count/3 interleaved x/y/z samples); the loop
+ * is a single multiply per element so the compiler can vectorize it.
+ * @param raw Raw counts
+ * @param out Output in m/s^2 (may not alias raw)
+ * @param count Number of values
+ */
+void MPUconvertAccelBlock(const int16_t *raw, float *out, uint32_t count) {
+    const float scale = MPUaccelScale;
+    uint32_t i;
+    for (i = 0; i < count; i++) out[i] = raw[i] * scale;
+}
+/** Convert a block of raw gyroscope counts to rad/s.
+ * @param raw Raw counts
+ * @param out Output in rad/s (may not alias raw)
+ * @param count Number of values
+ * @see MPUconvertAccelBlock()
+ */
+void MPUconvertGyroBlock(const int16_t *raw, float *out, uint32_t count) {
+    const float scale = MPUgyroScale;
+    uint32_t i;
+    for (i = 0; i < count; i++) out[i] = raw[i] * scale;
+}
+/** Convert a block of raw 6-axis samples to SI units.
+ * Input and output are [ax, ay, az, gx, gy, gz] per sample, in the order
+ * returned by MPUgetMotion6().
+ * @param raw Raw counts, 6 per sample
+ * @param out Output, accel in m/s^2 and gyro in rad/s (may not alias raw)
+ * @param samples Number of samples
+ */
+void MPUconvertMotion6Block(const int16_t *raw, float *out, uint32_t samples) {
+    const float a = MPUaccelScale, g = MPUgyroScale;
+    uint32_t i;
+    for (i = 0; i < samples * 6; i += 6) {
+        out[i]     = raw[i]     * a;
+        out[i + 1] = raw[i + 1] * a;
+        out[i + 2] = raw[i + 2] * a;
+        out[i + 3] = raw[i + 3] * g;
+        out[i + 4] = raw[i + 4] * g;
+        out[i + 5] = raw[i + 5] * g;
+    }
+}
+
 // ======== UNDOCUMENTED/DMP REGISTERS/METHODS ========
 
 // XG_OFFS_TC register
@@ -3039,6 +3195,64 @@ bool_t MPUwriteMemoryBlock(const uint8_t *data, uint16_t dataSize, uint8_t bank,
 bool_t MPUwriteProgMemoryBlock(const uint8_t *data, uint16_t dataSize, uint8_t bank, uint8_t address, bool_t verify) {
     return MPUwriteMemoryBlock(data, dataSize, bank, address, verify, TRUE);
 }
+/** Unpack a DMP memory image (helper_dmpimage.h) straight into DMP memory.
+ * The image is decoded one MPU6050_DMP_MEMORY_CHUNK_SIZE chunk at a time,
+ * nothing larger than a chunk is held in RAM. Bank and start address go out
+ * in one transfer (BANK_SEL and MEM_START_ADDR are adjacent).
+ * With verify set, an all-zero chunk is read first and only written if the
+ * memory is not already zero, so the check replaces the write. Without
+ * verify the memory content is unknown and every chunk is written.
+ * @param image Packed image
+ * @param imageSize Packed length
+ * @param bank First memory bank
+ * @param address Start address in the first bank
+ * @param verify Read every chunk back and compare
+ * @return FALSE on a verify mismatch or a corrupt image (CRC checked at the end)
+ */
+bool_t MPUwritePackedMemoryBlock(const uint8_t *image, uint16_t imageSize, uint8_t bank, uint8_t address, bool_t verify) {
+    MPU_SCRATCH(chunk, MPU6050_SCRATCH_BURST, MPU6050_DMP_MEMORY_CHUNK_SIZE);
+    DmpImageReader reader;
+    uint8_t chunkSize, select[2], i;
+    bool_t zero, written;
+
+    if (dmpImageBegin(&reader, image, imageSize) != DMPIMAGE_OK) return FALSE;
+    while (reader.produced < reader.total) {
+        // same chunking as MPUwriteMemoryBlock(): never across a bank boundary
+        chunkSize = MPU6050_DMP_MEMORY_CHUNK_SIZE;
+        if (reader.total - reader.produced < chunkSize) chunkSize = reader.total - reader.produced;
+        if (chunkSize > 256 - address) chunkSize = 256 - address;
+        if (dmpImageRead(&reader, chunk, chunkSize) != chunkSize) return FALSE;
+
+        zero = TRUE;
+        for (i = 0; i < chunkSize && zero; i++) zero = (chunk[i] == 0);
+        select[0] = bank & 0x1F;
+        select[1] = address;
+        written = FALSE;
+        if (!zero || !verify) {
+            I2CdevwriteBytes(MPUdevAddr, MPU6050_RA_BANK_SEL, 2, select);
+            I2CdevwriteBytes(MPUdevAddr, MPU6050_RA_MEM_R_W, chunkSize, chunk);
+            written = TRUE;
+        }
+        if (verify) {
+            I2CdevwriteBytes(MPUdevAddr, MPU6050_RA_BANK_SEL, 2, select);
+            I2CdevreadBytes(MPUdevAddr, MPU6050_RA_MEM_R_W, chunkSize, MPUverifyBuffer, I2CDEV_DEFAULT_READ_TIMEOUT);
+            if (memcmp(chunk, MPUverifyBuffer, chunkSize) != 0) {
+                if (written) return FALSE;
+                // not zero after all, write and check again
+                I2CdevwriteBytes(MPUdevAddr, MPU6050_RA_BANK_SEL, 2, select);
+                I2CdevwriteBytes(MPUdevAddr, MPU6050_RA_MEM_R_W, chunkSize, chunk);
+                I2CdevwriteBytes(MPUdevAddr, MPU6050_RA_BANK_SEL, 2, select);
+                I2CdevreadBytes(MPUdevAddr, MPU6050_RA_MEM_R_W, chunkSize, MPUverifyBuffer, I2CDEV_DEFAULT_READ_TIMEOUT);
+                if (memcmp(chunk, MPUverifyBuffer, chunkSize) != 0) return FALSE;
+            }
+        }
+
+        // uint8_t wraps to 0 at the end of the bank
+        address += chunkSize;
+        if (address == 0) bank++;
+    }
+    return dmpImageEnd(&reader) == DMPIMAGE_OK;
+}
 bool_t MPUwriteDMPConfigurationSet(const uint8_t *data, uint16_t dataSize, bool_t useProgMem) {
     uint8_t success, special;
     uint16_t i;
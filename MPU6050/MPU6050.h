@@ -58,6 +58,10 @@ THE SOFTWARE.
 #define MPU6050_RA_YA_OFFS_L_TC     0x09
 #define MPU6050_RA_ZA_OFFS_H        0x0A //[15:0] ZA_OFFS
 #define MPU6050_RA_ZA_OFFS_L_TC     0x0B
+#define MPU6050_RA_SELF_TEST_X      0x0D //[7:5] XA_TEST[4:2], [4:0] XG_TEST[4:0]
+#define MPU6050_RA_SELF_TEST_Y      0x0E //[7:5] YA_TEST[4:2], [4:0] YG_TEST[4:0]
+#define MPU6050_RA_SELF_TEST_Z      0x0F //[7:5] ZA_TEST[4:2], [4:0] ZG_TEST[4:0]
+#define MPU6050_RA_SELF_TEST_A      0x10 //[5:4] XA_TEST[1:0], [3:2] YA_TEST[1:0], [1:0] ZA_TEST[1:0]
 #define MPU6050_RA_XG_OFFS_USRH     0x13 //[15:0] XG_OFFS_USR
 #define MPU6050_RA_XG_OFFS_USRL     0x14
 #define MPU6050_RA_YG_OFFS_USRH     0x15 //[15:0] YG_OFFS_USR
@@ -187,6 +191,9 @@ THE SOFTWARE.
 #define MPU6050_DLPF_BW_10          0x05
 #define MPU6050_DLPF_BW_5           0x06
 
+#define MPU6050_GCONFIG_XG_ST_BIT       7
+#define MPU6050_GCONFIG_YG_ST_BIT       6
+#define MPU6050_GCONFIG_ZG_ST_BIT       5
 #define MPU6050_GCONFIG_FS_SEL_BIT      4
 #define MPU6050_GCONFIG_FS_SEL_LENGTH   2
 
@@ -396,6 +403,30 @@ THE SOFTWARE.
 #define MPU6050_DMP_MEMORY_BANK_SIZE    256
 #define MPU6050_DMP_MEMORY_CHUNK_SIZE   16
 
+#define MPU6050_DEG_TO_RAD          0.017453293f
+#define MPU6050_STANDARD_GRAVITY    9.80665f    // m/s^2 per g
+
+/* Burst read buffers (MPUgetMotion9, MPUdmpInitialize, MPUeventRead, ...)
+ * are locals by default. With MPU6050_STATIC_SCRATCH set to TRUE they come
+ * from one arena handed over with MPUsetScratch() instead, so a reader thread
+ * only needs stack for the call chain itself. Driver calls then have to be
+ * serialized, as they already are for MPUbuffer.
+ */
+#ifndef MPU6050_STATIC_SCRATCH
+#define MPU6050_STATIC_SCRATCH          FALSE
+#endif
+#define MPU6050_SCRATCH_BURST           0       // burst reads, at most I2CDEV_BUFFER_LENGTH bytes
+#define MPU6050_SCRATCH_BURST_LENGTH    64
+#define MPU6050_SCRATCH_UPDATE          64      // DMP update records in MPUdmpInitialize()
+#define MPU6050_SCRATCH_UPDATE_LENGTH   16
+#define MPU6050_SCRATCH_SIZE            80
+
+#if MPU6050_STATIC_SCRATCH
+#define MPU_SCRATCH(name, region, size) uint8_t *name = MPUscratch + (region)
+#else
+#define MPU_SCRATCH(name, region, size) uint8_t name[size]
+#endif
+
 // note: DMP code memory blocks defined at end of header file
 
 /*        MPU6050(); */
@@ -403,6 +434,9 @@ THE SOFTWARE.
 
         void MPUinitialize(void);
         bool_t MPUtestConnection(void);
+        #if MPU6050_STATIC_SCRATCH
+            void MPUsetScratch(uint8_t (*arena)[MPU6050_SCRATCH_SIZE]);
+        #endif
 
         // AUX_VDDIO register
         uint8_t MPUgetAuxVDDIOLevel(void);
@@ -576,6 +610,7 @@ THE SOFTWARE.
         // ACCEL_*OUT_* registers
         void MPUgetMotion9(int16_t* ax, int16_t* ay, int16_t* az, int16_t* gx, int16_t* gy, int16_t* gz, int16_t* mx, int16_t* my, int16_t* mz);
         void MPUgetMotion6(int16_t* ax, int16_t* ay, int16_t* az, int16_t* gx, int16_t* gy, int16_t* gz);
+        void MPUgetMotion6Temp(int16_t* ax, int16_t* ay, int16_t* az, int16_t* gx, int16_t* gy, int16_t* gz, int16_t* t);
         void MPUgetAcceleration(int16_t* x, int16_t* y, int16_t* z);
         int16_t MPUgetAccelerationX(void);
         int16_t MPUgetAccelerationY(void);
@@ -675,6 +710,16 @@ THE SOFTWARE.
         uint8_t MPUgetDeviceID(void);
         void MPUsetDeviceID(uint8_t id);
         
+        // ======== UNIT CONVERSION (cached full-scale ranges) ========
+        float MPUgetGyroScaleForRange(uint8_t range);
+        float MPUgetAccelScaleForRange(uint8_t range);
+        float MPUgetGyroScale(void);
+        float MPUgetAccelScale(void);
+        void MPUrefreshScaleCache(void);
+        void MPUconvertAccelBlock(const int16_t *raw, float *out, uint32_t count);
+        void MPUconvertGyroBlock(const int16_t *raw, float *out, uint32_t count);
+        void MPUconvertMotion6Block(const int16_t *raw, float *out, uint32_t samples);
+
         // ======== UNDOCUMENTED/DMP REGISTERS/METHODS ========
         
         // XG_OFFS_TC register
@@ -762,6 +807,7 @@ THE SOFTWARE.
         void MPUreadMemoryBlock(uint8_t *data, uint16_t dataSize, uint8_t bank, uint8_t address);
         bool_t MPUwriteMemoryBlock(const uint8_t *data, uint16_t dataSize, uint8_t bank, uint8_t address, bool_t verify, bool_t useProgMem);
         bool_t MPUwriteProgMemoryBlock(const uint8_t *data, uint16_t dataSize, uint8_t bank, uint8_t address, bool_t verify);
+        bool_t MPUwritePackedMemoryBlock(const uint8_t *image, uint16_t imageSize, uint8_t bank, uint8_t address, bool_t verify);
 
         bool_t MPUwriteDMPConfigurationSet(const uint8_t *data, uint16_t dataSize, bool_t useProgMem);
         bool_t MPUwriteProgDMPConfigurationSet(const uint8_t *data, uint16_t dataSize);
@@ -979,11 +1025,19 @@ THE SOFTWARE.
 
         extern uint8_t MPUdevAddr;
         extern uint8_t MPUbuffer[14];
+        #if MPU6050_STATIC_SCRATCH
+            extern uint8_t *MPUscratch;
+        #endif
+        extern uint8_t MPUgyroRange;
+        extern uint8_t MPUaccelRange;
+        extern float MPUgyroScale;
+        extern float MPUaccelScale;
+        extern uint8_t MPUmagAxisOffset[3];
 				
 				extern uint16_t MPUfifoCount;     	// count of all bytes currently in FIFO
 				extern uint8_t  MPUfifoBuffer[64];	// FIFO storage buffer
 				
-				static uint8_t MPUverifyBuffer[MPU6050_DMP_MEMORY_CHUNK_SIZE];
+				extern uint8_t  MPUverifyBuffer[MPU6050_DMP_MEMORY_CHUNK_SIZE];	// memory block readback
 				//static uint8_t MPUprogBuffer[MPU6050_DMP_MEMORY_CHUNK_SIZE];
 
 #endif /* _MPU6050_H_ */
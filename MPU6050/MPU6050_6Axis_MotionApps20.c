@@ -42,6 +42,8 @@ THE SOFTWARE.
 */
 
 #include "helper_3dmath.h"
+#include "helper_fixmath.h"
+#include "helper_fasttrig.h"
 
 #include "ch.h"
 #include "hal.h"
@@ -49,6 +51,7 @@ THE SOFTWARE.
 
 #include "MPU6050_6Axis_MotionApps20.h"
 #include "MPU6050.h"
+#include "MPU6050_Calibration.h"
 
 // for memcpy
 #include <string.h>
@@ -93,6 +96,102 @@ THE SOFTWARE.
 // this block of memory gets written to the MPU on start-up, and it seems
 // to be volatile memory, so it has to be done each time (it only takes ~1
 // second though)
+#if MPU6050_DMP_COMPRESSED
+// packed with tools/dmppack.c from dmpMemory[] (1929 bytes, CRC 0x9034)
+const uint8_t dmpMemoryPacked[MPU6050_DMP_PACKED_SIZE] = {
+    0x89, 0x07, 0x34, 0x90, 0x00, 0xFB, 0x41, 0x0A, 0x3E, 0x00, 0x0B, 0x00, 0x36, 0x00, 0x01, 0x00,
+    0x02, 0x00, 0x03, 0x42, 0x04, 0x65, 0x00, 0x54, 0xFF, 0xEF, 0x41, 0x05, 0xFA, 0x80, 0x00, 0x0B,
+    0x12, 0x82, 0x90, 0x0D, 0x4D, 0x00, 0x28, 0x41, 0x07, 0xFF, 0xFF, 0x45, 0x81, 0xFF, 0xFF, 0xFA,
+    0x72, 0x45, 0x01, 0x03, 0xE8, 0x42, 0x0A, 0x01, 0x00, 0x01, 0x7F, 0xFF, 0xFF, 0xFE, 0x80, 0x01,
+    0x00, 0x1B, 0x4E, 0x03, 0x3E, 0x03, 0x30, 0x40, 0x42, 0x05, 0x02, 0xCA, 0xE3, 0x09, 0x3E, 0x80,
+    0x41, 0x00, 0x20, 0x46, 0x00, 0x40, 0x42, 0x00, 0x60, 0x42, 0x01, 0x41, 0xFF, 0x43, 0x01, 0x0B,
+    0x2A, 0x41, 0x01, 0x16, 0x55, 0x41, 0x07, 0x21, 0x82, 0xFD, 0x87, 0x26, 0x50, 0xFD, 0x80, 0x42,
+    0x00, 0x1F, 0x42, 0x01, 0x05, 0x80, 0x45, 0x00, 0x01, 0x42, 0x00, 0x02, 0x42, 0x00, 0x03, 0x41,
+    0x00, 0x40, 0x44, 0x05, 0x04, 0x6F, 0x00, 0x02, 0x65, 0x32, 0x41, 0x02, 0x5E, 0xC0, 0x40, 0x4E,
+    0x24, 0xFB, 0x8C, 0x6F, 0x5D, 0xFD, 0x5D, 0x08, 0xD9, 0x00, 0x7C, 0x73, 0x3B, 0x00, 0x6C, 0x12,
+    0xCC, 0x32, 0x00, 0x13, 0x9D, 0x32, 0x00, 0xD0, 0xD6, 0x32, 0x00, 0x08, 0x00, 0x40, 0x00, 0x01,
+    0xF4, 0xFF, 0xE6, 0x80, 0x79, 0x02, 0x44, 0x01, 0xD0, 0xD6, 0x41, 0x02, 0x27, 0x10, 0xFB, 0x42,
+    0x00, 0x40, 0x4D, 0x00, 0x01, 0x45, 0x80, 0x37, 0x44, 0x11, 0xFA, 0x36, 0xFF, 0xBC, 0x30, 0x8E,
+    0x00, 0x05, 0xFB, 0xF0, 0xFF, 0xD9, 0x5B, 0xC8, 0xFF, 0xD0, 0x9A, 0xBE, 0x41, 0x09, 0x10, 0xA9,
+    0xFF, 0xF4, 0x1E, 0xB2, 0x00, 0xCE, 0xBB, 0xF7, 0x42, 0x00, 0x01, 0x42, 0x00, 0x04, 0x80, 0x0F,
+    0x01, 0x02, 0x02, 0x41, 0x03, 0x0C, 0xFF, 0xC2, 0x80, 0x41, 0x01, 0x01, 0x80, 0x41, 0x01, 0xCF,
+    0x80, 0x80, 0xAC, 0x44, 0x00, 0x01, 0x45, 0x00, 0x06, 0x43, 0x00, 0x14, 0x73, 0x0C, 0x03, 0x3F,
+    0x68, 0xB6, 0x79, 0x35, 0x28, 0xBC, 0xC6, 0x7E, 0xD1, 0x6C, 0x80, 0x42, 0x00, 0x40, 0x44, 0x01,
+    0xB2, 0x6A, 0x4D, 0x01, 0x3F, 0xF0, 0x42, 0x00, 0x30, 0x61, 0x05, 0x25, 0x4D, 0x00, 0x2F, 0x70,
+    0x6D, 0x41, 0x05, 0x05, 0xAE, 0x00, 0x0C, 0x02, 0xD0, 0x44, 0x90, 0x15, 0x47, 0x00, 0x01, 0x41,
+    0x00, 0x44, 0x43, 0x00, 0x0C, 0x42, 0x00, 0x01, 0x45, 0x00, 0x65, 0x42, 0x00, 0x54, 0x41, 0x01,
+    0xFF, 0xEF, 0x51, 0x00, 0x40, 0x4E, 0x00, 0x40, 0x51, 0x00, 0x01, 0x42, 0x00, 0x02, 0x68, 0x00,
+    0x1B, 0x69, 0x00, 0x40, 0x43, 0x00, 0x1B, 0x7D, 0x3F, 0xD8, 0xDC, 0xBA, 0xA2, 0xF1, 0xDE, 0xB2,
+    0xB8, 0xB4, 0xA8, 0x81, 0x91, 0xF7, 0x4A, 0x90, 0x7F, 0x91, 0x6A, 0xF3, 0xF9, 0xDB, 0xA8, 0xF9,
+    0xB0, 0xBA, 0xA0, 0x80, 0xF2, 0xCE, 0x81, 0xF3, 0xC2, 0xF1, 0xC1, 0xF2, 0xC3, 0xF3, 0xCC, 0xA2,
+    0xB2, 0x80, 0xF1, 0xC6, 0xD8, 0x80, 0xBA, 0xA7, 0xDF, 0xDF, 0xDF, 0xF2, 0xA7, 0xC3, 0xCB, 0xC5,
+    0xB6, 0xF0, 0x87, 0xA2, 0x94, 0x24, 0x48, 0x70, 0x3C, 0x31, 0x95, 0x40, 0x68, 0x34, 0x58, 0x9B,
+    0x78, 0xA2, 0xF1, 0x83, 0x92, 0x2D, 0x55, 0x7D, 0xD8, 0xB1, 0xB4, 0xB8, 0xA1, 0xD0, 0x91, 0x80,
+    0xF2, 0x70, 0xF3, 0x70, 0xF2, 0x7C, 0x80, 0xA8, 0xF1, 0x01, 0xB0, 0x98, 0x87, 0xD9, 0x43, 0xD8,
+    0x86, 0xC9, 0x88, 0xBA, 0xA1, 0xF2, 0x0E, 0xB8, 0x97, 0x80, 0xF1, 0xA9, 0x81, 0x98, 0x00, 0xAA,
+    0x89, 0x98, 0x3F, 0xAA, 0xC5, 0xCD, 0xC7, 0xA9, 0x0C, 0xC9, 0x2C, 0x97, 0x97, 0x97, 0x97, 0xF1,
+    0xA9, 0x89, 0x26, 0x46, 0x66, 0xB0, 0xB4, 0xBA, 0x80, 0xAC, 0xDE, 0xF2, 0xCA, 0xF1, 0xB2, 0x8C,
+    0x02, 0xA9, 0xB6, 0x98, 0x00, 0x89, 0x0E, 0x16, 0x1E, 0xB8, 0xA9, 0xB4, 0x99, 0x2C, 0x54, 0x7C,
+    0xB0, 0x8A, 0xA8, 0x96, 0x36, 0x56, 0x76, 0xF1, 0xB9, 0xAF, 0xB4, 0xB0, 0x83, 0xC0, 0xB8, 0xA8,
+    0x97, 0x11, 0xB1, 0x37, 0x8F, 0x98, 0xB9, 0xAF, 0xF0, 0x24, 0x08, 0x44, 0x10, 0x64, 0x18, 0xF1,
+    0xA3, 0x29, 0x55, 0x7D, 0xAF, 0x83, 0xB5, 0x93, 0xAF, 0xF0, 0x00, 0x28, 0x50, 0xF1, 0xA3, 0x86,
+    0x9F, 0x61, 0xA6, 0xDA, 0xDE, 0xDF, 0xD9, 0xFA, 0xA3, 0x86, 0x96, 0xDB, 0x31, 0xA6, 0xD9, 0xF8,
+    0xDF, 0xBA, 0xA6, 0x8F, 0xC2, 0xC5, 0xC7, 0xB2, 0x8C, 0xC1, 0xB8, 0xA2, 0x81, 0x98, 0x00, 0xA3,
+    0x81, 0x98, 0x1D, 0xD8, 0xD8, 0xF1, 0xB8, 0xA8, 0xB2, 0x86, 0xB4, 0x98, 0x0D, 0x35, 0x5D, 0xB8,
+    0xAA, 0x98, 0xB0, 0x87, 0x2D, 0x35, 0x3D, 0xB2, 0xB6, 0xBA, 0xAF, 0x8C, 0x96, 0x19, 0x8F, 0x9F,
+    0xA7, 0x82, 0x06, 0x04, 0xB4, 0x9A, 0xB8, 0xAA, 0x87, 0x82, 0x0D, 0x0C, 0xB9, 0xA3, 0xDE, 0xDF,
+    0xDF, 0xA3, 0xB1, 0x80, 0xF2, 0xC4, 0xCD, 0xC9, 0xF1, 0x8A, 0x09, 0x00, 0x83, 0x82, 0x6C, 0x02,
+    0x89, 0xB9, 0xA3, 0x81, 0xB5, 0x02, 0xB5, 0x93, 0xA3, 0x82, 0x06, 0x00, 0xA9, 0x82, 0x0D, 0x0F,
+    0xB8, 0xB4, 0xB0, 0xF1, 0x97, 0x83, 0xA8, 0x11, 0x84, 0xA5, 0x09, 0x98, 0xA3, 0x83, 0xF0, 0xDA,
+    0x9A, 0x29, 0x02, 0xD8, 0xF1, 0xA5, 0x82, 0x31, 0x12, 0xA5, 0x85, 0x95, 0x02, 0x1A, 0x2E, 0x3A,
+    0x56, 0x5A, 0x40, 0x48, 0xF9, 0xF3, 0xA3, 0xD9, 0xF8, 0xF0, 0x98, 0x83, 0x9A, 0x29, 0x07, 0x97,
+    0x82, 0xA8, 0xF1, 0x11, 0xF0, 0x98, 0xA2, 0x9A, 0x29, 0x34, 0xDA, 0xF3, 0xDE, 0xD8, 0x83, 0xA5,
+    0x94, 0x01, 0xD9, 0xA3, 0x02, 0xF1, 0xA2, 0xC3, 0xC5, 0xC7, 0xD8, 0xF1, 0x84, 0x92, 0xA2, 0x4D,
+    0xDA, 0x2A, 0xD8, 0x48, 0x69, 0xD9, 0x2A, 0xD8, 0x68, 0x55, 0xDA, 0x32, 0xD8, 0x50, 0x71, 0xD9,
+    0x32, 0xD8, 0x70, 0x5D, 0xDA, 0x3A, 0xD8, 0x58, 0x79, 0xD9, 0x3A, 0xD8, 0x78, 0x93, 0xA3, 0xFA,
+    0xFF, 0xCB, 0x11, 0x2F, 0xA8, 0x8A, 0x9A, 0xF0, 0x28, 0x50, 0x78, 0x9E, 0xF3, 0x88, 0x18, 0xF1,
+    0x9F, 0x1D, 0x98, 0xA8, 0xD9, 0x08, 0xD8, 0xC8, 0x9F, 0x12, 0x9E, 0xF3, 0x15, 0xA8, 0xDA, 0x12,
+    0x10, 0xD8, 0xF1, 0xAF, 0xC8, 0x97, 0x87, 0x34, 0xB5, 0xB9, 0x94, 0xA4, 0x21, 0xF3, 0xD9, 0x22,
+    0xD8, 0xF2, 0x2D, 0xF3, 0x83, 0x05, 0x02, 0xF2, 0x35, 0xF3, 0x83, 0x0F, 0x38, 0x81, 0xA4, 0x60,
+    0x60, 0x61, 0xD9, 0x61, 0xD8, 0x6C, 0x68, 0x69, 0xD9, 0x69, 0xD8, 0x74, 0x70, 0x71, 0xD9, 0x71,
+    0xD8, 0xB1, 0xA3, 0x84, 0x19, 0x3D, 0x5D, 0xA3, 0x83, 0x1A, 0x3E, 0x5E, 0x93, 0x10, 0x30, 0x81,
+    0x10, 0x11, 0xB8, 0xB0, 0xAF, 0x8F, 0x94, 0xF2, 0xDA, 0x3E, 0xD8, 0xB4, 0x9A, 0xA8, 0x87, 0x29,
+    0xDA, 0xF8, 0xD8, 0x87, 0x9A, 0x35, 0x93, 0x90, 0x00, 0x3D, 0x83, 0x90, 0x28, 0xB1, 0xB9, 0xA4,
+    0x98, 0x85, 0x02, 0x2E, 0x56, 0xA5, 0x81, 0x00, 0x0C, 0x14, 0xA3, 0x97, 0xB0, 0x8A, 0xF1, 0x2D,
+    0xD9, 0x28, 0xD8, 0x4D, 0xD9, 0x48, 0xD8, 0x6D, 0xD9, 0x68, 0xD8, 0xB1, 0x84, 0x0D, 0xDA, 0x0E,
+    0xD8, 0xA3, 0x29, 0x83, 0xDA, 0x2C, 0x83, 0xBF, 0x01, 0x84, 0x49, 0x83, 0xC3, 0x04, 0x4C, 0x0E,
+    0xD8, 0xB8, 0xB0, 0x83, 0x24, 0x3F, 0xF5, 0x20, 0xAA, 0xDA, 0xDF, 0xD8, 0xA8, 0x40, 0xAA, 0xD0,
+    0xDA, 0xDE, 0xD8, 0xA8, 0x60, 0xAA, 0xDA, 0xD0, 0xDF, 0xD8, 0xF1, 0x97, 0x86, 0xA8, 0x31, 0x9B,
+    0x06, 0x99, 0x07, 0xAB, 0x97, 0x28, 0x88, 0x9B, 0xF0, 0x0C, 0x20, 0x14, 0x40, 0xB8, 0xB0, 0xB4,
+    0xA8, 0x8C, 0x9C, 0xF0, 0x04, 0x28, 0x51, 0x79, 0x1D, 0x30, 0x14, 0x38, 0xB2, 0x82, 0xAB, 0xD0,
+    0x98, 0x2C, 0x50, 0x50, 0x78, 0x78, 0x0B, 0x9B, 0xF1, 0x1A, 0xB0, 0xF0, 0x8A, 0x9C, 0xA8, 0x29,
+    0x51, 0x79, 0x8B, 0x84, 0x1F, 0x28, 0x8A, 0x24, 0x70, 0x59, 0x8B, 0x20, 0x58, 0x71, 0x8A, 0x44,
+    0x69, 0x38, 0x8B, 0x39, 0x40, 0x68, 0x8A, 0x64, 0x48, 0x31, 0x8B, 0x30, 0x49, 0x60, 0xA5, 0x88,
+    0x20, 0x09, 0x71, 0x58, 0x44, 0x68, 0x11, 0x39, 0x64, 0x49, 0x30, 0x19, 0xF1, 0xAC, 0x00, 0x82,
+    0x0D, 0x03, 0xF0, 0x8C, 0xA8, 0x04, 0x83, 0x28, 0x09, 0xF1, 0x88, 0x97, 0x26, 0xA8, 0x59, 0x98,
+    0xAC, 0x8C, 0x02, 0x81, 0xF2, 0x01, 0xF0, 0x89, 0x94, 0x1D, 0x84, 0x27, 0x84, 0x2F, 0x84, 0x37,
+    0x23, 0xA9, 0x88, 0x09, 0x20, 0x59, 0x70, 0xAB, 0x11, 0x38, 0x40, 0x69, 0xA8, 0x19, 0x31, 0x48,
+    0x60, 0x8C, 0xA8, 0x3C, 0x41, 0x5C, 0x20, 0x7C, 0x00, 0xF1, 0x87, 0x98, 0x19, 0x86, 0xA8, 0x6E,
+    0x76, 0x7E, 0xA9, 0x99, 0x88, 0x81, 0xB5, 0x0E, 0x9E, 0xB9, 0xA3, 0x8A, 0x22, 0x8A, 0x6E, 0x8A,
+    0x56, 0x8A, 0x5E, 0x9F, 0xB1, 0x83, 0x06, 0x81, 0xF2, 0x07, 0x0E, 0x2E, 0x4E, 0x6E, 0x9D, 0xB8,
+    0xAD, 0x00, 0x82, 0x0D, 0x06, 0xF2, 0xB1, 0x8C, 0xB4, 0x99, 0xB9, 0xA3, 0x81, 0xB5, 0x09, 0x81,
+    0x91, 0xAC, 0x38, 0xAD, 0x3A, 0xB5, 0x83, 0x91, 0xAC, 0xCB, 0xAF, 0x08, 0x8C, 0x9D, 0xAE, 0x29,
+    0xD9, 0x04, 0xAE, 0xD8, 0x51, 0x8C, 0xD0, 0x21, 0x79, 0xD9, 0x04, 0xD8, 0x81, 0xF3, 0x9D, 0xAD,
+    0x00, 0x8D, 0xAE, 0x19, 0x81, 0xAD, 0xD9, 0x01, 0xD8, 0xF2, 0xAE, 0xDA, 0x26, 0xD8, 0x8E, 0x91,
+    0x29, 0x83, 0xA7, 0xD9, 0xAD, 0xAD, 0xAD, 0xAD, 0xF3, 0x2A, 0x82, 0x63, 0x21, 0xB0, 0xAC, 0x89,
+    0x91, 0x3E, 0x5E, 0x76, 0xF3, 0xAC, 0x2E, 0x2E, 0xF1, 0xB1, 0x8C, 0x5A, 0x9C, 0xAC, 0x2C, 0x28,
+    0x28, 0x28, 0x9C, 0xAC, 0x30, 0x18, 0xA8, 0x98, 0x81, 0x28, 0x34, 0x3C, 0x97, 0x24, 0xA7, 0x85,
+    0x19, 0x10, 0x9C, 0x24, 0xF2, 0xB0, 0x89, 0xAC, 0x91, 0x2C, 0x4C, 0x6C, 0x8A, 0x9B, 0x2D, 0xD9,
+    0xD8, 0xD8, 0x51, 0x85, 0x2F, 0x00, 0x79, 0x85, 0x2F, 0x08, 0xF1, 0x9E, 0x88, 0xA3, 0x31, 0xDA,
+    0xD8, 0xD8, 0x91, 0xD3, 0xAF, 0x05, 0x83, 0x93, 0x35, 0x3D, 0x80, 0x25, 0x85, 0x3F, 0x01, 0x85,
+    0x69, 0x85, 0x3F, 0x03, 0xB4, 0x93, 0x81, 0xA3, 0x85, 0x19, 0x18, 0xF3, 0xAB, 0x8B, 0xF8, 0xA3,
+    0x91, 0xB6, 0x09, 0xB4, 0xD9, 0xAB, 0xDE, 0xFA, 0xB0, 0x87, 0x9C, 0xB9, 0xA3, 0xDD, 0xF1, 0xA3,
+    0xA3, 0xA3, 0xA3, 0x95, 0x8D, 0x6E, 0x00, 0x9D, 0x95, 0x6E, 0x05, 0xF2, 0xA3, 0xB4, 0x90, 0x80,
+    0xF2, 0x8D, 0x6F, 0x8D, 0x6F, 0x02, 0xA3, 0xA3, 0xB2, 0x8D, 0x6F, 0x05, 0xA3, 0xA3, 0xB0, 0x87,
+    0xB5, 0x99, 0x8D, 0x6E, 0x00, 0x98, 0x95, 0x6E, 0x00, 0x97, 0x8D, 0x6F, 0x0D, 0xF3, 0x9B, 0xA3,
+    0xA3, 0xDC, 0xB9, 0xA7, 0xF1, 0x26, 0x26, 0x26, 0xD8, 0xD8, 0xFF,
+};
+#else
 const uint8_t dmpMemory[MPU6050_DMP_CODE_SIZE] = {
     // bank 0, 256 bytes
     0xFB, 0x00, 0x00, 0x3E, 0x00, 0x0B, 0x00, 0x36, 0x00, 0x01, 0x00, 0x02, 0x00, 0x03, 0x00, 0x00,
@@ -231,6 +330,7 @@ const uint8_t dmpMemory[MPU6050_DMP_CODE_SIZE] = {
     0x98, 0xF1, 0xA3, 0xA3, 0xA3, 0xA3, 0x97, 0xA3, 0xA3, 0xA3, 0xA3, 0xF3, 0x9B, 0xA3, 0xA3, 0xDC,
     0xB9, 0xA7, 0xF1, 0x26, 0x26, 0x26, 0xD8, 0xD8, 0xFF
 };
+#endif
 
 // thanks to Noah Zerkin for piecing this stuff together!
 const uint8_t dmpConfig[MPU6050_DMP_CONFIG_SIZE] = {
@@ -290,10 +390,12 @@ uint8_t MPUdmpInitialize() {
 	uint8_t hwRevision, otpValid, mpuIntStatus;
 #endif
 	int8_t	xgOffset, ygOffset, zgOffset;
-	uint8_t dmpUpdate[16], j;
+	MPU_SCRATCH(dmpUpdate, MPU6050_SCRATCH_UPDATE, MPU6050_SCRATCH_UPDATE_LENGTH);
+	uint8_t j;
     uint16_t pos = 0;
 	uint8_t fifoCount;
-    uint8_t fifoBuffer[128];
+    // only drained and discarded; reads beyond the I2Cdev buffer are rejected anyway
+    MPU_SCRATCH(fifoBuffer, MPU6050_SCRATCH_BURST, MPU6050_SCRATCH_BURST_LENGTH);
 	
     // reset device
     DEBUG_PRINT("\n\nResetting MPU6050...");
@@ -353,7 +455,11 @@ uint8_t MPUdmpInitialize() {
     DEBUG_PRINT("Writing DMP code to MPU memory banks (");
     DEBUG_PRINTF("%d", MPU6050_DMP_CODE_SIZE);
     DEBUG_PRINT("\n bytes)");
+#if MPU6050_DMP_COMPRESSED
+    if (MPUwritePackedMemoryBlock(dmpMemoryPacked, MPU6050_DMP_PACKED_SIZE, 0, 0, TRUE)) {
+#else
     if (MPUwriteProgMemoryBlock(dmpMemory, MPU6050_DMP_CODE_SIZE, 0, 0, TRUE)) {
+#endif
         DEBUG_PRINT("\nSuccess! DMP code written and verified.");
 
         // write DMP configuration
@@ -393,10 +499,13 @@ uint8_t MPUdmpInitialize() {
             MPUsetYGyroOffset(ygOffset);
             MPUsetZGyroOffset(zgOffset);
 
-            DEBUG_PRINT("\nSetting X/Y/Z gyro user offsets to zero...");
-            MPUsetXGyroOffsetUser(0);
-            MPUsetYGyroOffsetUser(0);
-            MPUsetZGyroOffsetUser(0);
+            DEBUG_PRINT("\nRestoring stored calibration...");
+            if (!MPUcalibrationRestore()) {
+                DEBUG_PRINT("\nNo calibration stored, setting X/Y/Z gyro user offsets to zero...");
+                MPUsetXGyroOffsetUser(0);
+                MPUsetYGyroOffsetUser(0);
+                MPUsetZGyroOffsetUser(0);
+            }
 
             DEBUG_PRINT("\nWriting final memory update 1/7 (function unknown)...");
 
@@ -600,6 +709,19 @@ uint8_t MPUdmpGetQuaternion(Quaternion *q, const uint8_t* packet) {
     }
     return status; // int16 return value, indicates error if this line is reached
 }
+uint8_t MPUdmpGetQuaternionQ30(QuaternionQ30 *q, const uint8_t* packet) {
+    // the DMP quaternion already is Q30, no float conversion needed
+    int32_t qI[4];
+    uint8_t status = MPUdmpGetQuaternion32(qI, packet);
+    if (status == 0) {
+        q -> w = qI[0];
+        q -> x = qI[1];
+        q -> y = qI[2];
+        q -> z = qI[3];
+        return 0;
+    }
+    return status;
+}
 // uint8_t MPU6050::dmpGet6AxisQuaternion(long *data, const uint8_t* packet);
 // uint8_t MPU6050::dmpGetRelativeQuaternion(long *data, const uint8_t* packet);
 uint8_t MPUdmpGetGyro32(int32_t *data, const uint8_t* packet) {
@@ -622,9 +744,16 @@ uint8_t MPUdmpGetGyro16(int16_t *data, const uint8_t* packet) {
 // uint8_t MPU6050::dmpGetLinearAccel(long *data, const uint8_t* packet);
 uint8_t MPUdmpGetLinearAccelVect(VectorInt16 *v, VectorInt16 *vRaw, VectorFloat *gravity) {
     // get rid of the gravity component (+1g = +4096 in standard DMP FIFO packet)
-    v -> x = vRaw -> x - gravity -> x*4096;
-    v -> y = vRaw -> y - gravity -> y*4096;
-    v -> z = vRaw -> z - gravity -> z*4096;
+    v -> x = vRaw -> x - gravity -> x*MPU6050_DMP_ACCEL_LSB_PER_G;
+    v -> y = vRaw -> y - gravity -> y*MPU6050_DMP_ACCEL_LSB_PER_G;
+    v -> z = vRaw -> z - gravity -> z*MPU6050_DMP_ACCEL_LSB_PER_G;
+    return 0;
+}
+uint8_t MPUdmpGetLinearAccelVectQ14(VectorInt16 *v, VectorInt16 *vRaw, VectorInt16 *gravity) {
+    // gravity is Q14 (1g = 16384), the FIFO accel is 1g = MPU6050_DMP_ACCEL_LSB_PER_G
+    v -> x = vRaw -> x - (int16_t)(((int32_t)gravity -> x * MPU6050_DMP_ACCEL_LSB_PER_G) >> 14);
+    v -> y = vRaw -> y - (int16_t)(((int32_t)gravity -> y * MPU6050_DMP_ACCEL_LSB_PER_G) >> 14);
+    v -> z = vRaw -> z - (int16_t)(((int32_t)gravity -> z * MPU6050_DMP_ACCEL_LSB_PER_G) >> 14);
     return 0;
 }
 // uint8_t MPU6050::dmpGetLinearAccelInWorld(long *data, const uint8_t* packet);
@@ -635,6 +764,11 @@ uint8_t MPUdmpGetLinearAccelInWorldVect(VectorInt16 *v, VectorInt16 *vReal, Quat
 		rotateVectInt(v, q);
     return 0;
 }
+uint8_t MPUdmpGetLinearAccelInWorldVectQ30(VectorInt16 *v, VectorInt16 *vReal, QuaternionQ30 *q) {
+    memcpy(v, vReal, sizeof(VectorInt16));
+    rotateVectIntQ30(v, q);
+    return 0;
+}
 // uint8_t MPU6050::dmpGetGyroAndAccelSensor(long *data, const uint8_t* packet);
 // uint8_t MPU6050::dmpGetGyroSensor(long *data, const uint8_t* packet);
 // uint8_t MPU6050::dmpGetControlData(long *data, const uint8_t* packet);
@@ -646,25 +780,86 @@ uint8_t MPUdmpGetGravityVect(VectorFloat *v, Quaternion *q) {
     v -> z = q -> w*q -> w - q -> x*q -> x - q -> y*q -> y + q -> z*q -> z;
     return 0;
 }
+uint8_t MPUdmpGetGravityVectQ14(VectorInt16 *v, QuaternionQ30 *q) {
+    getGravityQ14(v, q);
+    return 0;
+}
 // uint8_t MPU6050::dmpGetUnquantizedAccel(long *data, const uint8_t* packet);
 // uint8_t MPU6050::dmpGetQuantizedAccel(long *data, const uint8_t* packet);
 // uint8_t MPU6050::dmpGetExternalSensorData(long *data, int size, const uint8_t* packet);
 // uint8_t MPU6050::dmpGetEIS(long *data, const uint8_t* packet);
 
 uint8_t MPUdmpGetEuler(float *data, Quaternion *q) {
-    data[0] = atan2(2*q -> x*q -> y - 2*q -> w*q -> z, 2*q -> w*q -> w + 2*q -> x*q -> x - 1);   // psi (z)
-    data[1] = -asin(2*q -> x*q -> z + 2*q -> w*q -> y);                              // theta (y)
-    data[2] = atan2(2*q -> y*q -> z - 2*q -> w*q -> x, 2*q -> w*q -> w + 2*q -> z*q -> z - 1);   // phi (x)
-    return 0;
+    return MPUdmpGetEulerMode(data, q, MPU6050_TRIG_DEFAULT);
 }
 uint8_t MPUdmpGetYawPitchRoll(float *data, Quaternion *q, VectorFloat *gravity) {
-    // yaw: (about Z axis)
-    data[0] = atan2(2*q -> x*q -> y - 2*q -> w*q -> z, 2*q -> w*q -> w + 2*q -> x*q -> x - 1);
-    // pitch: (nose up/down, about Y axis)
-    data[1] = atan(gravity -> x / sqrtf(gravity -> y*gravity -> y + gravity -> z*gravity -> z));
-    // roll: (tilt left/right, about X axis)
-    data[2] = atan(gravity -> y / sqrtf(gravity -> x*gravity -> x + gravity -> z*gravity -> z));
-    return 0;
+    return MPUdmpGetYawPitchRollMode(data, q, gravity, MPU6050_TRIG_DEFAULT);
+}
+/** Get Euler angles (psi, theta, phi) with a selectable trigonometry backend.
+ * @param data Output array, [0] psi (z), [1] theta (y), [2] phi (x) in radians
+ * @param q Orientation quaternion
+ * @param mode MPU6050_TRIG_DOUBLE, MPU6050_TRIG_FLOAT or MPU6050_TRIG_FAST
+ * @return 0 on success, 1 on unknown mode
+ */
+uint8_t MPUdmpGetEulerMode(float *data, Quaternion *q, uint8_t mode) {
+    float psiY = 2*q -> x*q -> y - 2*q -> w*q -> z;
+    float psiX = 2*q -> w*q -> w + 2*q -> x*q -> x - 1;
+    float theta = 2*q -> x*q -> z + 2*q -> w*q -> y;
+    float phiY = 2*q -> y*q -> z - 2*q -> w*q -> x;
+    float phiX = 2*q -> w*q -> w + 2*q -> z*q -> z - 1;
+    switch (mode) {
+        case MPU6050_TRIG_DOUBLE:
+            data[0] = atan2(psiY, psiX);   // psi (z)
+            data[1] = -asin(theta);        // theta (y)
+            data[2] = atan2(phiY, phiX);   // phi (x)
+            return 0;
+        case MPU6050_TRIG_FLOAT:
+            data[0] = atan2f(psiY, psiX);
+            data[1] = -asinf(theta);
+            data[2] = atan2f(phiY, phiX);
+            return 0;
+        case MPU6050_TRIG_FAST:
+            data[0] = fastAtan2f(psiY, psiX);
+            data[1] = -fastAsinf(theta);
+            data[2] = fastAtan2f(phiY, phiX);
+            return 0;
+    }
+    return 1;
+}
+/** Get yaw, pitch and roll with a selectable trigonometry backend.
+ * @param data Output array, [0] yaw, [1] pitch, [2] roll in radians
+ * @param q Orientation quaternion
+ * @param gravity Gravity vector from MPUdmpGetGravityVect()
+ * @param mode MPU6050_TRIG_DOUBLE, MPU6050_TRIG_FLOAT or MPU6050_TRIG_FAST
+ * @return 0 on success, 1 on unknown mode
+ */
+uint8_t MPUdmpGetYawPitchRollMode(float *data, Quaternion *q, VectorFloat *gravity, uint8_t mode) {
+    float yawY = 2*q -> x*q -> y - 2*q -> w*q -> z;
+    float yawX = 2*q -> w*q -> w + 2*q -> x*q -> x - 1;
+    float pitchX = sqrtf(gravity -> y*gravity -> y + gravity -> z*gravity -> z);
+    float rollX = sqrtf(gravity -> x*gravity -> x + gravity -> z*gravity -> z);
+    switch (mode) {
+        case MPU6050_TRIG_DOUBLE:
+            // yaw: (about Z axis)
+            data[0] = atan2(yawY, yawX);
+            // pitch: (nose up/down, about Y axis)
+            data[1] = atan(gravity -> x / pitchX);
+            // roll: (tilt left/right, about X axis)
+            data[2] = atan(gravity -> y / rollX);
+            return 0;
+        case MPU6050_TRIG_FLOAT:
+            data[0] = atan2f(yawY, yawX);
+            data[1] = atanf(gravity -> x / pitchX);
+            data[2] = atanf(gravity -> y / rollX);
+            return 0;
+        case MPU6050_TRIG_FAST:
+            // atan(a / b) with b >= 0 is atan2(a, b), which saves the divide
+            data[0] = fastAtan2f(yawY, yawX);
+            data[1] = fastAtan2f(gravity -> x, pitchX);
+            data[2] = fastAtan2f(gravity -> y, rollX);
+            return 0;
+    }
+    return 1;
 }
 
 // uint8_t MPU6050::dmpGetAccelFloat(float *data, const uint8_t* packet);
@@ -682,7 +877,7 @@ uint8_t MPUdmpProcessFIFOPacket(const unsigned char *dmpData) {
 }
 uint8_t MPUdmpReadAndProcessFIFOPacket(uint8_t numPackets, uint8_t *processed) {
     uint8_t status;
-    uint8_t buf[MPUdmpPacketSize];
+    MPU_SCRATCH(buf, MPU6050_SCRATCH_BURST, MPUdmpPacketSize);
 		uint8_t i;
     for (i = 0; i < numPackets; i++) {
         // read packet from FIFO
@@ -45,6 +45,8 @@ THE SOFTWARE.
 #define _MPU6050_6AXIS_MOTIONAPPS20_H_
 
 #include "helper_3dmath.h"
+#include "helper_fixmath.h"
+#include "helper_fasttrig.h"
 
 // MotionApps 2.0 DMP implementation, built using the MPU-6050EVB evaluation board
 #define MPU6050_INCLUDE_DMP_MOTIONAPPS20
@@ -59,9 +61,24 @@ THE SOFTWARE.
  */
 
 #define MPU6050_DMP_CODE_SIZE       1929    // dmpMemory[]
+#define MPU6050_DMP_PACKED_SIZE     1451    // dmpMemoryPacked[]
 #define MPU6050_DMP_CONFIG_SIZE     192     // dmpConfig[]
 #define MPU6050_DMP_UPDATES_SIZE    47      // dmpUpdates[]
 
+// accel scale of the default FIFO packet, fixed by the DMP configuration
+// (independent of AFS_SEL, so not covered by MPUgetAccelScale())
+#define MPU6050_DMP_ACCEL_LSB_PER_G 4096
+
+// precision modes for MPUdmpGetEulerMode()/MPUdmpGetYawPitchRollMode()
+#define MPU6050_TRIG_DOUBLE         0       // libm double atan2/asin/atan (original behaviour)
+#define MPU6050_TRIG_FLOAT          1       // libm float atan2f/asinf/atanf
+#define MPU6050_TRIG_FAST           2       // helper_fasttrig.h polynomials, |error| < 1e-4 rad
+
+// mode used by MPUdmpGetEuler()/MPUdmpGetYawPitchRoll(), override from the build
+#ifndef MPU6050_TRIG_DEFAULT
+#define MPU6050_TRIG_DEFAULT        MPU6050_TRIG_FLOAT
+#endif
+
 /* ================================================================================================ *
  | Default MotionApps v2.0 42-byte FIFO packet structure:                                           |
  |                                                                                                  |
@@ -75,7 +92,18 @@ THE SOFTWARE.
 // this block of memory gets written to the MPU on start-up, and it seems
 // to be volatile memory, so it has to be done each time (it only takes ~1
 // second though)
+// By default only the packed form (helper_dmpimage.h) is kept in flash and
+// unpacked chunk by chunk during the upload; set MPU6050_DMP_COMPRESSED to
+// FALSE for the plain array, e.g. to regenerate the packed one with
+// tools/dmppack.c.
+#ifndef MPU6050_DMP_COMPRESSED
+#define MPU6050_DMP_COMPRESSED      TRUE
+#endif
+#if MPU6050_DMP_COMPRESSED
+extern const uint8_t dmpMemoryPacked[MPU6050_DMP_PACKED_SIZE];
+#else
 extern const uint8_t dmpMemory[MPU6050_DMP_CODE_SIZE];
+#endif
 
 // thanks to Noah Zerkin for piecing this stuff together!
 extern const uint8_t dmpConfig[MPU6050_DMP_CONFIG_SIZE];
@@ -117,6 +145,7 @@ uint8_t MPUdmpGetAccel(VectorInt16 *v, const uint8_t* packet);
 uint8_t MPUdmpGetQuaternion32(int32_t *data, const uint8_t* packet);
 uint8_t MPUdmpGetQuaternion16(int16_t *data, const uint8_t* packet);
 uint8_t MPUdmpGetQuaternion(Quaternion *q, const uint8_t* packet);
+uint8_t MPUdmpGetQuaternionQ30(QuaternionQ30 *q, const uint8_t* packet);
 // uint8_t MPU6050::dmpGet6AxisQuaternion(long *data, const uint8_t* packet);
 // uint8_t MPU6050::dmpGetRelativeQuaternion(long *data, const uint8_t* packet);
 uint8_t MPUdmpGetGyro32(int32_t *data, const uint8_t* packet);
@@ -124,14 +153,17 @@ uint8_t MPUdmpGetGyro16(int16_t *data, const uint8_t* packet);
 // uint8_t MPU6050::dmpSetLinearAccelFilterCoefficient(float coef);
 // uint8_t MPU6050::dmpGetLinearAccel(long *data, const uint8_t* packet);
 uint8_t MPUdmpGetLinearAccelVect(VectorInt16 *v, VectorInt16 *vRaw, VectorFloat *gravity);
+uint8_t MPUdmpGetLinearAccelVectQ14(VectorInt16 *v, VectorInt16 *vRaw, VectorInt16 *gravity);
 // uint8_t MPU6050::dmpGetLinearAccelInWorld(long *data, const uint8_t* packet);
 uint8_t MPUdmpGetLinearAccelInWorldVect(VectorInt16 *v, VectorInt16 *vReal, Quaternion *q);
+uint8_t MPUdmpGetLinearAccelInWorldVectQ30(VectorInt16 *v, VectorInt16 *vReal, QuaternionQ30 *q);
 // uint8_t MPU6050::dmpGetGyroAndAccelSensor(long *data, const uint8_t* packet);
 // uint8_t MPU6050::dmpGetGyroSensor(long *data, const uint8_t* packet);
 // uint8_t MPU6050::dmpGetControlData(long *data, const uint8_t* packet);
 // uint8_t MPU6050::dmpGetTemperature(long *data, const uint8_t* packet);
 // uint8_t MPU6050::dmpGetGravity(long *data, const uint8_t* packet);
 uint8_t MPUdmpGetGravityVect(VectorFloat *v, Quaternion *q);
+uint8_t MPUdmpGetGravityVectQ14(VectorInt16 *v, QuaternionQ30 *q);
 // uint8_t MPU6050::dmpGetUnquantizedAccel(long *data, const uint8_t* packet);
 // uint8_t MPU6050::dmpGetQuantizedAccel(long *data, const uint8_t* packet);
 // uint8_t MPU6050::dmpGetExternalSensorData(long *data, int size, const uint8_t* packet);
@@ -139,6 +171,8 @@ uint8_t MPUdmpGetGravityVect(VectorFloat *v, Quaternion *q);
 
 uint8_t MPUdmpGetEuler(float *data, Quaternion *q);
 uint8_t MPUdmpGetYawPitchRoll(float *data, Quaternion *q, VectorFloat *gravity);
+uint8_t MPUdmpGetEulerMode(float *data, Quaternion *q, uint8_t mode);
+uint8_t MPUdmpGetYawPitchRollMode(float *data, Quaternion *q, VectorFloat *gravity, uint8_t mode);
 
 // uint8_t MPU6050::dmpGetAccelFloat(float *data, const uint8_t* packet);
 // uint8_t MPU6050::dmpGetQuaternionFloat(float *data, const uint8_t* packet);
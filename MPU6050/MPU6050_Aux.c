@@ -0,0 +1,231 @@
+// I2Cdev library collection - MPU6050 I2C device class, auxiliary I2C scheduler
+// Programs the MPU's I2C master to sample external sensors into EXT_SENS_DATA
+//
+// Changelog:
+//     2026-10-18 - initial release
+//     2026-10-18 - add per-cycle write slaves (MPU6050_AUX_WRITE)
+//     2026-10-18 - refuse to reprogram the master while bypass is held
+//     2026-10-18 - burst buffer from the scratch arena (MPU6050_STATIC_SCRATCH)
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, auxiliary I2C code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#include "ch.h"
+#include "hal.h"
+
+#include "MPU6050.h"
+#include "MPU6050_Aux.h"
+#include "MPU6050_Bypass.h"
+#include "i2cdev_chibi.h"
+
+// SLVn_ADDR, SLVn_REG, SLVn_CTRL for n = 0..3 are adjacent (0x25-0x30)
+#define AUX_SLAVE_REGS          3
+#define AUX_MOTION_LENGTH       14  // ACCEL_XOUT_H..GYRO_ZOUT_L
+
+// I2C_MST_DLY is shared with SLV4 one-off transfers, which rewrite SLV4_CTRL
+static uint8_t auxMasterDelay = 0;
+
+/** Configure the I2C master to sample a list of external sensors.
+ * Sensor i is assigned to slave i, its data starts right after the data of
+ * sensor i - 1 in EXT_SENS_DATA. Unused slaves are disabled, bypass mode is
+ * switched off and the I2C master is enabled at 400kHz.
+ * @param sensors Sensor list, at most MPU6050_AUX_MAX_SENSORS entries
+ * @param count Number of sensors, 0 only disables all slaves
+ * @param map Output, decoder map (only valid on MPU6050_AUX_OK)
+ * @return MPU6050_AUX_OK or one of the MPU6050_AUX_* error codes
+ */
+uint8_t MPUauxConfigure(const MPUAuxSensor *sensors, uint8_t count, MPUAuxMap *map) {
+    uint8_t slaves[MPU6050_AUX_MAX_SENSORS * AUX_SLAVE_REGS], out[MPU6050_AUX_MAX_SENSORS];
+    uint8_t delayCtrl = 1 << MPU6050_DELAYCTRL_DELAY_ES_SHADOW_BIT;
+    uint8_t divisor = 1, offset = 0, mstCtrl, ctrl, i;
+
+    if (MPUbypassGetMode() == MPU6050_BUS_BYPASS) return MPU6050_AUX_BUSY;
+    if (count > MPU6050_AUX_MAX_SENSORS) return MPU6050_AUX_TOO_MANY;
+    for (i = 0; i < count; i++) {
+        if (sensors[i].divisor == 0 || sensors[i].divisor > MPU6050_AUX_MAX_DIVISOR) return MPU6050_AUX_BAD_DIVISOR;
+        if (sensors[i].divisor > 1) {
+            if (divisor > 1 && sensors[i].divisor != divisor) return MPU6050_AUX_BAD_DIVISOR;
+            divisor = sensors[i].divisor;
+        }
+        if (sensors[i].format == MPU6050_AUX_WRITE) continue;
+        if (sensors[i].length == 0 || sensors[i].length > MPU6050_AUX_MAX_READ) return MPU6050_AUX_BAD_LENGTH;
+        if (sensors[i].format != MPU6050_AUX_RAW && (sensors[i].length & 1)) return MPU6050_AUX_BAD_LENGTH;
+        offset += sensors[i].length;
+    }
+    if (offset > MPU6050_AUX_DATA_LENGTH) return MPU6050_AUX_NO_SPACE;
+
+    offset = 0;
+    for (i = 0; i < MPU6050_AUX_MAX_SENSORS; i++) {
+        out[i] = 0;
+        if (i >= count) {
+            slaves[i * AUX_SLAVE_REGS] = slaves[i * AUX_SLAVE_REGS + 1] = slaves[i * AUX_SLAVE_REGS + 2] = 0;
+            continue;
+        }
+        if (sensors[i].divisor > 1) delayCtrl |= 1 << (MPU6050_DELAYCTRL_I2C_SLV0_DLY_EN_BIT + i);
+        map -> field[i].offset = offset;
+        if (sensors[i].format == MPU6050_AUX_WRITE) {
+            // one byte from SLVn_DO, nothing lands in EXT_SENS_DATA
+            slaves[i * AUX_SLAVE_REGS] = sensors[i].address;
+            slaves[i * AUX_SLAVE_REGS + 1] = sensors[i].reg;
+            slaves[i * AUX_SLAVE_REGS + 2] = (1 << MPU6050_I2C_SLV_EN_BIT) | 1;
+            out[i] = sensors[i].value;
+            map -> field[i].length = 0;
+            map -> field[i].format = MPU6050_AUX_WRITE;
+            continue;
+        }
+        ctrl = (1 << MPU6050_I2C_SLV_EN_BIT) | sensors[i].length;
+        if (sensors[i].format == MPU6050_AUX_INT16_LE) {
+            // let the MPU swap the words; pairs start at odd registers with GRP set
+            ctrl |= 1 << MPU6050_I2C_SLV_BYTE_SW_BIT;
+            if (sensors[i].reg & 1) ctrl |= 1 << MPU6050_I2C_SLV_GRP_BIT;
+        }
+        slaves[i * AUX_SLAVE_REGS] = (1 << MPU6050_I2C_SLV_RW_BIT) | sensors[i].address;
+        slaves[i * AUX_SLAVE_REGS + 1] = sensors[i].reg;
+        slaves[i * AUX_SLAVE_REGS + 2] = ctrl;
+        map -> field[i].length = sensors[i].length;
+        map -> field[i].format = (sensors[i].format == MPU6050_AUX_RAW) ? MPU6050_AUX_RAW : MPU6050_AUX_INT16_BE;
+        offset += sensors[i].length;
+    }
+    map -> count = count;
+    map -> length = offset;
+
+    MPUsetI2CBypassEnabled(FALSE);
+    I2CdevwriteBytes(MPUdevAddr, MPU6050_RA_I2C_SLV0_DO, MPU6050_AUX_MAX_SENSORS, out);
+    I2CdevwriteBytes(MPUdevAddr, MPU6050_RA_I2C_SLV0_ADDR, MPU6050_AUX_MAX_SENSORS * AUX_SLAVE_REGS, slaves);
+
+    auxMasterDelay = divisor - 1;
+    MPUsetSlave4MasterDelay(auxMasterDelay);
+    I2CdevwriteByte(MPUdevAddr, MPU6050_RA_I2C_MST_DELAY_CTRL, delayCtrl);
+
+    // keep MULT_MST_EN and SLV_3_FIFO_EN, data ready waits for the external reads
+    I2CdevreadByte(MPUdevAddr, MPU6050_RA_I2C_MST_CTRL, &mstCtrl, I2CDEV_DEFAULT_READ_TIMEOUT);
+    mstCtrl = (mstCtrl & ((1 << MPU6050_MULT_MST_EN_BIT) | (1 << MPU6050_SLV_3_FIFO_EN_BIT)))
+            | (1 << MPU6050_WAIT_FOR_ES_BIT) | MPU6050_CLOCK_DIV_400;
+    I2CdevwriteByte(MPUdevAddr, MPU6050_RA_I2C_MST_CTRL, mstCtrl);
+
+    MPUsetI2CMasterModeEnabled(count > 0);
+    return MPU6050_AUX_OK;
+}
+
+/** Stop all scheduled external reads and disable the I2C master.
+ */
+void MPUauxDisable() {
+    uint8_t slaves[MPU6050_AUX_MAX_SENSORS * AUX_SLAVE_REGS], i;
+    for (i = 0; i < MPU6050_AUX_MAX_SENSORS * AUX_SLAVE_REGS; i++) slaves[i] = 0;
+    MPUsetI2CMasterModeEnabled(FALSE);
+    I2CdevwriteBytes(MPUdevAddr, MPU6050_RA_I2C_SLV0_ADDR, MPU6050_AUX_MAX_SENSORS * AUX_SLAVE_REGS, slaves);
+}
+
+/** Read all scheduled external sensor data in one burst.
+ * @param map Decoder map from MPUauxConfigure()
+ * @param data Output, map -> length bytes
+ */
+void MPUauxRead(const MPUAuxMap *map, uint8_t *data) {
+    if (map -> length > 0) I2CdevreadBytes(MPUdevAddr, MPU6050_RA_EXT_SENS_DATA_00, map -> length, data, I2CDEV_DEFAULT_READ_TIMEOUT);
+}
+
+/** Read accel, gyro and external sensor data in one burst.
+ * @param map Decoder map from MPUauxConfigure()
+ * @param accel Output, raw accel X/Y/Z
+ * @param gyro Output, raw gyro X/Y/Z
+ * @param data Output, map -> length bytes of external sensor data
+ */
+void MPUauxGetMotion6Ext(const MPUAuxMap *map, int16_t *accel, int16_t *gyro, uint8_t *data) {
+    MPU_SCRATCH(buffer, MPU6050_SCRATCH_BURST, AUX_MOTION_LENGTH + MPU6050_AUX_DATA_LENGTH);
+    uint8_t i;
+    I2CdevreadBytes(MPUdevAddr, MPU6050_RA_ACCEL_XOUT_H, AUX_MOTION_LENGTH + map -> length, buffer, I2CDEV_DEFAULT_READ_TIMEOUT);
+    for (i = 0; i < 3; i++) {
+        accel[i] = (((int16_t)buffer[2 * i]) << 8) | buffer[2 * i + 1];
+        gyro[i] = (((int16_t)buffer[8 + 2 * i]) << 8) | buffer[8 + 2 * i + 1];
+    }
+    for (i = 0; i < map -> length; i++) data[i] = buffer[AUX_MOTION_LENGTH + i];
+}
+
+/** Decode one word of a sensor's data.
+ * Little-endian sensors are already swapped by the MPU, so all words are
+ * big-endian here.
+ * @param map Decoder map from MPUauxConfigure()
+ * @param data External sensor data as returned by MPUauxRead()
+ * @param sensor Index in the sensor list passed to MPUauxConfigure()
+ * @param index Word index within the sensor's data
+ * @return Signed word
+ */
+int16_t MPUauxGetWord(const MPUAuxMap *map, const uint8_t *data, uint8_t sensor, uint8_t index) {
+    const uint8_t *p = data + map -> field[sensor].offset + 2 * index;
+    return (((int16_t)p[0]) << 8) | p[1];
+}
+
+/** Locate a sensor's raw data.
+ * @param map Decoder map from MPUauxConfigure()
+ * @param data External sensor data as returned by MPUauxRead()
+ * @param sensor Index in the sensor list passed to MPUauxConfigure()
+ * @return Pointer to map -> field[sensor].length bytes
+ */
+const uint8_t *MPUauxGetBytes(const MPUAuxMap *map, const uint8_t *data, uint8_t sensor) {
+    return data + map -> field[sensor].offset;
+}
+
+/** Start a SLV4 transfer and wait until it is done.
+ * SLV4_ADDR, SLV4_REG, SLV4_DO and SLV4_CTRL are adjacent and written in one
+ * burst; SLV4_CTRL keeps the scheduler's I2C_MST_DLY.
+ */
+static bool_t auxSlave4Transfer(uint8_t address, uint8_t reg, uint8_t value) {
+    uint8_t slave4[4], status, ms;
+    slave4[0] = address;
+    slave4[1] = reg;
+    slave4[2] = value;
+    slave4[3] = (1 << MPU6050_I2C_SLV4_EN_BIT) | auxMasterDelay;
+    I2CdevwriteBytes(MPUdevAddr, MPU6050_RA_I2C_SLV4_ADDR, 4, slave4);
+    for (ms = 0; ms < MPU6050_AUX_SLV4_TIMEOUT_MS; ms++) {
+        chThdSleepMilliseconds(1);
+        I2CdevreadByte(MPUdevAddr, MPU6050_RA_I2C_MST_STATUS, &status, I2CDEV_DEFAULT_READ_TIMEOUT);
+        if (status & (1 << MPU6050_MST_I2C_SLV4_NACK_BIT)) return FALSE;
+        if (status & (1 << MPU6050_MST_I2C_SLV4_DONE_BIT)) return TRUE;
+    }
+    return FALSE;
+}
+
+/** Write one register of an external sensor through SLV4.
+ * The I2C master has to be enabled (MPUsetI2CMasterModeEnabled()).
+ * @param address 7-bit I2C address
+ * @param reg Register address
+ * @param value Value to write
+ * @return TRUE if the transfer completed and was acknowledged
+ */
+bool_t MPUauxWriteByte(uint8_t address, uint8_t reg, uint8_t value) {
+    return auxSlave4Transfer(address, reg, value);
+}
+
+/** Read one register of an external sensor through SLV4.
+ * The I2C master has to be enabled (MPUsetI2CMasterModeEnabled()).
+ * @param address 7-bit I2C address
+ * @param reg Register address
+ * @param value Output, register value
+ * @return TRUE if the transfer completed and was acknowledged
+ */
+bool_t MPUauxReadByte(uint8_t address, uint8_t reg, uint8_t *value) {
+    if (!auxSlave4Transfer((1 << MPU6050_I2C_SLV4_RW_BIT) | address, reg, 0)) return FALSE;
+    I2CdevreadByte(MPUdevAddr, MPU6050_RA_I2C_SLV4_DI, value, I2CDEV_DEFAULT_READ_TIMEOUT);
+    return TRUE;
+}
@@ -0,0 +1,110 @@
+// I2Cdev library collection - MPU6050 I2C device class, auxiliary I2C scheduler
+// Programs the MPU's I2C master to sample external sensors into EXT_SENS_DATA
+//
+// Changelog:
+//     2026-10-18 - initial release
+//     2026-10-18 - add per-cycle write slaves (MPU6050_AUX_WRITE)
+//     2026-10-18 - refuse to reprogram the master while bypass is held
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, auxiliary I2C code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#ifndef _MPU6050_AUX_H_
+#define _MPU6050_AUX_H_
+
+/* The MPU's I2C master reads up to four external sensors (SLV0-3) once per
+ * sample and stores the results back to back in EXT_SENS_DATA_00..23, in
+ * slave order. MPUauxConfigure() takes a list of sensors, assigns slaves and
+ * EXT_SENS_DATA bytes in list order, programs all SLV0-3 ADDR/REG/CTRL
+ * registers in one burst and returns a map for decoding.
+ *
+ * With WAIT_FOR_ES set the data-ready interrupt waits for the external reads,
+ * so the secondary sensors are sampled in lockstep with accel/gyro. Since
+ * ACCEL_XOUT_H..EXT_SENS_DATA_23 (0x3B-0x60) is one contiguous block,
+ * MPUauxGetMotion6Ext() fetches motion data and external data in a single
+ * transaction.
+ *
+ * Rate divisors: a sensor with divisor n > 1 is read every n-th sample. The
+ * hardware has one shared delay (I2C_MST_DLY), so all sensors with n > 1
+ * must use the same n.
+ *
+ * A MPU6050_AUX_WRITE entry writes one byte per cycle instead, for sensors
+ * that need a trigger for every conversion (AK8975 single measurement mode).
+ *
+ * SLV4 is left to MPUauxWriteByte()/MPUauxReadByte() for one-off transfers,
+ * e.g. configuring a sensor before it is scheduled.
+ */
+#define MPU6050_AUX_MAX_SENSORS         4
+#define MPU6050_AUX_DATA_LENGTH         24      // EXT_SENS_DATA_00..23
+#define MPU6050_AUX_MAX_READ            15      // I2C_SLV_LEN is 4 bits
+#define MPU6050_AUX_MAX_DIVISOR         32      // I2C_MST_DLY is 5 bits
+#define MPU6050_AUX_SLV4_TIMEOUT_MS     10
+
+// MPUAuxSensor formats
+#define MPU6050_AUX_RAW                 0       // bytes as read
+#define MPU6050_AUX_INT16_BE            1       // big-endian words (e.g. HMC5883L)
+#define MPU6050_AUX_INT16_LE            2       // little-endian words (e.g. AK8975), swapped by the MPU
+#define MPU6050_AUX_WRITE               3       // write value to reg every cycle, no EXT_SENS_DATA used
+
+// MPUauxConfigure() return codes
+#define MPU6050_AUX_OK                  0
+#define MPU6050_AUX_TOO_MANY            1       // more than four sensors
+#define MPU6050_AUX_BAD_LENGTH          2       // 0, > 15, or odd for a word format
+#define MPU6050_AUX_NO_SPACE            3       // more than 24 bytes in total
+#define MPU6050_AUX_BAD_DIVISOR         4       // 0, > 32, or two different divisors > 1
+#define MPU6050_AUX_BUSY                5       // bus handed to the host, see MPU6050_Bypass.h
+
+typedef struct {
+        uint8_t address;    // 7-bit I2C address
+        uint8_t reg;        // first register of the read
+        uint8_t length;     // bytes per read, 1-15 (ignored for MPU6050_AUX_WRITE)
+        uint8_t divisor;    // access every n-th sample, 1 = every sample
+        uint8_t format;     // MPU6050_AUX_RAW, _INT16_BE, _INT16_LE or _WRITE
+        uint8_t value;      // byte written by MPU6050_AUX_WRITE (e.g. a measurement trigger)
+} MPUAuxSensor;
+
+typedef struct {
+        uint8_t offset;     // first byte in EXT_SENS_DATA
+        uint8_t length;
+        uint8_t format;
+} MPUAuxField;
+
+typedef struct {
+        MPUAuxField field[MPU6050_AUX_MAX_SENSORS];     // one per configured sensor, same order
+        uint8_t count;
+        uint8_t length;     // EXT_SENS_DATA bytes in use
+} MPUAuxMap;
+
+uint8_t MPUauxConfigure(const MPUAuxSensor *sensors, uint8_t count, MPUAuxMap *map);
+void MPUauxDisable(void);
+
+void MPUauxRead(const MPUAuxMap *map, uint8_t *data);
+void MPUauxGetMotion6Ext(const MPUAuxMap *map, int16_t *accel, int16_t *gyro, uint8_t *data);
+int16_t MPUauxGetWord(const MPUAuxMap *map, const uint8_t *data, uint8_t sensor, uint8_t index);
+const uint8_t *MPUauxGetBytes(const MPUAuxMap *map, const uint8_t *data, uint8_t sensor);
+
+bool_t MPUauxWriteByte(uint8_t address, uint8_t reg, uint8_t value);
+bool_t MPUauxReadByte(uint8_t address, uint8_t reg, uint8_t *value);
+
+#endif /* _MPU6050_AUX_H_ */
@@ -0,0 +1,93 @@
+// I2Cdev library collection - MPU6050 I2C device class, bypass mode manager
+// Arbitrates the auxiliary bus between the MPU's I2C master and host bypass
+//
+// Changelog:
+//     2026-10-18 - initial release
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, bypass mode code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#include "ch.h"
+#include "hal.h"
+
+#include "MPU6050.h"
+#include "MPU6050_Bypass.h"
+#include "i2cdev_chibi.h"
+
+// I2C_MST_CTRL and SLV0-3 ADDR/REG/CTRL are adjacent (0x24-0x30)
+#define BYPASS_MASTER_LENGTH    13
+
+static MUTEX_DECL(bypassMutex);
+static uint8_t bypassDepth = 0;
+static uint8_t bypassMaster[BYPASS_MASTER_LENGTH];
+static uint8_t bypassDelayCtrl;
+static bool_t bypassMasterWasEnabled;
+
+/** Hand the auxiliary bus to the host (I2C bypass).
+ * Nests: only the first call switches, later calls just count.
+ * @return TRUE if bypass is active, FALSE if the switch failed (nothing held)
+ */
+bool_t MPUbypassAcquire() {
+    uint8_t userCtrl;
+    bool_t ok = TRUE;
+
+    chMtxLock(&bypassMutex);
+    if (bypassDepth == 0) {
+        I2CdevreadBytes(MPUdevAddr, MPU6050_RA_I2C_MST_CTRL, BYPASS_MASTER_LENGTH, bypassMaster, I2CDEV_DEFAULT_READ_TIMEOUT);
+        I2CdevreadByte(MPUdevAddr, MPU6050_RA_I2C_MST_DELAY_CTRL, &bypassDelayCtrl, I2CDEV_DEFAULT_READ_TIMEOUT);
+        I2CdevreadByte(MPUdevAddr, MPU6050_RA_USER_CTRL, &userCtrl, I2CDEV_DEFAULT_READ_TIMEOUT);
+        bypassMasterWasEnabled = (userCtrl & (1 << MPU6050_USERCTRL_I2C_MST_EN_BIT)) != 0;
+
+        if (bypassMasterWasEnabled) {
+            I2CdevwriteByte(MPUdevAddr, MPU6050_RA_USER_CTRL, userCtrl & ~(1 << MPU6050_USERCTRL_I2C_MST_EN_BIT));
+            chThdSleepMilliseconds(MPU6050_BYPASS_SETTLE_MS);
+        }
+        ok = I2CdevwriteBit(MPUdevAddr, MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_I2C_BYPASS_EN_BIT, TRUE);
+        if (!ok && bypassMasterWasEnabled) MPUsetI2CMasterModeEnabled(TRUE);
+    }
+    if (ok) bypassDepth++;
+    chMtxUnlock();
+    return ok;
+}
+
+/** Give the auxiliary bus back to the MPU's I2C master.
+ * The last release restores the saved master and slave configuration.
+ */
+void MPUbypassRelease() {
+    chMtxLock(&bypassMutex);
+    if (bypassDepth > 0 && --bypassDepth == 0) {
+        MPUsetI2CBypassEnabled(FALSE);
+        I2CdevwriteBytes(MPUdevAddr, MPU6050_RA_I2C_MST_CTRL, BYPASS_MASTER_LENGTH, bypassMaster);
+        I2CdevwriteByte(MPUdevAddr, MPU6050_RA_I2C_MST_DELAY_CTRL, bypassDelayCtrl);
+        if (bypassMasterWasEnabled) MPUsetI2CMasterModeEnabled(TRUE);
+    }
+    chMtxUnlock();
+}
+
+/** Get the current owner of the auxiliary bus.
+ * @return MPU6050_BUS_BYPASS while bypass is held, MPU6050_BUS_MASTER otherwise
+ */
+uint8_t MPUbypassGetMode() {
+    return (bypassDepth > 0) ? MPU6050_BUS_BYPASS : MPU6050_BUS_MASTER;
+}
@@ -0,0 +1,67 @@
+// I2Cdev library collection - MPU6050 I2C device class, bypass mode manager
+// Arbitrates the auxiliary bus between the MPU's I2C master and host bypass
+//
+// Changelog:
+//     2026-10-18 - initial release
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, bypass mode code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#ifndef _MPU6050_BYPASS_H_
+#define _MPU6050_BYPASS_H_
+
+/* The auxiliary bus is either driven by the MPU's own I2C master (SLV0-4,
+ * sample-rate locked, see MPU6050_Aux.h) or, with I2C_BYPASS_EN, connected
+ * straight through to the host bus so downstream devices can be accessed at
+ * any rate. Both at once does not work, and switching behind the back of the
+ * scheduler leaves it half configured.
+ *
+ * MPUbypassAcquire() switches to bypass on the first call: it saves
+ * I2C_MST_CTRL, SLV0-3 and I2C_MST_DELAY_CTRL in two bursts, stops the master,
+ * lets a running transfer finish and sets I2C_BYPASS_EN. Calls nest; the last
+ * MPUbypassRelease() restores the master exactly as it was. A mutex guards
+ * the switch, and the per-transfer locking of the host bus stays with
+ * i2cAcquireBus() inside I2Cdev, so downstream devices are simply accessed
+ * with the I2Cdev functions and their own address, e.g.
+ *
+ *     if (MPUbypassAcquire()) {
+ *         I2CdevreadBytes(MPU6050_MAG_HMC5883L_ADDRESS, 0x03, 6, data, I2CDEV_DEFAULT_READ_TIMEOUT);
+ *         ...
+ *         MPUbypassRelease();
+ *     }
+ *
+ * While bypass is held MPUauxConfigure() refuses with MPU6050_AUX_BUSY.
+ * The state is kept for the currently selected device (MPUdevAddr).
+ */
+#define MPU6050_BYPASS_SETTLE_MS        1   // lets a running aux transfer finish
+
+// MPUbypassGetMode() values
+#define MPU6050_BUS_MASTER              0   // auxiliary bus owned by the MPU (or idle)
+#define MPU6050_BUS_BYPASS              1   // auxiliary bus passed through to the host
+
+bool_t MPUbypassAcquire(void);
+void MPUbypassRelease(void);
+uint8_t MPUbypassGetMode(void);
+
+#endif /* _MPU6050_BYPASS_H_ */
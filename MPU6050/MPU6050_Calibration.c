@@ -0,0 +1,296 @@
+// I2Cdev library collection - MPU6050 I2C device class, offset calibration
+// Computes and programs the gyro user offset and accel offset registers
+//
+// Changelog:
+//     2026-10-18 - initial release
+//     2026-10-18 - add blob persistence, burst access to the offset registers
+//     2026-10-18 - burst buffer from the scratch arena (MPU6050_STATIC_SCRATCH)
+//     2026-10-18 - blob without gain trims
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, calibration code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#include "ch.h"
+#include "hal.h"
+
+#include "MPU6050.h"
+#include "MPU6050_Calibration.h"
+#include "i2cdev_chibi.h"
+
+#define CALIB_SAMPLE_SIZE       12  // accel x/y/z + gyro x/y/z, temperature not queued
+#define CALIB_CHUNK_SAMPLES     (I2CDEV_BUFFER_LENGTH / CALIB_SAMPLE_SIZE)
+
+/* One register LSB in sample LSB: XG_OFFS_USR is scaled for +/-1000 deg/s,
+ * XA_OFFS for +/-16g, calibration runs at +/-250 deg/s and +/-2g. */
+#define CALIB_GYRO_STEP         4
+#define CALIB_ACCEL_STEP        8
+
+static int16_t calibDivRound(int32_t value, int32_t divisor) {
+    return (int16_t)((value >= 0) ? (value + divisor / 2) / divisor : (value - divisor / 2) / divisor);
+}
+
+/** Collect one batch of samples from the FIFO.
+ * The FIFO has to be enabled with accel and gyro X/Y/Z only (12 bytes per
+ * sample); it is reset first, so the batch holds fresh data only.
+ * @param mean Output, mean of [ax, ay, az, gx, gy, gz]
+ * @param span Output, peak-to-peak of [gx, gy, gz]
+ * @param ms Batch duration, at most 85ms at 1kHz before the FIFO overflows
+ * @return Number of samples averaged
+ */
+uint16_t MPUcalibrationReadMean(int16_t *mean, int16_t *span, uint16_t ms) {
+    MPU_SCRATCH(chunk, MPU6050_SCRATCH_BURST, CALIB_CHUNK_SAMPLES * CALIB_SAMPLE_SIZE);
+    int32_t sum[6] = { 0, 0, 0, 0, 0, 0 };
+    int16_t lo[3] = { 32767, 32767, 32767 }, hi[3] = { -32768, -32768, -32768 };
+    uint16_t available, samples = 0, skip = MPU6050_CALIB_SKIP_SAMPLES;
+    uint8_t n, i, j;
+    int16_t value;
+
+    MPUresetFIFO();
+    chThdSleepMilliseconds(ms);
+    available = MPUgetFIFOCount() / CALIB_SAMPLE_SIZE;
+
+    while (available > 0) {
+        n = (available > CALIB_CHUNK_SAMPLES) ? CALIB_CHUNK_SAMPLES : available;
+        MPUgetFIFOBytes(chunk, n * CALIB_SAMPLE_SIZE);
+        available -= n;
+        for (i = 0; i < n; i++) {
+            if (skip > 0) {
+                skip--;
+                continue;
+            }
+            for (j = 0; j < 6; j++) {
+                value = (((int16_t)chunk[i * CALIB_SAMPLE_SIZE + 2 * j]) << 8) | chunk[i * CALIB_SAMPLE_SIZE + 2 * j + 1];
+                sum[j] += value;
+                if (j >= 3) {
+                    if (value < lo[j - 3]) lo[j - 3] = value;
+                    if (value > hi[j - 3]) hi[j - 3] = value;
+                }
+            }
+            samples++;
+        }
+    }
+
+    for (j = 0; j < 6 && samples > 0; j++) mean[j] = calibDivRound(sum[j], samples);
+    for (j = 0; j < 3; j++) span[j] = (samples > 0) ? hi[j] - lo[j] : 0;
+    return samples;
+}
+
+static MPUCalibrationLoadHook calibLoadHook = 0;
+static MPUCalibrationSaveHook calibSaveHook = 0;
+static CalibrationBlob calibStored;
+static bool_t calibStoredValid = FALSE;
+
+/** Read both 6-byte offset register blocks into big-endian words.
+ * @param regAddr MPU6050_RA_XA_OFFS_H or MPU6050_RA_XG_OFFS_USRH
+ * @param offset Output, X/Y/Z register values
+ */
+static void calibReadBlock(uint8_t regAddr, int16_t *offset) {
+    uint8_t i;
+    I2CdevreadBytes(MPUdevAddr, regAddr, 6, MPUbuffer, I2CDEV_DEFAULT_READ_TIMEOUT);
+    for (i = 0; i < 3; i++) offset[i] = (((int16_t)MPUbuffer[2 * i]) << 8) | MPUbuffer[2 * i + 1];
+}
+
+/** Program X/Y/Z offsets with a single burst write.
+ * The accel (0x06-0x0B) and gyro user (0x13-0x18) blocks are not adjacent,
+ * the factory trim and self-test registers in between must not be touched.
+ * @param regAddr MPU6050_RA_XA_OFFS_H or MPU6050_RA_XG_OFFS_USRH
+ * @param offset X/Y/Z register values
+ */
+static void calibWriteBlock(uint8_t regAddr, const int16_t *offset) {
+    uint8_t data[6], i;
+    for (i = 0; i < 3; i++) {
+        data[2 * i] = (uint8_t)((uint16_t)offset[i] >> 8);
+        data[2 * i + 1] = (uint8_t)(offset[i] & 0xFF);
+    }
+    I2CdevwriteBytes(MPUdevAddr, regAddr, 6, data);
+}
+
+/** Read the offset registers currently programmed into the device.
+ * @param cal Output, offsets only (residuals and iterations are cleared)
+ */
+void MPUcalibrationRead(MPUCalibration *cal) {
+    uint8_t i;
+    calibReadBlock(MPU6050_RA_XG_OFFS_USRH, cal -> gyroOffset);
+    calibReadBlock(MPU6050_RA_XA_OFFS_H, cal -> accelOffset);
+    for (i = 0; i < 3; i++) cal -> gyroResidual[i] = cal -> accelResidual[i] = 0;
+    cal -> iterations = 0;
+}
+
+/** Program offsets from a previous calibration.
+ * @param cal Calibration result
+ */
+void MPUcalibrationApply(const MPUCalibration *cal) {
+    calibWriteBlock(MPU6050_RA_XG_OFFS_USRH, cal -> gyroOffset);
+    calibWriteBlock(MPU6050_RA_XA_OFFS_H, cal -> accelOffset);
+}
+
+/** Set the storage hooks used by MPUcalibrationSave/Load/Restore.
+ * Either hook may be 0 (e.g. read-only storage on a production unit).
+ * @param load Fills the buffer with a stored blob, FALSE if there is none
+ * @param save Writes the buffer to storage, FALSE on failure
+ */
+void MPUcalibrationSetHooks(MPUCalibrationLoadHook load, MPUCalibrationSaveHook save) {
+    calibLoadHook = load;
+    calibSaveHook = save;
+    calibStoredValid = FALSE;
+}
+
+/** Fill a blob from a calibration result.
+ * Temperature coefficients are cleared, the reference temperature
+ * is read from the device now.
+ * @param cal Calibration result
+ * @param blob Output
+ */
+void MPUcalibrationToBlob(const MPUCalibration *cal, CalibrationBlob *blob) {
+    uint8_t i;
+    for (i = 0; i < 3; i++) {
+        blob -> gyroOffset[i] = cal -> gyroOffset[i];
+        blob -> accelOffset[i] = cal -> accelOffset[i];
+        blob -> gyroTempCoeff[i] = 0;
+    }
+    blob -> tempRef = MPUgetTemperature();
+}
+
+/** Serialize a blob and hand it to the save hook.
+ * @param blob Calibration data
+ * @return TRUE if the save hook reported success
+ */
+bool_t MPUcalibrationSave(const CalibrationBlob *blob) {
+    uint8_t data[CALBLOB_SIZE];
+    if (calibSaveHook == 0) return FALSE;
+    calBlobPack(blob, data);
+    if (!calibSaveHook(data, CALBLOB_SIZE)) return FALSE;
+    calibStored = *blob;
+    calibStoredValid = TRUE;
+    return TRUE;
+}
+
+/** Fetch and verify a blob through the load hook.
+ * @param blob Output, only written when the blob is valid
+ * @return CALBLOB_OK or one of the CALBLOB_* error codes
+ */
+uint8_t MPUcalibrationLoad(CalibrationBlob *blob) {
+    uint8_t data[CALBLOB_SIZE];
+    if (calibLoadHook == 0 || !calibLoadHook(data, CALBLOB_SIZE)) return CALBLOB_NO_DATA;
+    return calBlobUnpack(blob, data, CALBLOB_SIZE);
+}
+
+/** Program the offsets stored in a blob, one burst per register block.
+ * @param blob Calibration data
+ */
+void MPUcalibrationApplyBlob(const CalibrationBlob *blob) {
+    calibWriteBlock(MPU6050_RA_XG_OFFS_USRH, blob -> gyroOffset);
+    calibWriteBlock(MPU6050_RA_XA_OFFS_H, blob -> accelOffset);
+}
+
+/** Program the stored calibration, loading it on first use.
+ * @return TRUE if a valid calibration was programmed, FALSE if none is stored
+ */
+bool_t MPUcalibrationRestore() {
+    if (!calibStoredValid) calibStoredValid = (MPUcalibrationLoad(&calibStored) == CALBLOB_OK);
+    if (calibStoredValid) MPUcalibrationApplyBlob(&calibStored);
+    return calibStoredValid;
+}
+
+/** Calibrate gyro (and optionally accel) offsets in place.
+ * The device has to be at rest, Z axis up. On success the offsets are left
+ * programmed in the device and returned in cal; on motion the original
+ * offsets are restored.
+ * @param cal Output, programmed offsets and remaining residuals
+ * @param calibrateAccel TRUE to also zero accel X/Y and set Z to +1g
+ * @return MPU6050_CALIB_OK or one of the MPU6050_CALIB_* error codes
+ */
+uint8_t MPUcalibrate(MPUCalibration *cal, bool_t calibrateAccel) {
+    MPUCalibration original;
+    int16_t mean[6], span[3];
+    uint8_t savedRate, savedDLPF, savedGyroRange, savedAccelRange, savedFIFOEn, i;
+    bool_t savedFIFO, done;
+    uint8_t status = MPU6050_CALIB_NOT_CONVERGED;
+
+    MPUcalibrationRead(&original);
+    *cal = original;
+
+    // save configuration, ranges come from the scale cache
+    savedRate = MPUgetRate();
+    savedDLPF = MPUgetDLPFMode();
+    savedGyroRange = MPUgyroRange;
+    savedAccelRange = MPUaccelRange;
+    savedFIFO = MPUgetFIFOEnabled();
+    I2CdevreadByte(MPUdevAddr, MPU6050_RA_FIFO_EN, &savedFIFOEn, I2CDEV_DEFAULT_READ_TIMEOUT);
+
+    // 1kHz, most sensitive ranges, accel + gyro into the FIFO
+    MPUsetDLPFMode(MPU6050_DLPF_BW_188);
+    MPUsetRate(0);
+    MPUsetFullScaleGyroRange(MPU6050_GYRO_FS_250);
+    MPUsetFullScaleAccelRange(MPU6050_ACCEL_FS_2);
+    I2CdevwriteByte(MPUdevAddr, MPU6050_RA_FIFO_EN, (1 << MPU6050_XG_FIFO_EN_BIT) | (1 << MPU6050_YG_FIFO_EN_BIT) | (1 << MPU6050_ZG_FIFO_EN_BIT) | (1 << MPU6050_ACCEL_FIFO_EN_BIT));
+    MPUsetFIFOEnabled(TRUE);
+
+    for (cal -> iterations = 1; cal -> iterations <= MPU6050_CALIB_MAX_ITERATIONS; cal -> iterations++) {
+        if (MPUcalibrationReadMean(mean, span, MPU6050_CALIB_BATCH_MS) == 0) {
+            status = MPU6050_CALIB_NO_DATA;
+            break;
+        }
+        if (span[0] > MPU6050_CALIB_MOTION_THRESHOLD || span[1] > MPU6050_CALIB_MOTION_THRESHOLD || span[2] > MPU6050_CALIB_MOTION_THRESHOLD) {
+            MPUcalibrationApply(&original);
+            *cal = original;
+            status = MPU6050_CALIB_MOTION;
+            break;
+        }
+
+        mean[2] -= MPU6050_CALIB_ACCEL_1G;
+        done = TRUE;
+        for (i = 0; i < 3; i++) {
+            cal -> gyroResidual[i] = mean[3 + i];
+            if (mean[3 + i] > MPU6050_CALIB_GYRO_TOLERANCE || mean[3 + i] < -MPU6050_CALIB_GYRO_TOLERANCE) {
+                done = FALSE;
+                cal -> gyroOffset[i] -= calibDivRound(mean[3 + i], CALIB_GYRO_STEP);
+            }
+            if (calibrateAccel) {
+                cal -> accelResidual[i] = mean[i];
+                if (mean[i] > MPU6050_CALIB_ACCEL_TOLERANCE || mean[i] < -MPU6050_CALIB_ACCEL_TOLERANCE) {
+                    done = FALSE;
+                    // keep bit 0, it is not part of the offset
+                    cal -> accelOffset[i] = ((cal -> accelOffset[i] - calibDivRound(mean[i], CALIB_ACCEL_STEP)) & ~1) | (original.accelOffset[i] & 1);
+                }
+            }
+        }
+        if (done) {
+            status = MPU6050_CALIB_OK;
+            break;
+        }
+        MPUcalibrationApply(cal);
+    }
+
+    // restore configuration
+    MPUsetFIFOEnabled(FALSE);
+    I2CdevwriteByte(MPUdevAddr, MPU6050_RA_FIFO_EN, savedFIFOEn);
+    MPUresetFIFO();
+    MPUsetFIFOEnabled(savedFIFO);
+    MPUsetFullScaleGyroRange(savedGyroRange);
+    MPUsetFullScaleAccelRange(savedAccelRange);
+    MPUsetDLPFMode(savedDLPF);
+    MPUsetRate(savedRate);
+    return status;
+}
@@ -0,0 +1,89 @@
+// I2Cdev library collection - MPU6050 I2C device class, offset calibration
+// Computes and programs the gyro user offset and accel offset registers
+//
+// Changelog:
+//     2026-10-18 - initial release
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, calibration code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#ifndef _MPU6050_CALIBRATION_H_
+#define _MPU6050_CALIBRATION_H_
+
+#include "helper_calblob.h"
+
+/* MPUcalibrate() samples accel and gyro through the FIFO at 1kHz in short
+ * batches, and after every batch moves the offset registers by the measured
+ * mean (a Newton step, the registers are linear in the output). It stops as
+ * soon as every axis is within tolerance, so a board that is already close
+ * finishes after two or three batches, well under two seconds in any case.
+ *
+ * The device must lie still with Z pointing up (+1g on Z) and the DMP must be
+ * disabled. Sample rate, DLPF, ranges and FIFO setup are restored afterwards.
+ */
+#define MPU6050_CALIB_BATCH_MS              70      // < 1024 byte FIFO at 12 bytes/ms
+#define MPU6050_CALIB_SKIP_SAMPLES          4       // settle time after an offset change
+#define MPU6050_CALIB_MAX_ITERATIONS        12
+#define MPU6050_CALIB_GYRO_TOLERANCE        4       // residual mean, LSB at +/-250 deg/s
+#define MPU6050_CALIB_ACCEL_TOLERANCE       16      // residual mean, LSB at +/-2g (~1mg)
+#define MPU6050_CALIB_MOTION_THRESHOLD      200     // gyro peak-to-peak per batch, LSB at +/-250 deg/s
+#define MPU6050_CALIB_ACCEL_1G              16384   // +1g at +/-2g
+
+// MPUcalibrate() return codes
+#define MPU6050_CALIB_OK                    0
+#define MPU6050_CALIB_MOTION                1       // device moved, offsets restored
+#define MPU6050_CALIB_NOT_CONVERGED         2       // best offsets so far are programmed
+#define MPU6050_CALIB_NO_DATA               3       // FIFO stayed empty
+
+typedef struct {
+        int16_t gyroOffset[3];      // XG/YG/ZG_OFFS_USR register values
+        int16_t accelOffset[3];     // XA/YA/ZA_OFFS register values (bit 0 untouched)
+        int16_t gyroResidual[3];    // mean remaining after the last step, LSB at +/-250 deg/s
+        int16_t accelResidual[3];   // mean remaining after the last step, LSB at +/-2g
+        uint8_t iterations;         // number of batches used
+} MPUCalibration;
+
+/* Persistence: the application provides the storage (flash page, EEPROM,
+ * backup registers) through two hooks that move a serialized CalibrationBlob
+ * (see helper_calblob.h). MPUcalibrationRestore() loads and verifies the blob
+ * once, keeps it in RAM and programs both offset register blocks with one
+ * burst write each; MPUdmpInitialize() calls it instead of zeroing the gyro
+ * user offsets, so a calibrated board comes up calibrated on every boot.
+ */
+typedef bool_t (*MPUCalibrationLoadHook)(uint8_t *data, uint8_t length);
+typedef bool_t (*MPUCalibrationSaveHook)(const uint8_t *data, uint8_t length);
+
+uint8_t MPUcalibrate(MPUCalibration *cal, bool_t calibrateAccel);
+void MPUcalibrationApply(const MPUCalibration *cal);
+void MPUcalibrationRead(MPUCalibration *cal);
+uint16_t MPUcalibrationReadMean(int16_t *mean, int16_t *span, uint16_t ms);
+
+void MPUcalibrationSetHooks(MPUCalibrationLoadHook load, MPUCalibrationSaveHook save);
+void MPUcalibrationToBlob(const MPUCalibration *cal, CalibrationBlob *blob);
+bool_t MPUcalibrationSave(const CalibrationBlob *blob);
+uint8_t MPUcalibrationLoad(CalibrationBlob *blob);
+void MPUcalibrationApplyBlob(const CalibrationBlob *blob);
+bool_t MPUcalibrationRestore(void);
+
+#endif /* _MPU6050_CALIBRATION_H_ */
@@ -0,0 +1,177 @@
+// I2Cdev library collection - MPU6050 I2C device class, interrupt event engine
+// Decodes INT_STATUS/MOT_DETECT_STATUS from one burst and dispatches handlers
+//
+// Changelog:
+//     2026-10-18 - initial release
+//     2026-10-18 - burst buffer from the scratch arena (MPU6050_STATIC_SCRATCH)
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, event engine code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#include "ch.h"
+#include "hal.h"
+
+#include "MPU6050.h"
+#include "MPU6050_Event.h"
+#include "i2cdev_chibi.h"
+
+#define EVENT_AXIS_MASK         0xFC00
+
+typedef struct {
+        uint16_t mask;
+        MPUEventHandler handler;
+        void *arg;
+} EventSlot;
+
+static EventSlot eventSlots[MPU6050_EVENT_MAX_HANDLERS];
+static uint8_t eventSlotCount = 0;
+static BSEMAPHORE_DECL(eventSemaphore, TRUE);
+
+/** Set all motion detection thresholds in one call.
+ * FF_THR..ZRMOT_DUR (0x1D-0x22) are written in one burst.
+ * @param thresholds Thresholds and MOT_DETECT_CTRL
+ */
+void MPUeventSetThresholds(const MPUEventThresholds *thresholds) {
+    uint8_t thr[6];
+    thr[0] = thresholds -> freefallThreshold;
+    thr[1] = thresholds -> freefallDuration;
+    thr[2] = thresholds -> motionThreshold;
+    thr[3] = thresholds -> motionDuration;
+    thr[4] = thresholds -> zeroMotionThreshold;
+    thr[5] = thresholds -> zeroMotionDuration;
+    I2CdevwriteBytes(MPUdevAddr, MPU6050_RA_FF_THR, 6, thr);
+    I2CdevwriteByte(MPUdevAddr, MPU6050_RA_MOT_DETECT_CTRL, thresholds -> detectCtrl);
+}
+
+/** Enable the interrupt sources behind a set of events.
+ * Replaces INT_ENABLE; axis bits are ignored, they come with MOTION.
+ * @param events MPU6050_EVENT_* mask
+ */
+void MPUeventEnable(uint16_t events) {
+    uint8_t enable = 0;
+    if (events & MPU6050_EVENT_DATA_READY) enable |= 1 << MPU6050_INTERRUPT_DATA_RDY_BIT;
+    if (events & MPU6050_EVENT_DMP) enable |= 1 << MPU6050_INTERRUPT_DMP_INT_BIT;
+    if (events & MPU6050_EVENT_I2C_MASTER) enable |= 1 << MPU6050_INTERRUPT_I2C_MST_INT_BIT;
+    if (events & MPU6050_EVENT_FIFO_OVERFLOW) enable |= 1 << MPU6050_INTERRUPT_FIFO_OFLOW_BIT;
+    if (events & (MPU6050_EVENT_ZERO_MOTION | MPU6050_EVENT_MOTION_RESUMED)) enable |= 1 << MPU6050_INTERRUPT_ZMOT_BIT;
+    if (events & (MPU6050_EVENT_MOTION | EVENT_AXIS_MASK)) enable |= 1 << MPU6050_INTERRUPT_MOT_BIT;
+    if (events & MPU6050_EVENT_FREEFALL) enable |= 1 << MPU6050_INTERRUPT_FF_BIT;
+    MPUsetIntEnabled(enable);
+}
+
+/** Register a handler.
+ * @param mask Events the handler is interested in
+ * @param handler Called from MPUeventDispatch() with the full event
+ * @param arg Passed through to the handler
+ * @return FALSE if all MPU6050_EVENT_MAX_HANDLERS slots are taken
+ */
+bool_t MPUeventRegister(uint16_t mask, MPUEventHandler handler, void *arg) {
+    if (eventSlotCount >= MPU6050_EVENT_MAX_HANDLERS) return FALSE;
+    eventSlots[eventSlotCount].mask = mask;
+    eventSlots[eventSlotCount].handler = handler;
+    eventSlots[eventSlotCount].arg = arg;
+    eventSlotCount++;
+    return TRUE;
+}
+
+/** Remove every registration of a handler.
+ * @param handler Handler
+ */
+void MPUeventUnregister(MPUEventHandler handler) {
+    uint8_t i, j = 0;
+    for (i = 0; i < eventSlotCount; i++) {
+        if (eventSlots[i].handler != handler) eventSlots[j++] = eventSlots[i];
+    }
+    eventSlotCount = j;
+}
+
+/** Read and decode both status registers and the sample in one burst.
+ * Reading clears INT_STATUS and MOT_DETECT_STATUS.
+ * @param event Output
+ * @return FALSE if the transfer failed
+ */
+bool_t MPUeventRead(MPUEvent *event) {
+    MPU_SCRATCH(data, MPU6050_SCRATCH_BURST, MPU6050_EVENT_BURST_LENGTH);
+    uint8_t st, i;
+    uint16_t events = 0;
+
+    if (!I2CdevreadBytes(MPUdevAddr, MPU6050_RA_INT_STATUS, MPU6050_EVENT_BURST_LENGTH, data, I2CDEV_DEFAULT_READ_TIMEOUT)) return FALSE;
+    st = data[0];
+    event -> intStatus = st;
+    event -> motStatus = data[MPU6050_EVENT_BURST_LENGTH - 1];
+
+    if (st & (1 << MPU6050_INTERRUPT_DATA_RDY_BIT)) events |= MPU6050_EVENT_DATA_READY;
+    if (st & (1 << MPU6050_INTERRUPT_DMP_INT_BIT)) events |= MPU6050_EVENT_DMP;
+    if (st & (1 << MPU6050_INTERRUPT_I2C_MST_INT_BIT)) events |= MPU6050_EVENT_I2C_MASTER;
+    if (st & (1 << MPU6050_INTERRUPT_FIFO_OFLOW_BIT)) events |= MPU6050_EVENT_FIFO_OVERFLOW;
+    if (st & (1 << MPU6050_INTERRUPT_ZMOT_BIT)) {
+        events |= (event -> motStatus & (1 << MPU6050_MOTION_MOT_ZRMOT_BIT)) ? MPU6050_EVENT_ZERO_MOTION : MPU6050_EVENT_MOTION_RESUMED;
+    }
+    if (st & (1 << MPU6050_INTERRUPT_MOT_BIT)) events |= MPU6050_EVENT_MOTION | (((uint16_t)event -> motStatus << 8) & EVENT_AXIS_MASK);
+    if (st & (1 << MPU6050_INTERRUPT_FF_BIT)) events |= MPU6050_EVENT_FREEFALL;
+    event -> events = events;
+
+    // ACCEL_XOUT_H..GYRO_ZOUT_L follow INT_STATUS directly
+    for (i = 0; i < 3; i++) {
+        event -> accel[i] = (((int16_t)data[1 + i * 2]) << 8) | data[2 + i * 2];
+        event -> gyro[i] = (((int16_t)data[9 + i * 2]) << 8) | data[10 + i * 2];
+    }
+    event -> temp = (((int16_t)data[7]) << 8) | data[8];
+    return TRUE;
+}
+
+/** Call every handler whose mask overlaps the event.
+ * @param event Decoded event
+ * @return The event mask
+ */
+uint16_t MPUeventDispatch(const MPUEvent *event) {
+    uint8_t i;
+    for (i = 0; i < eventSlotCount; i++) {
+        if (eventSlots[i].mask & event -> events) eventSlots[i].handler(event, eventSlots[i].arg);
+    }
+    return event -> events;
+}
+
+/** Read, decode and dispatch.
+ * @return Event mask, 0 if nothing was pending or the read failed
+ */
+uint16_t MPUeventPoll() {
+    MPUEvent event;
+    if (!MPUeventRead(&event)) return 0;
+    return MPUeventDispatch(&event);
+}
+
+/** Flag an INT assertion, for the EXT callback of the INT pin (I-class). */
+void MPUeventSignalI() {
+    chBSemSignalI(&eventSemaphore);
+}
+
+/** Wait for an INT assertion, then poll and dispatch.
+ * @param timeout System ticks, or TIME_INFINITE
+ * @return Event mask, 0 on timeout
+ */
+uint16_t MPUeventWait(systime_t timeout) {
+    if (chBSemWaitTimeout(&eventSemaphore, timeout) != RDY_OK) return 0;
+    return MPUeventPoll();
+}
@@ -0,0 +1,106 @@
+// I2Cdev library collection - MPU6050 I2C device class, interrupt event engine
+// Decodes INT_STATUS/MOT_DETECT_STATUS from one burst and dispatches handlers
+//
+// Changelog:
+//     2026-10-18 - initial release
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, event engine code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#ifndef _MPU6050_EVENT_H_
+#define _MPU6050_EVENT_H_
+
+/* One INT assertion costs one I2C transaction: INT_STATUS (0x3A) and
+ * MOT_DETECT_STATUS (0x61) enclose the accel/temp/gyro and EXT_SENS_DATA
+ * block, so a single 40-byte burst clears both status registers and brings
+ * the sample that came with the interrupt. Polling the individual getters
+ * instead takes ten transactions.
+ *
+ * The status bits are decoded into one MPU6050_EVENT_* mask. ZMOT fires on
+ * entering and on leaving zero-motion; MOT_ZRMOT from the same burst tells
+ * which, so the two edges are separate events. The high byte carries the
+ * axis and direction of the last motion event.
+ *
+ * Usage: call MPUeventSignalI() from the INT pin's EXT callback (inside
+ * chSysLockFromIsr()/chSysUnlockFromIsr()), and run MPUeventWait() in a
+ * thread; handlers are called from that thread in registration order.
+ *
+ *     MPUeventSetThresholds(&thresholds);
+ *     MPUeventRegister(MPU6050_EVENT_MOTION, startRecording, NULL);
+ *     MPUeventEnable(MPU6050_EVENT_MOTION | MPU6050_EVENT_ZERO_MOTION);
+ *     while (TRUE) MPUeventWait(TIME_INFINITE);
+ */
+#define MPU6050_EVENT_MAX_HANDLERS      8
+#define MPU6050_EVENT_BURST_LENGTH      (MPU6050_RA_MOT_DETECT_STATUS - MPU6050_RA_INT_STATUS + 1)
+
+#define MPU6050_EVENT_DATA_READY        0x0001
+#define MPU6050_EVENT_DMP               0x0002
+#define MPU6050_EVENT_I2C_MASTER        0x0004
+#define MPU6050_EVENT_FIFO_OVERFLOW     0x0008
+#define MPU6050_EVENT_ZERO_MOTION       0x0010  // board came to rest
+#define MPU6050_EVENT_MOTION_RESUMED    0x0020  // zero-motion ended
+#define MPU6050_EVENT_MOTION            0x0040
+#define MPU6050_EVENT_FREEFALL          0x0080
+#define MPU6050_EVENT_Z_POS             0x0400  // MOT_DETECT_STATUS << 8
+#define MPU6050_EVENT_Z_NEG             0x0800
+#define MPU6050_EVENT_Y_POS             0x1000
+#define MPU6050_EVENT_Y_NEG             0x2000
+#define MPU6050_EVENT_X_POS             0x4000
+#define MPU6050_EVENT_X_NEG             0x8000
+#define MPU6050_EVENT_ANY               0xFFFF
+
+typedef struct {
+        uint16_t events;                // MPU6050_EVENT_* mask
+        uint8_t intStatus;              // raw INT_STATUS
+        uint8_t motStatus;              // raw MOT_DETECT_STATUS
+        int16_t accel[3];               // sample from the same burst
+        int16_t temp;
+        int16_t gyro[3];
+} MPUEvent;
+
+typedef void (*MPUEventHandler)(const MPUEvent *event, void *arg);
+
+typedef struct {
+        uint8_t freefallThreshold;      // FF_THR, 2mg per LSB
+        uint8_t freefallDuration;       // FF_DUR, 1ms per LSB
+        uint8_t motionThreshold;        // MOT_THR, 2mg per LSB
+        uint8_t motionDuration;         // MOT_DUR, 1ms per LSB
+        uint8_t zeroMotionThreshold;    // ZRMOT_THR, 2mg per LSB
+        uint8_t zeroMotionDuration;     // ZRMOT_DUR, 64ms per LSB
+        uint8_t detectCtrl;             // MOT_DETECT_CTRL (on-delay, counter decrements)
+} MPUEventThresholds;
+
+void MPUeventSetThresholds(const MPUEventThresholds *thresholds);
+void MPUeventEnable(uint16_t events);
+
+bool_t MPUeventRegister(uint16_t mask, MPUEventHandler handler, void *arg);
+void MPUeventUnregister(MPUEventHandler handler);
+
+bool_t MPUeventRead(MPUEvent *event);
+uint16_t MPUeventDispatch(const MPUEvent *event);
+uint16_t MPUeventPoll(void);
+void MPUeventSignalI(void);
+uint16_t MPUeventWait(systime_t timeout);
+
+#endif /* _MPU6050_EVENT_H_ */
@@ -0,0 +1,225 @@
+// I2Cdev library collection - MPU6050 I2C device class, raw-mode sensor fusion
+// Mahony complementary filter running on the host MCU instead of the DMP
+//
+// Changelog:
+//     2026-10-18 - initial release: float and Q30 fixed-point Mahony filter
+//     2026-10-18 - Q30 accel normalization no longer saturates below 8192 counts
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, sensor fusion code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#include "ch.h"
+#include "hal.h"
+
+#include "MPU6050.h"
+#include "MPU6050_Fusion.h"
+
+// cycle counter used for the per-update statistics (DWT on Cortex-M3/M4)
+#if HAL_IMPLEMENTS_COUNTERS
+    #define FUSION_CYCLES()     ((uint32_t)halGetCounterValue())
+#else
+    #define FUSION_CYCLES()     0
+#endif
+
+/** Configure the sensor for raw-mode fusion.
+ * Selects the 188Hz DLPF (1kHz internal rate) and the sample rate divider for
+ * the requested output rate. The DMP is not involved.
+ * @param rateHz Output rate in Hz (4 to 1000)
+ * @see MPUsetRate()
+ * @see MPUsetDLPFMode()
+ */
+void MPUfusionSetupSensor(uint16_t rateHz) {
+    if (rateHz > 1000) rateHz = 1000;
+    if (rateHz < 4) rateHz = 4;
+    MPUsetDLPFMode(MPU6050_DLPF_BW_188);
+    MPUsetRate(1000 / rateHz - 1); // 1kHz / (1 + div)
+}
+
+static void fusionStoreCycles(uint32_t start, uint32_t *last, uint32_t *max) {
+    *last = FUSION_CYCLES() - start;
+    if (*last > *max) *max = *last;
+}
+
+/** Initialize the floating point filter.
+ * @param f Filter state
+ * @param sampleRate Rate MPUfusionUpdate() will be called at (Hz)
+ * @param gyroRange Configured gyro full scale (MPU6050_GYRO_FS_*)
+ * @param kp Proportional gain
+ * @param ki Integral gain (0 disables gyro bias estimation)
+ */
+void MPUfusionInit(MPUFusion *f, float sampleRate, uint8_t gyroRange, float kp, float ki) {
+    f -> q.w = 1.0f;
+    f -> q.x = f -> q.y = f -> q.z = 0.0f;
+    f -> twoKp = 2.0f * kp;
+    f -> twoKi = 2.0f * ki;
+    f -> integralFBx = f -> integralFBy = f -> integralFBz = 0.0f;
+    f -> halfDt = 0.5f / sampleRate;
+    f -> gyroScale = MPUgetGyroScaleForRange(gyroRange);
+    f -> lastCycles = f -> maxCycles = 0;
+}
+
+/** Run one filter step on a raw sample.
+ * @param f Filter state
+ * @param accel Raw accelerometer counts [x, y, z], any full scale
+ * @param gyro Raw gyroscope counts [x, y, z] at the range given to MPUfusionInit()
+ */
+void MPUfusionUpdate(MPUFusion *f, const int16_t *accel, const int16_t *gyro) {
+    uint32_t start = FUSION_CYCLES();
+    Quaternion *q = &f -> q;
+    float gx = gyro[0] * f -> gyroScale;
+    float gy = gyro[1] * f -> gyroScale;
+    float gz = gyro[2] * f -> gyroScale;
+    float ax = accel[0], ay = accel[1], az = accel[2];
+    float recipNorm, vx, vy, vz, ex, ey, ez, qw, qx, qy;
+
+    // accelerometer feedback only when the measurement is valid
+    if (accel[0] != 0 || accel[1] != 0 || accel[2] != 0) {
+        recipNorm = 1.0f / sqrtf(ax * ax + ay * ay + az * az);
+        ax *= recipNorm;
+        ay *= recipNorm;
+        az *= recipNorm;
+
+        // estimated direction of gravity (same as MPUdmpGetGravityVect)
+        vx = 2.0f * (q -> x * q -> z - q -> w * q -> y);
+        vy = 2.0f * (q -> w * q -> x + q -> y * q -> z);
+        vz = q -> w * q -> w - q -> x * q -> x - q -> y * q -> y + q -> z * q -> z;
+
+        // error is the cross product between measured and estimated gravity
+        ex = ay * vz - az * vy;
+        ey = az * vx - ax * vz;
+        ez = ax * vy - ay * vx;
+
+        if (f -> twoKi > 0.0f) {
+            f -> integralFBx += f -> twoKi * ex * 2.0f * f -> halfDt;
+            f -> integralFBy += f -> twoKi * ey * 2.0f * f -> halfDt;
+            f -> integralFBz += f -> twoKi * ez * 2.0f * f -> halfDt;
+            gx += f -> integralFBx;
+            gy += f -> integralFBy;
+            gz += f -> integralFBz;
+        }
+        gx += f -> twoKp * ex;
+        gy += f -> twoKp * ey;
+        gz += f -> twoKp * ez;
+    }
+
+    // integrate q' = 0.5 * q * (0, g)
+    gx *= f -> halfDt;
+    gy *= f -> halfDt;
+    gz *= f -> halfDt;
+    qw = q -> w;
+    qx = q -> x;
+    qy = q -> y;
+    q -> w += -qx * gx - qy * gy - q -> z * gz;
+    q -> x += qw * gx + qy * gz - q -> z * gy;
+    q -> y += qw * gy - qx * gz + q -> z * gx;
+    q -> z += qw * gz + qx * gy - qy * gx;
+    normalizeQuat(q);
+
+    fusionStoreCycles(start, &f -> lastCycles, &f -> maxCycles);
+}
+
+/** Read one sample with MPUgetMotion6() and run a filter step on it.
+ * @param f Filter state
+ */
+void MPUfusionUpdateFromSensor(MPUFusion *f) {
+    int16_t a[3], g[3];
+    MPUgetMotion6(&a[0], &a[1], &a[2], &g[0], &g[1], &g[2]);
+    MPUfusionUpdate(f, a, g);
+}
+
+/** Initialize the fixed-point filter.
+ * Float arithmetic is only used here, once, to convert the parameters.
+ * @param f Filter state
+ * @param sampleRate Rate MPUfusionUpdateQ30() will be called at (Hz)
+ * @param gyroRange Configured gyro full scale (MPU6050_GYRO_FS_*)
+ * @param kp Proportional gain (< 32768)
+ * @param ki Integral gain (0 disables gyro bias estimation)
+ */
+void MPUfusionInitQ30(MPUFusionQ30 *f, float sampleRate, uint8_t gyroRange, float kp, float ki) {
+    f -> q.w = FIX_Q30_ONE;
+    f -> q.x = f -> q.y = f -> q.z = 0;
+    f -> twoKp = (int32_t)(2.0f * kp * 65536.0f);
+    f -> twoKiDt = (int32_t)(2.0f * ki / sampleRate * (float)FIX_Q30_ONE);
+    f -> integralFB[0] = f -> integralFB[1] = f -> integralFB[2] = 0;
+    f -> halfDt = (int32_t)(0.5f / sampleRate * (float)FIX_Q30_ONE);
+    f -> gyroScale = (int32_t)(MPUgetGyroScaleForRange(gyroRange) * 16777216.0f);
+    f -> lastCycles = f -> maxCycles = 0;
+}
+
+/** Run one fixed-point filter step on a raw sample.
+ * Angular rates are carried in Q24 rad/s, unit vectors and the quaternion in
+ * Q30. Same algorithm as MPUfusionUpdate().
+ * @param f Filter state
+ * @param accel Raw accelerometer counts [x, y, z], any full scale
+ * @param gyro Raw gyroscope counts [x, y, z] at the range given to MPUfusionInitQ30()
+ */
+void MPUfusionUpdateQ30(MPUFusionQ30 *f, const int16_t *accel, const int16_t *gyro) {
+    uint32_t start = FUSION_CYCLES();
+    QuaternionQ30 *q = &f -> q;
+    int32_t g[3], a[3], v[3], e[3], qw, qx, qy, qz;
+    uint8_t i;
+
+    for (i = 0; i < 3; i++) g[i] = gyro[i] * f -> gyroScale;
+
+    if (fixNormalizeVectQ30(accel, a)) {
+        v[0] = (int32_t)(((int64_t)q -> x * q -> z - (int64_t)q -> w * q -> y) >> 29);
+        v[1] = (int32_t)(((int64_t)q -> w * q -> x + (int64_t)q -> y * q -> z) >> 29);
+        v[2] = (int32_t)(((int64_t)q -> w * q -> w - (int64_t)q -> x * q -> x - (int64_t)q -> y * q -> y + (int64_t)q -> z * q -> z) >> 30);
+
+        e[0] = (int32_t)(((int64_t)a[1] * v[2] - (int64_t)a[2] * v[1]) >> 30);
+        e[1] = (int32_t)(((int64_t)a[2] * v[0] - (int64_t)a[0] * v[2]) >> 30);
+        e[2] = (int32_t)(((int64_t)a[0] * v[1] - (int64_t)a[1] * v[0]) >> 30);
+
+        for (i = 0; i < 3; i++) {
+            if (f -> twoKiDt > 0) {
+                f -> integralFB[i] += (int32_t)(((int64_t)e[i] * f -> twoKiDt) >> 36); // Q30 * Q30 -> Q24
+                g[i] += f -> integralFB[i];
+            }
+            g[i] += (int32_t)(((int64_t)e[i] * f -> twoKp) >> 22); // Q30 * Q16 -> Q24
+        }
+    }
+
+    // integrate q' = 0.5 * q * (0, g), g * halfDt is an angle in Q24
+    for (i = 0; i < 3; i++) g[i] = (int32_t)(((int64_t)g[i] * f -> halfDt) >> 30);
+    qw = q -> w;
+    qx = q -> x;
+    qy = q -> y;
+    qz = q -> z;
+    q -> w += (int32_t)((-(int64_t)qx * g[0] - (int64_t)qy * g[1] - (int64_t)qz * g[2]) >> 24);
+    q -> x += (int32_t)(((int64_t)qw * g[0] + (int64_t)qy * g[2] - (int64_t)qz * g[1]) >> 24);
+    q -> y += (int32_t)(((int64_t)qw * g[1] - (int64_t)qx * g[2] + (int64_t)qz * g[0]) >> 24);
+    q -> z += (int32_t)(((int64_t)qw * g[2] + (int64_t)qx * g[1] - (int64_t)qy * g[0]) >> 24);
+    normalizeQuatQ30(q);
+
+    fusionStoreCycles(start, &f -> lastCycles, &f -> maxCycles);
+}
+
+/** Read one sample with MPUgetMotion6() and run a fixed-point filter step on it.
+ * @param f Filter state
+ */
+void MPUfusionUpdateFromSensorQ30(MPUFusionQ30 *f) {
+    int16_t a[3], g[3];
+    MPUgetMotion6(&a[0], &a[1], &a[2], &g[0], &g[1], &g[2]);
+    MPUfusionUpdateQ30(f, a, g);
+}
@@ -0,0 +1,83 @@
+// I2Cdev library collection - MPU6050 I2C device class, raw-mode sensor fusion
+// Mahony complementary filter running on the host MCU instead of the DMP
+//
+// Changelog:
+//     2026-10-18 - initial release: float and Q30 fixed-point Mahony filter
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, sensor fusion code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#ifndef _MPU6050_FUSION_H_
+#define _MPU6050_FUSION_H_
+
+#include "helper_3dmath.h"
+#include "helper_fixmath.h"
+
+/* Without the DMP the MPU6050 only delivers raw counts (MPUgetMotion6). The
+ * filter below turns them into an orientation quaternion on the host, at any
+ * sample rate the sensor supports (up to 1kHz with the DLPF enabled) and
+ * without the DMP firmware upload in MPUdmpInitialize().
+ *
+ * Gains follow Mahony's notation: Kp is the proportional gain pulling the
+ * estimate towards the accelerometer's gravity direction, Ki integrates the
+ * remaining error into a gyro bias estimate (0 disables it).
+ */
+#define MPU6050_FUSION_DEFAULT_KP   0.5f
+#define MPU6050_FUSION_DEFAULT_KI   0.0f
+
+typedef struct {
+        Quaternion q;               // current orientation estimate
+        float twoKp;                // 2 * proportional gain
+        float twoKi;                // 2 * integral gain
+        float integralFBx;          // integral error terms scaled by Ki (rad/s)
+        float integralFBy;
+        float integralFBz;
+        float halfDt;               // 0.5 * sample period (s)
+        float gyroScale;            // rad/s per LSB for the configured FS_SEL
+        uint32_t lastCycles;        // cycle count of the latest update
+        uint32_t maxCycles;         // worst case cycle count since init
+} MPUFusion;
+
+typedef struct {
+        QuaternionQ30 q;            // current orientation estimate (Q30)
+        int32_t twoKp;              // 2 * proportional gain (Q16)
+        int32_t twoKiDt;            // 2 * integral gain * sample period (Q30)
+        int32_t integralFB[3];      // integral error terms (rad/s, Q24)
+        int32_t halfDt;             // 0.5 * sample period (s, Q30)
+        int32_t gyroScale;          // rad/s per LSB for the configured FS_SEL (Q24)
+        uint32_t lastCycles;
+        uint32_t maxCycles;
+} MPUFusionQ30;
+
+void MPUfusionSetupSensor(uint16_t rateHz);
+
+void MPUfusionInit(MPUFusion *f, float sampleRate, uint8_t gyroRange, float kp, float ki);
+void MPUfusionUpdate(MPUFusion *f, const int16_t *accel, const int16_t *gyro);
+void MPUfusionUpdateFromSensor(MPUFusion *f);
+
+void MPUfusionInitQ30(MPUFusionQ30 *f, float sampleRate, uint8_t gyroRange, float kp, float ki);
+void MPUfusionUpdateQ30(MPUFusionQ30 *f, const int16_t *accel, const int16_t *gyro);
+void MPUfusionUpdateFromSensorQ30(MPUFusionQ30 *f);
+
+#endif /* _MPU6050_FUSION_H_ */
@@ -0,0 +1,241 @@
+// I2Cdev library collection - MPU6050 I2C device class, auxiliary magnetometer
+// HMC5883L/AK8975 setup on the auxiliary bus and hard/soft-iron calibration
+//
+// Changelog:
+//     2026-10-18 - initial release
+//     2026-10-18 - do not touch the master while bypass is held
+//     2026-10-18 - restore the previous auxiliary setup when initialization fails
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, magnetometer code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#include "ch.h"
+#include "hal.h"
+
+#include "MPU6050.h"
+#include "MPU6050_Mag.h"
+#include "MPU6050_Bypass.h"
+#include "i2cdev_chibi.h"
+
+// HMC5883L registers
+#define HMC5883L_RA_CONFIG_A    0x00
+#define HMC5883L_RA_CONFIG_B    0x01
+#define HMC5883L_RA_MODE        0x02
+#define HMC5883L_RA_DATAX_H     0x03    // X, Z, Y, big-endian
+#define HMC5883L_RA_ID_A        0x0A
+#define HMC5883L_CONFIG_A       0x18    // 1 sample averaged, 75Hz, normal bias
+#define HMC5883L_CONFIG_B       0x20    // +/-1.3Ga, 1090 LSB/Ga
+#define HMC5883L_MODE_CONT      0x00
+#define HMC5883L_UT_PER_LSB     (100.0f / 1090.0f)
+
+// AK8975 registers
+#define AK8975_RA_WIA           0x00
+#define AK8975_RA_HXL           0x03    // X, Y, Z, little-endian
+#define AK8975_RA_CNTL          0x0A
+#define AK8975_RA_ASAX          0x10
+#define AK8975_WIA              0x48
+#define AK8975_MODE_POWERDOWN   0x00
+#define AK8975_MODE_SINGLE      0x01
+#define AK8975_MODE_FUSE_ROM    0x0F
+#define AK8975_UT_PER_LSB       0.3f
+
+// I2C_MST_CTRL and SLVn_ADDR, SLVn_REG, SLVn_CTRL for n = 0..3 are adjacent (0x24-0x30)
+#define MAG_AUX_STATE_LENGTH    13
+
+/* Identify the magnetometer through SLV4, set it up and fill in the
+ * schedule for it. The I2C master has to be running. */
+static uint8_t magProbe(MPUMagnetometer *mag, uint8_t type, MPUAuxSensor *sensors, uint8_t *count, uint8_t *axisOffset) {
+    uint8_t id, asa[3], i;
+
+    if (type == MPU6050_MAG_HMC5883L) {
+        if (!MPUauxReadByte(MPU6050_MAG_HMC5883L_ADDRESS, HMC5883L_RA_ID_A, &id) || id != 'H') return MPU6050_MAG_NOT_FOUND;
+        MPUauxWriteByte(MPU6050_MAG_HMC5883L_ADDRESS, HMC5883L_RA_CONFIG_A, HMC5883L_CONFIG_A);
+        MPUauxWriteByte(MPU6050_MAG_HMC5883L_ADDRESS, HMC5883L_RA_CONFIG_B, HMC5883L_CONFIG_B);
+        MPUauxWriteByte(MPU6050_MAG_HMC5883L_ADDRESS, HMC5883L_RA_MODE, HMC5883L_MODE_CONT);
+        for (i = 0; i < 3; i++) mag -> scale[i] = HMC5883L_UT_PER_LSB;
+
+        sensors[0].address = MPU6050_MAG_HMC5883L_ADDRESS;
+        sensors[0].reg = HMC5883L_RA_DATAX_H;
+        sensors[0].format = MPU6050_AUX_INT16_BE;
+        *count = 1;
+        axisOffset[0] = 0;
+        axisOffset[1] = 4;
+        axisOffset[2] = 2;
+    } else if (type == MPU6050_MAG_AK8975) {
+        if (!MPUauxReadByte(MPU6050_MAG_AK8975_ADDRESS, AK8975_RA_WIA, &id) || id != AK8975_WIA) return MPU6050_MAG_NOT_FOUND;
+        // sensitivity adjustment from the fuse ROM
+        MPUauxWriteByte(MPU6050_MAG_AK8975_ADDRESS, AK8975_RA_CNTL, AK8975_MODE_FUSE_ROM);
+        for (i = 0; i < 3; i++) {
+            if (!MPUauxReadByte(MPU6050_MAG_AK8975_ADDRESS, AK8975_RA_ASAX + i, &asa[i])) asa[i] = 128;
+            mag -> scale[i] = AK8975_UT_PER_LSB * ((asa[i] - 128) / 256.0f + 1.0f);
+        }
+        MPUauxWriteByte(MPU6050_MAG_AK8975_ADDRESS, AK8975_RA_CNTL, AK8975_MODE_POWERDOWN);
+
+        sensors[0].address = MPU6050_MAG_AK8975_ADDRESS;
+        sensors[0].reg = AK8975_RA_HXL;
+        sensors[0].format = MPU6050_AUX_INT16_LE;
+        // trigger the next conversion right after reading the last one
+        sensors[1].address = MPU6050_MAG_AK8975_ADDRESS;
+        sensors[1].reg = AK8975_RA_CNTL;
+        sensors[1].format = MPU6050_AUX_WRITE;
+        sensors[1].value = AK8975_MODE_SINGLE;
+        sensors[1].length = 0;
+        *count = 2;
+        axisOffset[0] = 0;
+        axisOffset[1] = 2;
+        axisOffset[2] = 4;
+    } else {
+        return MPU6050_MAG_NOT_FOUND;
+    }
+    sensors[0].length = 6;
+    sensors[0].value = 0;
+    return MPU6050_MAG_OK;
+}
+
+/** Set up a magnetometer on the auxiliary bus for MPUgetMotion9().
+ * Replaces any previous auxiliary schedule; the magnetometer becomes sensor 0.
+ * On failure the previous schedule, master clock and master/bypass state
+ * are put back.
+ * @param mag Output, sensitivity and data layout; calibration is reset
+ * @param type MPU6050_MAG_HMC5883L or MPU6050_MAG_AK8975
+ * @param divisor Read the magnetometer every n-th sample (1-32)
+ * @return MPU6050_MAG_OK or one of the MPU6050_MAG_* error codes
+ */
+uint8_t MPUmagInitialize(MPUMagnetometer *mag, uint8_t type, uint8_t divisor) {
+    MPUAuxSensor sensors[2];
+    uint8_t saved[MAG_AUX_STATE_LENGTH], axisOffset[3], count = 0, status, i;
+    bool_t savedMaster, savedBypass;
+
+    if (MPUbypassGetMode() == MPU6050_BUS_BYPASS) return MPU6050_MAG_AUX_ERROR;
+    I2CdevreadBytes(MPUdevAddr, MPU6050_RA_I2C_MST_CTRL, MAG_AUX_STATE_LENGTH, saved, I2CDEV_DEFAULT_READ_TIMEOUT);
+    savedMaster = MPUgetI2CMasterModeEnabled();
+    savedBypass = MPUgetI2CBypassEnabled();
+
+    // SLV4 transfers need the master running, disable the old schedule first
+    MPUauxDisable();
+    MPUsetI2CBypassEnabled(FALSE);
+    MPUsetMasterClockSpeed(MPU6050_CLOCK_DIV_400);
+    MPUsetI2CMasterModeEnabled(TRUE);
+
+    mag -> type = type;
+    sensors[0].divisor = sensors[1].divisor = divisor;
+    status = magProbe(mag, type, sensors, &count, axisOffset);
+    if (status == MPU6050_MAG_OK && MPUauxConfigure(sensors, count, &mag -> map) != MPU6050_AUX_OK) status = MPU6050_MAG_AUX_ERROR;
+    if (status != MPU6050_MAG_OK) {
+        // master off while the old schedule goes back in
+        MPUsetI2CMasterModeEnabled(FALSE);
+        I2CdevwriteBytes(MPUdevAddr, MPU6050_RA_I2C_MST_CTRL, MAG_AUX_STATE_LENGTH, saved);
+        MPUsetI2CBypassEnabled(savedBypass);
+        MPUsetI2CMasterModeEnabled(savedMaster);
+        return status;
+    }
+    for (i = 0; i < 3; i++) MPUmagAxisOffset[i] = axisOffset[i];
+    MPUmagCalibrationReset(mag);
+    return MPU6050_MAG_OK;
+}
+
+/** Apply hard- and soft-iron calibration to a raw reading.
+ * @param mag Magnetometer
+ * @param raw Raw X/Y/Z as returned by MPUgetMotion9()
+ * @param out Output, field in uT
+ */
+void MPUmagCorrect(const MPUMagnetometer *mag, const int16_t *raw, float *out) {
+    float v[3];
+    uint8_t i;
+    for (i = 0; i < 3; i++) v[i] = (raw[i] - mag -> hardIron[i]) * mag -> scale[i];
+    for (i = 0; i < 3; i++) out[i] = mag -> softIron[i][0] * v[0] + mag -> softIron[i][1] * v[1] + mag -> softIron[i][2] * v[2];
+}
+
+/** Read a full 9-DoF sample in one transaction and calibrate the field.
+ * @param mag Magnetometer
+ * @param accel Output, raw accel X/Y/Z
+ * @param gyro Output, raw gyro X/Y/Z
+ * @param field Output, calibrated field in uT
+ */
+void MPUmagGetMotion9(const MPUMagnetometer *mag, int16_t *accel, int16_t *gyro, float *field) {
+    int16_t raw[3];
+    MPUgetMotion9(&accel[0], &accel[1], &accel[2], &gyro[0], &gyro[1], &gyro[2], &raw[0], &raw[1], &raw[2]);
+    MPUmagCorrect(mag, raw, field);
+}
+
+/** Clear the calibration (no offsets, identity matrix) and start a new sweep.
+ * @param mag Magnetometer
+ */
+void MPUmagCalibrationReset(MPUMagnetometer *mag) {
+    uint8_t i, j;
+    for (i = 0; i < 3; i++) {
+        mag -> hardIron[i] = 0.0f;
+        for (j = 0; j < 3; j++) mag -> softIron[i][j] = (i == j) ? 1.0f : 0.0f;
+        mag -> min[i] = 32767;
+        mag -> max[i] = -32768;
+    }
+}
+
+/** Add a raw reading to the calibration sweep.
+ * @param mag Magnetometer
+ * @param raw Raw X/Y/Z
+ */
+void MPUmagCalibrationAdd(MPUMagnetometer *mag, const int16_t *raw) {
+    uint8_t i;
+    for (i = 0; i < 3; i++) {
+        if (raw[i] < mag -> min[i]) mag -> min[i] = raw[i];
+        if (raw[i] > mag -> max[i]) mag -> max[i] = raw[i];
+    }
+}
+
+/** Estimate hard-iron offsets and a diagonal soft-iron matrix from the sweep.
+ * The offsets center each axis, the matrix scales each axis to the mean
+ * radius so the corrected field lies on a sphere.
+ * @param mag Magnetometer
+ * @return FALSE if an axis has not been swept through MPU6050_MAG_MIN_SPAN
+ */
+bool_t MPUmagCalibrationSolve(MPUMagnetometer *mag) {
+    float radius[3], mean = 0.0f;
+    uint8_t i, j;
+    for (i = 0; i < 3; i++) {
+        if (mag -> max[i] - mag -> min[i] < MPU6050_MAG_MIN_SPAN) return FALSE;
+    }
+    for (i = 0; i < 3; i++) {
+        mag -> hardIron[i] = (mag -> max[i] + mag -> min[i]) * 0.5f;
+        radius[i] = (mag -> max[i] - mag -> min[i]) * 0.5f * mag -> scale[i];
+        mean += radius[i] / 3.0f;
+    }
+    for (i = 0; i < 3; i++) {
+        for (j = 0; j < 3; j++) mag -> softIron[i][j] = (i == j) ? mean / radius[i] : 0.0f;
+    }
+    return TRUE;
+}
+
+/** Set a calibration computed elsewhere, e.g. an ellipsoid fit on the host.
+ * @param mag Magnetometer
+ * @param hardIron X/Y/Z offsets in raw LSB
+ * @param softIron 3x3 row-major matrix applied to the offset-corrected uT vector
+ */
+void MPUmagSetCalibration(MPUMagnetometer *mag, const float *hardIron, const float *softIron) {
+    uint8_t i, j;
+    for (i = 0; i < 3; i++) {
+        mag -> hardIron[i] = hardIron[i];
+        for (j = 0; j < 3; j++) mag -> softIron[i][j] = softIron[i * 3 + j];
+    }
+}
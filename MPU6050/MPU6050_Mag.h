@@ -0,0 +1,83 @@
+// I2Cdev library collection - MPU6050 I2C device class, auxiliary magnetometer
+// HMC5883L/AK8975 setup on the auxiliary bus and hard/soft-iron calibration
+//
+// Changelog:
+//     2026-10-18 - initial release
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, magnetometer code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#ifndef _MPU6050_MAG_H_
+#define _MPU6050_MAG_H_
+
+#include "MPU6050_Aux.h"
+
+/* MPUmagInitialize() configures the magnetometer through SLV4 and schedules
+ * its six data bytes as auxiliary sensor 0, so MPUgetMotion9() returns
+ * accel, gyro and magnetometer from a single 20-byte burst.
+ *
+ * The AK8975 has no continuous mode: a second slave rewrites CNTL with the
+ * single measurement trigger every cycle. A conversion takes up to 9ms, so
+ * sample rate / divisor has to stay at or below 100Hz. The HMC5883L runs
+ * continuously at 75Hz; reading faster just repeats samples.
+ *
+ * Calibration: hard-iron offsets (raw LSB) are subtracted first, then the
+ * per-axis sensitivity gives uT, then the soft-iron matrix corrects scale,
+ * cross-axis coupling and mounting rotation. MPUmagCalibrationAdd/Solve
+ * estimate offsets and a diagonal matrix from min/max while the board is
+ * turned through all orientations; a full matrix from a host-side ellipsoid
+ * fit can be set with MPUmagSetCalibration().
+ */
+#define MPU6050_MAG_HMC5883L            1
+#define MPU6050_MAG_AK8975              2
+
+#define MPU6050_MAG_HMC5883L_ADDRESS    0x1E
+#define MPU6050_MAG_AK8975_ADDRESS      0x0C
+#define MPU6050_MAG_MIN_SPAN            100     // min-max per axis (raw LSB) before Solve accepts
+
+// MPUmagInitialize() return codes
+#define MPU6050_MAG_OK                  0
+#define MPU6050_MAG_NOT_FOUND           1       // no answer or wrong ID
+#define MPU6050_MAG_AUX_ERROR           2       // auxiliary scheduler rejected the setup or bypass is held
+
+typedef struct {
+        uint8_t type;               // MPU6050_MAG_HMC5883L or MPU6050_MAG_AK8975
+        float scale[3];             // uT per LSB, AK8975 includes the fuse ROM adjustment
+        float hardIron[3];          // raw LSB
+        float softIron[3][3];       // applied to the offset-corrected uT vector
+        int16_t min[3];             // calibration sweep extremes, raw LSB
+        int16_t max[3];
+        MPUAuxMap map;              // auxiliary data layout
+} MPUMagnetometer;
+
+uint8_t MPUmagInitialize(MPUMagnetometer *mag, uint8_t type, uint8_t divisor);
+void MPUmagCorrect(const MPUMagnetometer *mag, const int16_t *raw, float *out);
+void MPUmagGetMotion9(const MPUMagnetometer *mag, int16_t *accel, int16_t *gyro, float *field);
+
+void MPUmagCalibrationReset(MPUMagnetometer *mag);
+void MPUmagCalibrationAdd(MPUMagnetometer *mag, const int16_t *raw);
+bool_t MPUmagCalibrationSolve(MPUMagnetometer *mag);
+void MPUmagSetCalibration(MPUMagnetometer *mag, const float *hardIron, const float *softIron);
+
+#endif /* _MPU6050_MAG_H_ */
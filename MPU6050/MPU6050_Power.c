@@ -0,0 +1,194 @@
+// I2Cdev library collection - MPU6050 I2C device class, power mode manager
+// Wake-on-motion with accel-only cycle mode and zero-motion fallback
+//
+// Changelog:
+//     2026-10-18 - initial release
+//     2026-10-18 - accept both status registers from the event engine
+//     2026-10-18 - account in system ticks, convert to ms only in MPUpowerGetStats()
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, power mode code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#include "ch.h"
+#include "hal.h"
+
+#include "MPU6050.h"
+#include "MPU6050_Power.h"
+#include "i2cdev_chibi.h"
+
+#define POWER_GYRO_STANDBY      ((1 << MPU6050_PWR2_STBY_XG_BIT) | (1 << MPU6050_PWR2_STBY_YG_BIT) | (1 << MPU6050_PWR2_STBY_ZG_BIT))
+#define POWER_WAKE_SHIFT        (MPU6050_PWR2_LP_WAKE_CTRL_BIT - MPU6050_PWR2_LP_WAKE_CTRL_LENGTH + 1)
+
+static const uint16_t powerCycleCurrent[4] = MPU6050_POWER_CYCLE_UA;
+
+static MPUPowerConfig powerConfig;
+static uint8_t powerState = MPU6050_POWER_ACTIVE;
+static systime_t powerSince;
+static uint64_t powerTime[MPU6050_POWER_STATES];     // system ticks, no rounding per transition
+static uint32_t powerTransitions;
+
+// move the time since the last call to the current state
+static void powerAccount(void) {
+    systime_t now = chTimeNow();
+    powerTime[powerState] += (systime_t)(now - powerSince);
+    powerSince = now;
+}
+
+/** Program the motion thresholds and start in active mode.
+ * @param config Thresholds and options, copied
+ */
+void MPUpowerInit(const MPUPowerConfig *config) {
+    uint8_t thr[4];
+
+    powerConfig = *config;
+    // MOT_THR, MOT_DUR, ZRMOT_THR, ZRMOT_DUR are adjacent
+    thr[0] = config -> motionThreshold;
+    thr[1] = config -> motionDuration;
+    thr[2] = config -> zeroMotionThreshold;
+    thr[3] = config -> zeroMotionDuration;
+    I2CdevwriteBytes(MPUdevAddr, MPU6050_RA_MOT_THR, 4, thr);
+
+    MPUpowerResetStats();
+    powerState = MPU6050_POWER_SLEEP;
+    MPUpowerEnter(MPU6050_POWER_ACTIVE);
+    powerTransitions = 0;
+}
+
+/** Switch to a power state.
+ * PWR_MGMT_1 and PWR_MGMT_2 are written together; entering active mode
+ * blocks for the gyro start-up, entering cycle mode for the filter settling.
+ * @param state MPU6050_POWER_ACTIVE, _CYCLE or _SLEEP
+ */
+void MPUpowerEnter(uint8_t state) {
+    uint8_t pwr[2];
+
+    powerAccount();
+    if (powerConfig.dmp && powerState == MPU6050_POWER_ACTIVE && state != MPU6050_POWER_ACTIVE) MPUsetDMPEnabled(FALSE);
+
+    if (state == MPU6050_POWER_ACTIVE) {
+        pwr[0] = MPU6050_CLOCK_PLL_XGYRO;
+        pwr[1] = 0;
+        I2CdevwriteBytes(MPUdevAddr, MPU6050_RA_PWR_MGMT_1, 2, pwr);
+        chThdSleepMilliseconds(MPU6050_POWER_GYRO_START_MS);
+        // zero-motion detection compares against the filtered accel
+        MPUsetDHPFMode(MPU6050_DHPF_5);
+        MPUgetIntStatus();
+        MPUsetIntEnabled((1 << MPU6050_INTERRUPT_ZMOT_BIT) | powerConfig.activeInterrupts);
+        if (powerConfig.dmp) {
+            MPUresetFIFO();
+            MPUsetDMPEnabled(TRUE);
+        }
+    } else if (state == MPU6050_POWER_CYCLE) {
+        // accel only, let the high-pass filter track the resting orientation, then hold it
+        pwr[0] = MPU6050_CLOCK_INTERNAL | (1 << MPU6050_PWR1_TEMP_DIS_BIT);
+        pwr[1] = (powerConfig.wakeFrequency << POWER_WAKE_SHIFT) | POWER_GYRO_STANDBY;
+        I2CdevwriteBytes(MPUdevAddr, MPU6050_RA_PWR_MGMT_1, 2, pwr);
+        MPUsetDHPFMode(MPU6050_DHPF_5);
+        chThdSleepMilliseconds(MPU6050_POWER_HPF_SETTLE_MS);
+        MPUsetDHPFMode(MPU6050_DHPF_HOLD);
+        MPUsetIntEnabled(1 << MPU6050_INTERRUPT_MOT_BIT);
+        MPUgetIntStatus();
+        I2CdevwriteByte(MPUdevAddr, MPU6050_RA_PWR_MGMT_1, pwr[0] | (1 << MPU6050_PWR1_CYCLE_BIT));
+    } else {
+        MPUsetIntEnabled(0);
+        I2CdevwriteByte(MPUdevAddr, MPU6050_RA_PWR_MGMT_1, MPU6050_CLOCK_INTERNAL | (1 << MPU6050_PWR1_SLEEP_BIT) | (1 << MPU6050_PWR1_TEMP_DIS_BIT));
+    }
+
+    if (state != powerState) powerTransitions++;
+    powerState = state;
+    // the blocking setup above counts towards the new state
+    powerAccount();
+}
+
+/** Get the current power state.
+ * @return MPU6050_POWER_ACTIVE, _CYCLE or _SLEEP
+ */
+uint8_t MPUpowerGetState() {
+    return powerState;
+}
+
+/** Run the state machine for one interrupt.
+ * Motion while cycling wakes the full pipeline; zero-motion while active
+ * (confirmed through MOT_DETECT_STATUS, ZMOT fires on both edges) falls back.
+ * @param status INT_STATUS as read after the INT assertion
+ * @return State after handling
+ */
+uint8_t MPUpowerHandleInterrupt(uint8_t status) {
+    uint8_t motStatus = 0;
+    if (powerState == MPU6050_POWER_ACTIVE && (status & (1 << MPU6050_INTERRUPT_ZMOT_BIT))) {
+        I2CdevreadByte(MPUdevAddr, MPU6050_RA_MOT_DETECT_STATUS, &motStatus, I2CDEV_DEFAULT_READ_TIMEOUT);
+    }
+    return MPUpowerHandleStatus(status, motStatus);
+}
+
+/** Run the state machine with both status registers already read,
+ * e.g. from an MPUEvent (see MPU6050_Event.h).
+ * @param intStatus INT_STATUS
+ * @param motStatus MOT_DETECT_STATUS from the same interrupt
+ * @return State after handling
+ */
+uint8_t MPUpowerHandleStatus(uint8_t intStatus, uint8_t motStatus) {
+    if (powerState == MPU6050_POWER_CYCLE && (intStatus & (1 << MPU6050_INTERRUPT_MOT_BIT))) {
+        MPUpowerEnter(MPU6050_POWER_ACTIVE);
+    } else if (powerState == MPU6050_POWER_ACTIVE && (intStatus & (1 << MPU6050_INTERRUPT_ZMOT_BIT))) {
+        if (motStatus & (1 << MPU6050_MOTION_MOT_ZRMOT_BIT)) MPUpowerEnter(MPU6050_POWER_CYCLE);
+    }
+    return powerState;
+}
+
+/** Read INT_STATUS and run the state machine.
+ * Only for setups where nothing else needs INT_STATUS, reading clears it.
+ * @return State after handling
+ */
+uint8_t MPUpowerService() {
+    return MPUpowerHandleInterrupt(MPUgetIntStatus());
+}
+
+/** Get the time spent per state and the estimated current draw.
+ * @param stats Output
+ */
+void MPUpowerGetStats(MPUPowerStats *stats) {
+    uint64_t weighted, total;
+    uint8_t i;
+
+    powerAccount();
+    for (i = 0; i < MPU6050_POWER_STATES; i++) stats -> timeMs[i] = (uint32_t)(powerTime[i] * 1000 / CH_FREQUENCY);
+    stats -> transitions = powerTransitions;
+
+    weighted = powerTime[MPU6050_POWER_ACTIVE] * MPU6050_POWER_ACTIVE_UA
+             + powerTime[MPU6050_POWER_CYCLE] * powerCycleCurrent[powerConfig.wakeFrequency & 3]
+             + powerTime[MPU6050_POWER_SLEEP] * MPU6050_POWER_SLEEP_UA;
+    total = powerTime[MPU6050_POWER_ACTIVE] + powerTime[MPU6050_POWER_CYCLE] + powerTime[MPU6050_POWER_SLEEP];
+    stats -> averageCurrent = total ? (uint32_t)(weighted / total) : 0;
+    // uA * ticks -> uAh
+    stats -> charge = weighted / (3600.0f * CH_FREQUENCY);
+}
+
+/** Clear the accounted times and transition count. */
+void MPUpowerResetStats() {
+    uint8_t i;
+    for (i = 0; i < MPU6050_POWER_STATES; i++) powerTime[i] = 0;
+    powerTransitions = 0;
+    powerSince = chTimeNow();
+}
@@ -0,0 +1,106 @@
+// I2Cdev library collection - MPU6050 I2C device class, power mode manager
+// Wake-on-motion with accel-only cycle mode and zero-motion fallback
+//
+// Changelog:
+//     2026-10-18 - initial release
+//     2026-10-18 - accept both status registers from the event engine
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, power mode code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#ifndef _MPU6050_POWER_H_
+#define _MPU6050_POWER_H_
+
+/* Two operating states, switched by the MPU's own motion interrupts:
+ *
+ *  - MPU6050_POWER_ACTIVE: gyro + accel on the gyro PLL, DMP running (if
+ *    configured). The zero-motion interrupt is armed; once the board has been
+ *    still for ZRMOT_DUR the manager falls back to cycle mode.
+ *  - MPU6050_POWER_CYCLE: gyros and temperature sensor in standby, internal
+ *    oscillator, accel woken at the LP_WAKE_CTRL rate. The high-pass filter is
+ *    held at the orientation it had when entering, so the motion interrupt
+ *    fires on any deviation from rest and the manager goes back to active.
+ *
+ * MPU6050_POWER_SLEEP is only entered on request (e.g. shipping mode) and
+ * needs MPUpowerEnter() to leave.
+ *
+ * Call MPUpowerHandleInterrupt() with INT_STATUS after every INT assertion
+ * (or MPUpowerService() to read it here). With the event engine, pass
+ * both status bytes of the MPUEvent to MPUpowerHandleStatus() instead. The DMP FIFO is reset on wake; the
+ * first MPU6050_POWER_GYRO_START_MS of gyro data are spent inside
+ * MPUpowerEnter() so they never reach the FIFO.
+ *
+ * Note LP_WAKE_CTRL on the MPU-6050 selects 1.25, 5, 20 or 40Hz, not the
+ * MPU-6000 rates the MPU6050_WAKE_FREQ_* names suggest.
+ *
+ * Time in each state is accounted with chTimeNow(); MPUpowerGetStats()
+ * weights it with the typical supply currents from the product specification
+ * to estimate the average current and the charge drawn.
+ */
+#define MPU6050_POWER_ACTIVE            0
+#define MPU6050_POWER_CYCLE             1
+#define MPU6050_POWER_SLEEP             2
+#define MPU6050_POWER_STATES            3
+
+// LP_WAKE_CTRL values
+#define MPU6050_POWER_WAKE_1P25         0
+#define MPU6050_POWER_WAKE_5            1
+#define MPU6050_POWER_WAKE_20           2
+#define MPU6050_POWER_WAKE_40           3
+
+#define MPU6050_POWER_GYRO_START_MS     30      // gyro start-up time
+#define MPU6050_POWER_HPF_SETTLE_MS     20      // DHPF tracking before it is held
+
+// typical supply current in uA
+#define MPU6050_POWER_ACTIVE_UA         3900    // gyro + accel + DMP
+#define MPU6050_POWER_SLEEP_UA          5
+#define MPU6050_POWER_CYCLE_UA          { 10, 20, 70, 140 }     // per LP_WAKE_CTRL
+
+typedef struct {
+        uint8_t wakeFrequency;          // MPU6050_POWER_WAKE_*
+        uint8_t motionThreshold;        // MOT_THR, 2mg per LSB
+        uint8_t motionDuration;         // MOT_DUR, in accel samples while cycling
+        uint8_t zeroMotionThreshold;    // ZRMOT_THR, 2mg per LSB
+        uint8_t zeroMotionDuration;     // ZRMOT_DUR, 64ms per LSB
+        uint8_t activeInterrupts;       // INT_ENABLE bits besides ZMOT while active, e.g. DMP_INT
+        bool_t dmp;                     // stop/restart the DMP with the state
+} MPUPowerConfig;
+
+typedef struct {
+        uint32_t timeMs[MPU6050_POWER_STATES];
+        uint32_t transitions;
+        uint32_t averageCurrent;        // uA over the accounted time
+        float charge;                   // uAh over the accounted time
+} MPUPowerStats;
+
+void MPUpowerInit(const MPUPowerConfig *config);
+void MPUpowerEnter(uint8_t state);
+uint8_t MPUpowerGetState(void);
+uint8_t MPUpowerHandleInterrupt(uint8_t status);
+uint8_t MPUpowerHandleStatus(uint8_t intStatus, uint8_t motStatus);
+uint8_t MPUpowerService(void);
+void MPUpowerGetStats(MPUPowerStats *stats);
+void MPUpowerResetStats(void);
+
+#endif /* _MPU6050_POWER_H_ */
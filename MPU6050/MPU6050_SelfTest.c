@@ -0,0 +1,140 @@
+// I2Cdev library collection - MPU6050 I2C device class, factory self-test
+// Runs the accel/gyro self-test and compares against the factory trim values
+//
+// Changelog:
+//     2026-10-18 - initial release
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, self-test code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#include <math.h>
+
+#include "ch.h"
+#include "hal.h"
+
+#include "MPU6050.h"
+#include "MPU6050_Calibration.h"
+#include "MPU6050_SelfTest.h"
+#include "i2cdev_chibi.h"
+
+// SMPLRT_DIV, CONFIG, GYRO_CONFIG, ACCEL_CONFIG are adjacent (0x19-0x1C)
+#define SELFTEST_CONFIG_LENGTH  4
+
+/** Read the factory trim values from SELF_TEST_X/Y/Z/A in one burst.
+ * @param gyroTrim Output, XG/YG/ZG_TEST (5 bit)
+ * @param accelTrim Output, XA/YA/ZA_TEST (5 bit)
+ */
+void MPUselfTestReadTrim(uint8_t *gyroTrim, uint8_t *accelTrim) {
+    uint8_t i;
+    I2CdevreadBytes(MPUdevAddr, MPU6050_RA_SELF_TEST_X, 4, MPUbuffer, I2CDEV_DEFAULT_READ_TIMEOUT);
+    for (i = 0; i < 3; i++) {
+        gyroTrim[i] = MPUbuffer[i] & 0x1F;
+        // upper three bits per axis register, lower two packed into SELF_TEST_A
+        accelTrim[i] = ((MPUbuffer[i] >> 3) & 0x1C) | ((MPUbuffer[3] >> (4 - 2 * i)) & 0x03);
+    }
+}
+
+/** Expected gyro self-test response from the factory trim.
+ * @param axis 0, 1 or 2 for X, Y, Z (Y responds negative)
+ * @param trim XG/YG/ZG_TEST value
+ * @return FT in LSB at +/-250 deg/s, 0 if no trim is stored
+ */
+float MPUselfTestGyroFactoryTrim(uint8_t axis, uint8_t trim) {
+    float ft;
+    if (trim == 0) return 0.0f;
+    ft = 25.0f * 131.0f * powf(1.046f, trim - 1.0f);
+    return (axis == 1) ? -ft : ft;
+}
+
+/** Expected accel self-test response from the factory trim.
+ * @param trim XA/YA/ZA_TEST value
+ * @return FT in LSB at +/-8g, 0 if no trim is stored
+ */
+float MPUselfTestAccelFactoryTrim(uint8_t trim) {
+    if (trim == 0) return 0.0f;
+    return 4096.0f * 0.34f * powf(0.92f / 0.34f, (trim - 1.0f) / 30.0f);
+}
+
+static float selfTestDeviation(int16_t response, float ft) {
+    // no trim stored: nothing to compare against, report a full failure
+    if (ft == 0.0f) return 100.0f;
+    return 100.0f * (response - ft) / ft;
+}
+
+/** Run the factory self-test on all six axes.
+ * @param result Output, per-axis responses and deviations from factory trim
+ * @return 0 if every axis is within MPU6050_SELFTEST_LIMIT, otherwise the
+ *         MPU6050_SELFTEST_* bits of the failed axes
+ */
+uint8_t MPUselfTest(MPUSelfTestResult *result) {
+    uint8_t saved[SELFTEST_CONFIG_LENGTH], config[SELFTEST_CONFIG_LENGTH], savedFIFOEn, failed = 0, i;
+    int16_t off[6], on[6], span[3];
+    bool_t savedFIFO;
+
+    MPUselfTestReadTrim(result -> gyroTrim, result -> accelTrim);
+
+    I2CdevreadBytes(MPUdevAddr, MPU6050_RA_SMPLRT_DIV, SELFTEST_CONFIG_LENGTH, saved, I2CDEV_DEFAULT_READ_TIMEOUT);
+    I2CdevreadByte(MPUdevAddr, MPU6050_RA_FIFO_EN, &savedFIFOEn, I2CDEV_DEFAULT_READ_TIMEOUT);
+    savedFIFO = MPUgetFIFOEnabled();
+
+    // 1kHz, 98Hz DLPF (keeping EXT_SYNC_SET), +/-250 deg/s, +/-8g, self-test off
+    config[0] = 0;
+    config[1] = (saved[1] & ~0x07) | MPU6050_DLPF_BW_98;
+    config[2] = MPU6050_GYRO_FS_250 << (MPU6050_GCONFIG_FS_SEL_BIT - MPU6050_GCONFIG_FS_SEL_LENGTH + 1);
+    config[3] = MPU6050_ACCEL_FS_8 << (MPU6050_ACONFIG_AFS_SEL_BIT - MPU6050_ACONFIG_AFS_SEL_LENGTH + 1);
+    I2CdevwriteBytes(MPUdevAddr, MPU6050_RA_SMPLRT_DIV, SELFTEST_CONFIG_LENGTH, config);
+    I2CdevwriteByte(MPUdevAddr, MPU6050_RA_FIFO_EN, (1 << MPU6050_XG_FIFO_EN_BIT) | (1 << MPU6050_YG_FIFO_EN_BIT) | (1 << MPU6050_ZG_FIFO_EN_BIT) | (1 << MPU6050_ACCEL_FIFO_EN_BIT));
+    MPUsetFIFOEnabled(TRUE);
+    chThdSleepMilliseconds(MPU6050_SELFTEST_SETTLE_MS);
+
+    if (MPUcalibrationReadMean(off, span, MPU6050_SELFTEST_SAMPLE_MS) == 0) {
+        failed = MPU6050_SELFTEST_NO_DATA;
+    } else {
+        // self-test on for all six axes, ranges unchanged
+        config[2] |= (1 << MPU6050_GCONFIG_XG_ST_BIT) | (1 << MPU6050_GCONFIG_YG_ST_BIT) | (1 << MPU6050_GCONFIG_ZG_ST_BIT);
+        config[3] |= (1 << MPU6050_ACONFIG_XA_ST_BIT) | (1 << MPU6050_ACONFIG_YA_ST_BIT) | (1 << MPU6050_ACONFIG_ZA_ST_BIT);
+        I2CdevwriteBytes(MPUdevAddr, MPU6050_RA_GYRO_CONFIG, 2, config + 2);
+        chThdSleepMilliseconds(MPU6050_SELFTEST_SETTLE_MS);
+        if (MPUcalibrationReadMean(on, span, MPU6050_SELFTEST_SAMPLE_MS) == 0) failed = MPU6050_SELFTEST_NO_DATA;
+    }
+
+    if (failed == 0) {
+        for (i = 0; i < 3; i++) {
+            result -> accelResponse[i] = on[i] - off[i];
+            result -> gyroResponse[i] = on[3 + i] - off[3 + i];
+            result -> accelDeviation[i] = selfTestDeviation(result -> accelResponse[i], MPUselfTestAccelFactoryTrim(result -> accelTrim[i]));
+            result -> gyroDeviation[i] = selfTestDeviation(result -> gyroResponse[i], MPUselfTestGyroFactoryTrim(i, result -> gyroTrim[i]));
+            if (fabsf(result -> gyroDeviation[i]) > MPU6050_SELFTEST_LIMIT) failed |= MPU6050_SELFTEST_GYRO_X << i;
+            if (fabsf(result -> accelDeviation[i]) > MPU6050_SELFTEST_LIMIT) failed |= MPU6050_SELFTEST_ACCEL_X << i;
+        }
+    }
+
+    // restore configuration, ST bits are cleared by the saved config bytes
+    MPUsetFIFOEnabled(FALSE);
+    I2CdevwriteByte(MPUdevAddr, MPU6050_RA_FIFO_EN, savedFIFOEn);
+    I2CdevwriteBytes(MPUdevAddr, MPU6050_RA_SMPLRT_DIV, SELFTEST_CONFIG_LENGTH, saved);
+    MPUresetFIFO();
+    MPUsetFIFOEnabled(savedFIFO);
+    return failed;
+}
@@ -0,0 +1,72 @@
+// I2Cdev library collection - MPU6050 I2C device class, factory self-test
+// Runs the accel/gyro self-test and compares against the factory trim values
+//
+// Changelog:
+//     2026-10-18 - initial release
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, self-test code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#ifndef _MPU6050_SELFTEST_H_
+#define _MPU6050_SELFTEST_H_
+
+/* Procedure from the MPU-6000/6050 register map, section 4.1-4.3:
+ * gyro at +/-250 deg/s, accel at +/-8g, average the output with self-test
+ * off and on, the difference is the self-test response. It is compared to
+ * the factory trim (FT) derived from SELF_TEST_X/Y/Z/A; a change from FT
+ * within +/-14% passes.
+ *
+ * All six axes are excited at once and both averages come from FIFO batches
+ * at 1kHz, so the whole test takes about 100ms of bus and wait time and can
+ * run at every boot. The board should be kept still, as with any self-test.
+ * Rate, DLPF, ranges and FIFO setup are restored afterwards.
+ */
+#define MPU6050_SELFTEST_SAMPLE_MS      25      // averaging window, each for off and on
+#define MPU6050_SELFTEST_SETTLE_MS      20      // after switching self-test on or off
+#define MPU6050_SELFTEST_LIMIT          14.0f   // max |change from factory trim| in percent
+
+// MPUselfTest() result bits, 0 means all axes passed
+#define MPU6050_SELFTEST_GYRO_X         0x01
+#define MPU6050_SELFTEST_GYRO_Y         0x02
+#define MPU6050_SELFTEST_GYRO_Z         0x04
+#define MPU6050_SELFTEST_ACCEL_X        0x08
+#define MPU6050_SELFTEST_ACCEL_Y        0x10
+#define MPU6050_SELFTEST_ACCEL_Z        0x20
+#define MPU6050_SELFTEST_NO_DATA        0x80    // FIFO stayed empty, nothing measured
+
+typedef struct {
+        float gyroDeviation[3];     // change from factory trim in percent
+        float accelDeviation[3];
+        int16_t gyroResponse[3];    // self-test response, LSB at +/-250 deg/s
+        int16_t accelResponse[3];   // self-test response, LSB at +/-8g
+        uint8_t gyroTrim[3];        // XG/YG/ZG_TEST, 0 = no factory trim stored
+        uint8_t accelTrim[3];       // XA/YA/ZA_TEST
+} MPUSelfTestResult;
+
+uint8_t MPUselfTest(MPUSelfTestResult *result);
+void MPUselfTestReadTrim(uint8_t *gyroTrim, uint8_t *accelTrim);
+float MPUselfTestGyroFactoryTrim(uint8_t axis, uint8_t trim);
+float MPUselfTestAccelFactoryTrim(uint8_t trim);
+
+#endif /* _MPU6050_SELFTEST_H_ */
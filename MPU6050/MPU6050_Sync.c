@@ -0,0 +1,353 @@
+// I2Cdev library collection - MPU6050 I2C device class, synchronized sampling
+// FSYNC/CLKOUT sync groups aligning samples from several MPU6050s
+//
+// Changelog:
+//     2026-10-18 - initial release
+//     2026-10-18 - per-sensor lock, bus errors reported per sample instead of decoding stale data
+//     2026-10-18 - MPUsyncRestart() for one sensor, the others stay locked
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, sync code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#include "ch.h"
+#include "hal.h"
+
+#include "MPU6050.h"
+#include "MPU6050_Sync.h"
+#include "i2cdev_chibi.h"
+
+#define SYNC_FIFO_SOURCES       ((1 << MPU6050_TEMP_FIFO_EN_BIT) | (1 << MPU6050_XG_FIFO_EN_BIT) | (1 << MPU6050_YG_FIFO_EN_BIT) | \
+                                 (1 << MPU6050_ZG_FIFO_EN_BIT) | (1 << MPU6050_ACCEL_FIFO_EN_BIT))
+#define SYNC_BATCH              (MPU6050_SCRATCH_BURST_LENGTH / MPU6050_SYNC_SAMPLE_SIZE)
+#define SYNC_FIFO_SIZE          1024
+
+// byte in the FIFO record carrying the FSYNC flag, by EXT_SYNC_SET
+static const uint8_t syncFlagOffset[8] = { 0, 7, 9, 11, 13, 1, 3, 5 };
+
+static void syncClear(MPUSyncGroup *group, uint8_t s, uint8_t state) {
+    group -> head[s] = 0;
+    group -> fill[s] = 0;
+    group -> state[s] = state;
+}
+
+static MPUSyncSample *syncHead(MPUSyncGroup *group, uint8_t s) {
+    return &group -> queue[s][group -> head[s]];
+}
+
+static void syncPop(MPUSyncGroup *group, uint8_t s) {
+    group -> head[s] = (group -> head[s] + 1) % MPU6050_SYNC_DEPTH;
+    group -> fill[s]--;
+}
+
+static void syncLose(MPUSyncGroup *group, uint8_t s) {
+    if (group -> state[s] != MPU6050_SYNC_LOST) group -> stats.busErrors++;
+    syncClear(group, s, MPU6050_SYNC_LOST);
+}
+
+// drop the FIFO contents, the sensor rejoins at the next strobe
+static void syncRestart(MPUSyncGroup *group, uint8_t s) {
+    if (I2CdevwriteBit(group -> address[s], MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_FIFO_RESET_BIT, TRUE)) syncClear(group, s, MPU6050_SYNC_WAIT);
+    else syncLose(group, s);
+}
+
+/* Move whole FIFO records of sensor s into its queue. The count is read
+ * even with a full queue, so an overflow is never missed: 1024 is not a
+ * multiple of the record size, the records after one are misaligned. */
+static void syncDrain(MPUSyncGroup *group, uint8_t s, uint8_t *moved) {
+    MPU_SCRATCH(buffer, MPU6050_SCRATCH_BURST, SYNC_BATCH * MPU6050_SYNC_SAMPLE_SIZE);
+    uint8_t address = group -> address[s];
+    uint16_t count;
+    uint8_t n, i, tail;
+
+    if (!I2CdevreadBytes(address, MPU6050_RA_FIFO_COUNTH, 2, buffer, I2CDEV_DEFAULT_READ_TIMEOUT)) {
+        syncLose(group, s);
+        return;
+    }
+    if (group -> state[s] == MPU6050_SYNC_LOST) {
+        syncRestart(group, s);
+        return;
+    }
+    count = ((uint16_t)buffer[0] << 8) | buffer[1];
+    if (count >= SYNC_FIFO_SIZE) {
+        group -> stats.overflows++;
+        syncRestart(group, s);
+        return;
+    }
+    count /= MPU6050_SYNC_SAMPLE_SIZE;
+    while (count > 0 && group -> fill[s] < MPU6050_SYNC_DEPTH) {
+        n = MPU6050_SYNC_DEPTH - group -> fill[s];
+        if (n > count) n = count;
+        if (n > SYNC_BATCH) n = SYNC_BATCH;
+        if (!I2CdevreadBytes(address, MPU6050_RA_FIFO_R_W, n * MPU6050_SYNC_SAMPLE_SIZE, buffer, I2CDEV_DEFAULT_READ_TIMEOUT)) {
+            syncLose(group, s);
+            return;
+        }
+        for (i = 0; i < n; i++) {
+            tail = (group -> head[s] + group -> fill[s]) % MPU6050_SYNC_DEPTH;
+            MPUsyncDecode(buffer + i * MPU6050_SYNC_SAMPLE_SIZE, group -> syncSet, &group -> queue[s][tail]);
+            group -> fill[s]++;
+        }
+        *moved += n;
+        count -= n;
+    }
+}
+
+/** Configure clocks, frame sync, rate and FIFO of every sensor in a group.
+ * The sensors have to be awake and set to the same ranges. Sampling starts
+ * with MPUsyncStart().
+ * @param group Output, group state
+ * @param addresses I2C addresses, copied
+ * @param count Number of sensors, at most MPU6050_SYNC_MAX_SENSORS
+ * @param config Clock and sync setup, shared by all sensors
+ * @return FALSE if count is out of range or a sensor does not answer
+ */
+bool_t MPUsyncInit(MPUSyncGroup *group, const uint8_t *addresses, uint8_t count, const MPUSyncConfig *config) {
+    uint8_t saved = MPUdevAddr;
+    bool_t ok = TRUE;
+    uint8_t s;
+
+    if (count == 0 || count > MPU6050_SYNC_MAX_SENSORS) return FALSE;
+    group -> count = count;
+    group -> syncSet = config -> syncSet & 0x07;
+    for (s = 0; s < count; s++) {
+        group -> address[s] = addresses[s];
+        MPUdevAddr = addresses[s];
+        if (!MPUtestConnection()) {
+            ok = FALSE;
+            break;
+        }
+        MPUsetClockSource(s == config -> master ? MPU6050_CLOCK_PLL_XGYRO : config -> followerClock);
+        MPUsetClockOutputEnabled(s == config -> master);
+        MPUsetDLPFMode(config -> dlpf);
+        MPUsetRate(config -> rate);
+        MPUsetExternalFrameSync(group -> syncSet);
+        MPUsetFIFOEnabled(FALSE);
+        I2CdevwriteByte(MPUdevAddr, MPU6050_RA_FIFO_EN, SYNC_FIFO_SOURCES);
+    }
+    MPUdevAddr = saved;
+    for (s = 0; s < count; s++) syncClear(group, s, MPU6050_SYNC_WAIT);
+    group -> index = 0;
+    group -> stats.frames = 0;
+    group -> stats.dropped = 0;
+    group -> stats.slips = 0;
+    group -> stats.missed = 0;
+    group -> stats.overflows = 0;
+    group -> stats.busErrors = 0;
+    return ok;
+}
+
+/** Reset and enable the FIFO of every sensor. Each sensor locks at the
+ * next strobe seen by all sensors that answer.
+ * @param group Group from MPUsyncInit()
+ */
+void MPUsyncStart(MPUSyncGroup *group) {
+    uint8_t saved = MPUdevAddr;
+    uint8_t s;
+
+    for (s = 0; s < group -> count; s++) {
+        MPUdevAddr = group -> address[s];
+        MPUsetFIFOEnabled(FALSE);
+        MPUresetFIFO();
+        MPUsetFIFOEnabled(TRUE);
+        syncClear(group, s, MPU6050_SYNC_WAIT);
+    }
+    MPUdevAddr = saved;
+    group -> index = 0;
+}
+
+/** Reset the FIFO of one sensor, e.g. after MPUselfTest() on it. The other
+ * sensors stay locked and keep producing frames, this one rejoins at the
+ * next strobe they see. FIFO enable and sources are left as they are.
+ * @param group Group from MPUsyncInit()
+ * @param s Sensor index
+ * @return FALSE if the sensor does not answer, it is then reported lost
+ */
+bool_t MPUsyncRestart(MPUSyncGroup *group, uint8_t s) {
+    if (s >= group -> count) return FALSE;
+    syncRestart(group, s);
+    return group -> state[s] == MPU6050_SYNC_WAIT;
+}
+
+/* With no sensor locked, lock every waiting sensor at a strobe they all
+ * saw. Returns TRUE if samples were dropped or sensors locked, FALSE if
+ * more data is needed. */
+static bool_t syncLockAll(MPUSyncGroup *group) {
+    uint8_t waiting = 0, ready = 0, s;
+    bool_t dropped = FALSE;
+
+    for (s = 0; s < group -> count; s++) {
+        if (group -> state[s] != MPU6050_SYNC_WAIT) continue;
+        waiting++;
+        if (group -> fill[s] > 0) ready++;
+    }
+    if (waiting == 0) return FALSE;
+    if (ready < waiting) {
+        // a sensor holding a mark the others never saw gives it up once its queue is full
+        for (s = 0; s < group -> count; s++) {
+            if (group -> state[s] == MPU6050_SYNC_WAIT && group -> fill[s] == MPU6050_SYNC_DEPTH) {
+                syncPop(group, s);
+                group -> stats.dropped++;
+                dropped = TRUE;
+            }
+        }
+        return dropped;
+    }
+    for (s = 0; s < group -> count; s++)
+        if (group -> state[s] == MPU6050_SYNC_WAIT) group -> state[s] = MPU6050_SYNC_LOCKED;
+    return TRUE;
+}
+
+// emit the frames the queues hold, realigning on strobes
+static uint8_t syncAssemble(MPUSyncGroup *group, MPUSyncFrame *frames, uint8_t max) {
+    MPUSyncSample *sample;
+    uint8_t n = 0;
+    uint8_t s, j, locked, marked;
+    bool_t dropped;
+
+    while (n < max) {
+        // waiting sensors only keep marked samples, a join starts at a strobe
+        for (s = 0; s < group -> count; s++) {
+            while (group -> state[s] == MPU6050_SYNC_WAIT && group -> fill[s] > 0 && !syncHead(group, s) -> fsync) {
+                syncPop(group, s);
+                group -> stats.dropped++;
+            }
+        }
+
+        locked = 0;
+        marked = 0;
+        for (s = 0; s < group -> count; s++) {
+            if (group -> state[s] != MPU6050_SYNC_LOCKED) continue;
+            if (group -> fill[s] == 0) return n;
+            locked++;
+            if (syncHead(group, s) -> fsync) marked++;
+        }
+        if (locked == 0) {
+            if (!syncLockAll(group)) return n;
+            group -> index = 0;
+            continue;
+        }
+
+        dropped = FALSE;
+        if (marked > 0 && marked < locked) {
+            // a sensor behind the others has the mark a few samples later
+            for (s = 0; s < group -> count; s++) {
+                if (group -> state[s] != MPU6050_SYNC_LOCKED || syncHead(group, s) -> fsync) continue;
+                for (j = 1; j <= MPU6050_SYNC_MAX_SLIP && j < group -> fill[s]; j++)
+                    if (group -> queue[s][(group -> head[s] + j) % MPU6050_SYNC_DEPTH].fsync) break;
+                if (j > MPU6050_SYNC_MAX_SLIP) continue;
+                if (j == group -> fill[s]) return n;
+                while (j--) {
+                    syncPop(group, s);
+                    group -> stats.dropped++;
+                }
+                dropped = TRUE;
+            }
+            if (dropped) {
+                group -> stats.slips++;
+                continue;
+            }
+            group -> stats.missed++;
+        }
+
+        group -> index = marked ? 0 : group -> index + 1;
+        for (s = 0; s < group -> count; s++) {
+            sample = &frames[n].sample[s];
+            if (group -> state[s] == MPU6050_SYNC_WAIT && group -> fill[s] > 0) {
+                if (marked) {
+                    group -> state[s] = MPU6050_SYNC_LOCKED;
+                } else if (group -> fill[s] == MPU6050_SYNC_DEPTH) {
+                    // its mark is older than the group's, start over
+                    syncPop(group, s);
+                    group -> stats.dropped++;
+                }
+            }
+            if (group -> state[s] == MPU6050_SYNC_LOCKED) {
+                *sample = *syncHead(group, s);
+                syncPop(group, s);
+            } else {
+                for (j = 0; j < 3; j++) {
+                    sample -> accel[j] = 0;
+                    sample -> gyro[j] = 0;
+                }
+                sample -> temp = 0;
+                sample -> fsync = FALSE;
+                sample -> status = (group -> state[s] == MPU6050_SYNC_LOST) ? MPU6050_SYNC_BUS_ERROR : MPU6050_SYNC_NO_DATA;
+            }
+        }
+        frames[n].index = group -> index;
+        group -> stats.frames++;
+        n++;
+    }
+    return n;
+}
+
+/** Read the FIFOs and assemble aligned frames.
+ * Call often enough that no FIFO fills (1024 bytes, 73 samples), an
+ * overflowing sensor is reset and relocks. Before lock every sensor
+ * discards samples up to its first marked one. After lock, a sensor whose
+ * mark comes up to MPU6050_SYNC_MAX_SLIP samples after the others drops
+ * the samples in between; a sensor without a mark in that window missed
+ * the strobe and the frame is emitted as it is. Sensors that are lost or
+ * waiting to rejoin do not hold the others back, their slots carry a
+ * status instead of data.
+ * @param group Group from MPUsyncStart()
+ * @param frames Output, aligned frames in sample order
+ * @param max Size of frames
+ * @return Number of frames written
+ */
+uint8_t MPUsyncPoll(MPUSyncGroup *group, MPUSyncFrame *frames, uint8_t max) {
+    uint8_t n = 0;
+    uint8_t s, moved;
+
+    do {
+        moved = 0;
+        for (s = 0; s < group -> count; s++) syncDrain(group, s, &moved);
+        n += syncAssemble(group, frames + n, max - n);
+    } while (moved > 0 && n < max);
+    return n;
+}
+
+/** Decode one FIFO record and take the FSYNC flag out of it.
+ * @param raw MPU6050_SYNC_SAMPLE_SIZE bytes: accel, temperature, gyro
+ * @param syncSet EXT_SYNC_SET the record was sampled with
+ * @param sample Output
+ */
+void MPUsyncDecode(const uint8_t *raw, uint8_t syncSet, MPUSyncSample *sample) {
+    uint8_t offset = syncFlagOffset[syncSet & 0x07];
+    int16_t w[MPU6050_SYNC_SAMPLE_SIZE / 2];
+    uint8_t i;
+
+    for (i = 0; i < MPU6050_SYNC_SAMPLE_SIZE / 2; i++) w[i] = (((int16_t)raw[2 * i]) << 8) | raw[2 * i + 1];
+    sample -> fsync = FALSE;
+    sample -> status = MPU6050_SYNC_OK;
+    if (offset) {
+        sample -> fsync = w[offset / 2] & 0x01;
+        w[offset / 2] &= ~0x01;
+    }
+    for (i = 0; i < 3; i++) {
+        sample -> accel[i] = w[i];
+        sample -> gyro[i] = w[4 + i];
+    }
+    sample -> temp = w[3];
+}
@@ -0,0 +1,135 @@
+// I2Cdev library collection - MPU6050 I2C device class, synchronized sampling
+// FSYNC/CLKOUT sync groups aligning samples from several MPU6050s
+//
+// Changelog:
+//     2026-10-18 - initial release
+//     2026-10-18 - per-sensor lock, bus errors reported per sample instead of decoding stale data
+//     2026-10-18 - MPUsyncRestart() for one sensor, the others stay locked
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, sync code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#ifndef _MPU6050_SYNC_H_
+#define _MPU6050_SYNC_H_
+
+#include "MPU6050.h"
+
+/* A sync group samples several MPU6050s on one bus (0x68/0x69, or more
+ * behind a mux) into frames holding one sample per sensor from the same
+ * sample clock tick.
+ *
+ * Wiring: all sensors share an FSYNC strobe. The strobe has to be shorter
+ * than one sample period, the latched edge then marks exactly one sample
+ * per sensor: EXT_SYNC_SET puts the flag into bit 0 of the chosen low
+ * byte. The flag replaces that bit, so it is cleared again by
+ * MPUsyncDecode() (the chosen axis loses its LSB). A single strobe after
+ * MPUsyncStart() aligns the group, a periodic one (e.g. 1Hz) also
+ * catches sensors that slip later on.
+ *
+ * Each sensor locks on its own. A sensor that stops answering is marked
+ * lost and its slot in the frames carries MPU6050_SYNC_BUS_ERROR instead
+ * of data, the others keep going. Once it answers again, or after a FIFO
+ * overflow, its FIFO is reset and it rejoins at the next strobe the
+ * locked sensors see; until then its slot is MPU6050_SYNC_NO_DATA.
+ * MPUsyncRestart() does the same on request, e.g. after a self-test.
+ *
+ * Clocks: sensors running from their own gyro PLL drift apart by up to
+ * +/-1%, which the strobe has to absorb as slips. The master can drive
+ * CLKOUT and the followers lock to it through CLKIN; the register map does
+ * not specify the CLKOUT frequency, so check which of the EXT32K/EXT19M
+ * sources it matches on the board. A shared 32.768kHz reference on every
+ * CLKIN (followerClock for all, master set to MPU6050_SYNC_NO_MASTER) is
+ * the robust setup.
+ *
+ * The FIFO records accel, temperature and gyro (14 bytes in register
+ * order), so the group does not work together with the DMP: its packets
+ * do not carry the raw low bytes the flag is written into. Sensor ranges
+ * have to be the same on every sensor, MPUgetAccelScale() and
+ * MPUgetGyroScale() keep one setting for the driver.
+ */
+#define MPU6050_SYNC_MAX_SENSORS        4
+#define MPU6050_SYNC_DEPTH              8       // decoded samples queued per sensor
+#define MPU6050_SYNC_SAMPLE_SIZE        14      // FIFO record, ACCEL_XOUT_H..GYRO_ZOUT_L
+#define MPU6050_SYNC_MAX_SLIP           2       // samples a sensor may lag at a strobe before it counts as missed
+#define MPU6050_SYNC_NO_MASTER          0xFF
+
+// MPUSyncSample status
+#define MPU6050_SYNC_OK                 0
+#define MPU6050_SYNC_NO_DATA            1       // sensor waits for a strobe to (re)join, fields are 0
+#define MPU6050_SYNC_BUS_ERROR          2       // sensor does not answer, fields are 0
+
+// MPUSyncGroup sensor states
+#define MPU6050_SYNC_WAIT               0       // dropping samples up to the next strobe
+#define MPU6050_SYNC_LOCKED             1
+#define MPU6050_SYNC_LOST               2       // bus error, retried at every poll
+
+typedef struct {
+        uint8_t master;             // sensor index driving CLKOUT, or MPU6050_SYNC_NO_MASTER
+        uint8_t followerClock;      // CLK_SEL of the others, MPU6050_CLOCK_PLL_EXT32K/_EXT19M or _XGYRO
+        uint8_t syncSet;            // MPU6050_EXT_SYNC_TEMP_OUT_L .. _ACCEL_ZOUT_L
+        uint8_t rate;               // SMPLRT_DIV
+        uint8_t dlpf;               // MPU6050_DLPF_BW_*
+} MPUSyncConfig;
+
+typedef struct {
+        int16_t accel[3];
+        int16_t temp;
+        int16_t gyro[3];
+        bool_t fsync;               // FSYNC edge latched during this sample
+        uint8_t status;             // MPU6050_SYNC_OK, _NO_DATA or _BUS_ERROR
+} MPUSyncSample;
+
+typedef struct {
+        MPUSyncSample sample[MPU6050_SYNC_MAX_SENSORS];
+        uint32_t index;             // samples since the last strobe, 0 = the strobe itself
+} MPUSyncFrame;
+
+typedef struct {
+        uint32_t frames;
+        uint32_t dropped;           // samples discarded while locking and realigning
+        uint32_t slips;             // realignments after lock
+        uint32_t missed;            // strobes only some sensors saw, frame emitted unaligned
+        uint32_t overflows;         // FIFO overflows, the sensor relocks at the next strobe
+        uint32_t busErrors;         // sensors lost, the sensor relocks once it answers
+} MPUSyncStats;
+
+typedef struct {
+        uint8_t address[MPU6050_SYNC_MAX_SENSORS];
+        uint8_t count;
+        uint8_t syncSet;
+        uint8_t state[MPU6050_SYNC_MAX_SENSORS];        // MPU6050_SYNC_WAIT, _LOCKED or _LOST
+        uint32_t index;
+        MPUSyncSample queue[MPU6050_SYNC_MAX_SENSORS][MPU6050_SYNC_DEPTH];
+        uint8_t head[MPU6050_SYNC_MAX_SENSORS];
+        uint8_t fill[MPU6050_SYNC_MAX_SENSORS];
+        MPUSyncStats stats;
+} MPUSyncGroup;
+
+bool_t MPUsyncInit(MPUSyncGroup *group, const uint8_t *addresses, uint8_t count, const MPUSyncConfig *config);
+void MPUsyncStart(MPUSyncGroup *group);
+bool_t MPUsyncRestart(MPUSyncGroup *group, uint8_t s);
+uint8_t MPUsyncPoll(MPUSyncGroup *group, MPUSyncFrame *frames, uint8_t max);
+void MPUsyncDecode(const uint8_t *raw, uint8_t syncSet, MPUSyncSample *sample);
+
+#endif /* _MPU6050_SYNC_H_ */
@@ -0,0 +1,269 @@
+// I2Cdev library collection - MPU6050 I2C device class, thermal bias compensation
+// Per-axis polynomial gyro bias model over die temperature
+//
+// Changelog:
+//     2026-10-18 - initial release
+//     2026-10-18 - bin cap halved so the sums hold at FS_2000, no shifts of negative samples
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, thermal compensation code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#include <math.h>
+
+#include "ch.h"
+#include "hal.h"
+
+#include "MPU6050.h"
+#include "MPU6050_Thermal.h"
+#include "i2cdev_chibi.h"
+
+#define THERMAL_GYRO_STEP       4       // XG_OFFS_USR LSB in LSB at +/-250 deg/s
+#define THERMAL_HYSTERESIS      0.75f   // register LSB, keeps the offset from toggling
+
+static int16_t thermalRound(float value) {
+    return (int16_t)((value >= 0.0f) ? value + 0.5f : value - 0.5f);
+}
+
+/** Start a new fit.
+ * Reads the gyro user offsets, they must stay unchanged during the sweep.
+ * @param fit Fit accumulator
+ */
+void MPUthermalFitReset(MPUThermalFit *fit) {
+    uint8_t b, i;
+    for (b = 0; b < MPU6050_THERMAL_BINS; b++) {
+        for (i = 0; i < 3; i++) fit -> gyroSum[b][i] = 0;
+        fit -> tempSum[b] = 0;
+        fit -> count[b] = 0;
+    }
+    fit -> baseOffset[0] = MPUgetXGyroOffsetUser();
+    fit -> baseOffset[1] = MPUgetYGyroOffsetUser();
+    fit -> baseOffset[2] = MPUgetZGyroOffsetUser();
+    fit -> tempRef = 0;
+    fit -> started = FALSE;
+}
+
+/** Add one at-rest sample to the fit.
+ * @param fit Fit accumulator
+ * @param temp Raw TEMP_OUT value
+ * @param gyro Raw gyro X/Y/Z at the current full-scale range
+ */
+void MPUthermalFitAdd(MPUThermalFit *fit, int16_t temp, const int16_t *gyro) {
+    int16_t dT, bin;
+    uint8_t i;
+    if (!fit -> started) {
+        fit -> tempRef = temp;
+        fit -> started = TRUE;
+    }
+    dT = temp - fit -> tempRef;
+    // floor division into 1 degree bins, centered on the first sample
+    bin = ((dT >= 0) ? dT / 340 : (dT - 339) / 340) + MPU6050_THERMAL_BINS / 2;
+    if (bin < 0 || bin >= MPU6050_THERMAL_BINS || fit -> count[bin] >= MPU6050_THERMAL_BIN_SAMPLES) return;
+    for (i = 0; i < 3; i++) fit -> gyroSum[bin][i] += (int32_t)gyro[i] * (1 << MPUgyroRange);
+    fit -> tempSum[bin] += dT;
+    fit -> count[bin]++;
+}
+
+/** Read one sample (single 14-byte burst) and add it to the fit.
+ * @param fit Fit accumulator
+ */
+void MPUthermalFitSample(MPUThermalFit *fit) {
+    int16_t accel[3], gyro[3], temp;
+    MPUgetMotion6Temp(&accel[0], &accel[1], &accel[2], &gyro[0], &gyro[1], &gyro[2], &temp);
+    MPUthermalFitAdd(fit, temp, gyro);
+}
+
+/** Least squares fit of the per-axis bias polynomials.
+ * Every non-empty bin is one point (mean temperature, mean rate), solved
+ * through the normal equations with partial pivoting.
+ * @param fit Fit accumulator
+ * @param model Output, initialized for runtime use on success
+ * @return MPU6050_THERMAL_OK or one of the MPU6050_THERMAL_* error codes
+ */
+uint8_t MPUthermalFitSolve(const MPUThermalFit *fit, MPUThermalModel *model) {
+    float a[MPU6050_THERMAL_TERMS][MPU6050_THERMAL_TERMS + 3];
+    float x, y, p, f, tmp;
+    uint8_t b, i, j, k, pivot, bins = 0, lo = MPU6050_THERMAL_BINS, hi = 0;
+
+    for (i = 0; i < MPU6050_THERMAL_TERMS; i++) {
+        for (j = 0; j < MPU6050_THERMAL_TERMS + 3; j++) a[i][j] = 0.0f;
+    }
+
+    // augmented normal equations, columns TERMS..TERMS+2 hold X/Y/Z
+    for (b = 0; b < MPU6050_THERMAL_BINS; b++) {
+        if (fit -> count[b] == 0) continue;
+        if (b < lo) lo = b;
+        if (b > hi) hi = b;
+        bins++;
+        x = (float)fit -> tempSum[b] / fit -> count[b] / MPU6050_THERMAL_LSB_PER_C;
+        for (i = 0, p = 1.0f; i < MPU6050_THERMAL_TERMS; i++, p *= x) {
+            for (j = 0, f = p; j < MPU6050_THERMAL_TERMS; j++, f *= x) a[i][j] += f;
+            for (k = 0; k < 3; k++) {
+                y = (float)fit -> gyroSum[b][k] / fit -> count[b];
+                a[i][MPU6050_THERMAL_TERMS + k] += p * y;
+            }
+        }
+    }
+    if (bins < MPU6050_THERMAL_TERMS || hi - lo < MPU6050_THERMAL_MIN_SPAN_C * MPU6050_THERMAL_ORDER) return MPU6050_THERMAL_NARROW_SPAN;
+
+    for (i = 0; i < MPU6050_THERMAL_TERMS; i++) {
+        pivot = i;
+        for (j = i + 1; j < MPU6050_THERMAL_TERMS; j++) {
+            if (fabsf(a[j][i]) > fabsf(a[pivot][i])) pivot = j;
+        }
+        if (fabsf(a[pivot][i]) < 1e-6f) return MPU6050_THERMAL_SINGULAR;
+        for (j = 0; j < MPU6050_THERMAL_TERMS + 3; j++) {
+            tmp = a[i][j];
+            a[i][j] = a[pivot][j];
+            a[pivot][j] = tmp;
+        }
+        for (j = 0; j < MPU6050_THERMAL_TERMS; j++) {
+            if (j == i) continue;
+            f = a[j][i] / a[i][i];
+            for (k = i; k < MPU6050_THERMAL_TERMS + 3; k++) a[j][k] -= f * a[i][k];
+        }
+    }
+
+    MPUthermalInit(model, fit -> tempRef, fit -> baseOffset);
+    for (k = 0; k < 3; k++) {
+        for (i = 0; i < MPU6050_THERMAL_TERMS; i++) model -> coeff[k][i] = a[i][MPU6050_THERMAL_TERMS + k] / a[i][i];
+    }
+    return MPU6050_THERMAL_OK;
+}
+
+/** Initialize a model with zero bias.
+ * @param model Model
+ * @param tempRef TEMP_OUT at which dT = 0
+ * @param baseOffset XG/YG/ZG_OFFS_USR values the model is relative to
+ */
+void MPUthermalInit(MPUThermalModel *model, int16_t tempRef, const int16_t *baseOffset) {
+    uint8_t i, k;
+    for (k = 0; k < 3; k++) {
+        for (i = 0; i < MPU6050_THERMAL_TERMS; i++) model -> coeff[k][i] = 0.0f;
+        model -> baseOffset[k] = model -> programmed[k] = baseOffset[k];
+        model -> cachedBias[k] = 0;
+    }
+    model -> tempRef = tempRef;
+    model -> cachedTemp = 0;
+    model -> cachedRange = 0;
+    model -> cacheValid = FALSE;
+    model -> programmedValid = FALSE;
+}
+
+/** Evaluate the bias polynomial.
+ * @param model Model
+ * @param axis 0, 1 or 2 for X, Y, Z
+ * @param temp Raw TEMP_OUT value
+ * @return Bias in LSB at +/-250 deg/s, relative to the model's base offsets
+ */
+float MPUthermalBias(const MPUThermalModel *model, uint8_t axis, int16_t temp) {
+    float x = (temp - model -> tempRef) / MPU6050_THERMAL_LSB_PER_C, bias = 0.0f;
+    int8_t i;
+    for (i = MPU6050_THERMAL_TERMS - 1; i >= 0; i--) bias = bias * x + model -> coeff[axis][i];
+    return bias;
+}
+
+/** Subtract the temperature dependent bias from one gyro sample.
+ * The bias is cached and only re-evaluated when the temperature or the
+ * full-scale range changes, so the common case is three subtractions.
+ * @param model Model
+ * @param temp Raw TEMP_OUT from the same burst as the gyro sample
+ * @param gyro Raw gyro X/Y/Z at the current full-scale range, corrected in place
+ */
+void MPUthermalCompensate(MPUThermalModel *model, int16_t temp, int16_t *gyro) {
+    int16_t key = temp >> MPU6050_THERMAL_CACHE_SHIFT;
+    uint8_t i;
+    if (!model -> cacheValid || key != model -> cachedTemp || MPUgyroRange != model -> cachedRange) {
+        // evaluate at the center of the cache bucket
+        temp = (int16_t)((key << MPU6050_THERMAL_CACHE_SHIFT) + (1 << (MPU6050_THERMAL_CACHE_SHIFT - 1)));
+        for (i = 0; i < 3; i++) model -> cachedBias[i] = thermalRound(MPUthermalBias(model, i, temp) / (1 << MPUgyroRange));
+        model -> cachedTemp = key;
+        model -> cachedRange = MPUgyroRange;
+        model -> cacheValid = TRUE;
+    }
+    for (i = 0; i < 3; i++) gyro[i] -= model -> cachedBias[i];
+}
+
+/** Read accel, gyro and temperature in one burst and compensate the gyro.
+ * @param model Model
+ * @param accel Output, raw accel X/Y/Z
+ * @param gyro Output, compensated gyro X/Y/Z
+ */
+void MPUthermalGetMotion6(MPUThermalModel *model, int16_t *accel, int16_t *gyro) {
+    int16_t temp;
+    MPUgetMotion6Temp(&accel[0], &accel[1], &accel[2], &gyro[0], &gyro[1], &gyro[2], &temp);
+    MPUthermalCompensate(model, temp, gyro);
+}
+
+/** Track the bias with the XG_OFFS_USR registers instead of in software.
+ * Meant to be called at a low rate; the three registers are rewritten with one
+ * burst, and only when an axis moved by more than a register LSB.
+ * @param model Model
+ * @param temp Raw TEMP_OUT value
+ * @return TRUE if the offset registers were written
+ */
+bool_t MPUthermalUpdateOffsets(MPUThermalModel *model, int16_t temp) {
+    uint8_t data[6], i;
+    bool_t changed = !model -> programmedValid;
+    float target;
+    for (i = 0; i < 3; i++) {
+        target = model -> baseOffset[i] - MPUthermalBias(model, i, temp) / THERMAL_GYRO_STEP;
+        if (!model -> programmedValid || fabsf(target - model -> programmed[i]) > THERMAL_HYSTERESIS) {
+            model -> programmed[i] = thermalRound(target);
+            changed = TRUE;
+        }
+    }
+    if (!changed) return FALSE;
+    for (i = 0; i < 3; i++) {
+        data[2 * i] = (uint8_t)((uint16_t)model -> programmed[i] >> 8);
+        data[2 * i + 1] = (uint8_t)(model -> programmed[i] & 0xFF);
+    }
+    I2CdevwriteBytes(MPUdevAddr, MPU6050_RA_XG_OFFS_USRH, 6, data);
+    model -> programmedValid = TRUE;
+    return TRUE;
+}
+
+/** Store the model in a calibration blob.
+ * Blob format version 1 holds the linear term only: the constant term is
+ * folded into the gyro offsets, higher terms are dropped.
+ * @param model Model
+ * @param blob Calibration blob, gyro offsets, temperature coefficients and tempRef are written
+ */
+void MPUthermalToBlob(const MPUThermalModel *model, CalibrationBlob *blob) {
+    uint8_t i;
+    for (i = 0; i < 3; i++) {
+        blob -> gyroOffset[i] = model -> baseOffset[i] - thermalRound(model -> coeff[i][0] / THERMAL_GYRO_STEP);
+        blob -> gyroTempCoeff[i] = thermalRound(model -> coeff[i][1] * 256.0f);
+    }
+    blob -> tempRef = model -> tempRef;
+}
+
+/** Load a linear model from a calibration blob.
+ * @param model Output
+ * @param blob Calibration blob
+ */
+void MPUthermalFromBlob(MPUThermalModel *model, const CalibrationBlob *blob) {
+    uint8_t i;
+    MPUthermalInit(model, blob -> tempRef, blob -> gyroOffset);
+    for (i = 0; i < 3; i++) model -> coeff[i][1] = blob -> gyroTempCoeff[i] / 256.0f;
+}
@@ -0,0 +1,104 @@
+// I2Cdev library collection - MPU6050 I2C device class, thermal bias compensation
+// Per-axis polynomial gyro bias model over die temperature
+//
+// Changelog:
+//     2026-10-18 - initial release
+//     2026-10-18 - bin cap halved so the sums hold at FS_2000
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, thermal compensation code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#ifndef _MPU6050_THERMAL_H_
+#define _MPU6050_THERMAL_H_
+
+#include "helper_calblob.h"
+
+/* Gyro bias drifts with die temperature. The model below is a polynomial per
+ * axis in dT = (TEMP_OUT - tempRef) / 340 (degrees C), giving the bias in LSB
+ * at +/-250 deg/s on top of the XG_OFFS_USR values in effect during the fit.
+ *
+ * Fitting: keep the board still, call MPUthermalFitSample() while the die
+ * warms up or cools down (a power-on warm-up of a few degrees is enough for
+ * the linear term), then MPUthermalFitSolve(). Samples are binned per degree
+ * so a sweep that lingers at one temperature does not dominate the fit.
+ *
+ * Runtime, pick one:
+ *  - MPUthermalCompensate() subtracts the bias from every sample. Temperature
+ *    comes from the same 14-byte burst (MPUgetMotion6Temp), and the bias is
+ *    only re-evaluated when TEMP_OUT moves by more than ~0.05 degrees C.
+ *  - MPUthermalUpdateOffsets() at a low rate (~1Hz) moves XG_OFFS_USR instead,
+ *    so the DMP and the FIFO see compensated data too. Writes happen only
+ *    when the offset changes by a full register LSB.
+ */
+#ifndef MPU6050_THERMAL_ORDER
+#define MPU6050_THERMAL_ORDER           2       // 1 = linear, 2 = quadratic
+#endif
+#define MPU6050_THERMAL_TERMS           (MPU6050_THERMAL_ORDER + 1)
+#define MPU6050_THERMAL_BINS            64      // 1 degree C bins, +/-32 degrees around the first sample
+#define MPU6050_THERMAL_BIN_SAMPLES     8192    // per bin: 32767 * 8 (FS_2000 in 250 deg/s LSB) * 8192 < 2^31
+#define MPU6050_THERMAL_CACHE_SHIFT     4       // TEMP_OUT >> 4 (~0.05 degrees C) keys the bias cache
+#define MPU6050_THERMAL_LSB_PER_C       340.0f  // TEMP_OUT sensitivity
+#define MPU6050_THERMAL_MIN_SPAN_C      3       // per term beyond the constant one
+
+// MPUthermalFitSolve() return codes
+#define MPU6050_THERMAL_OK              0
+#define MPU6050_THERMAL_NARROW_SPAN     1       // too few distinct temperatures
+#define MPU6050_THERMAL_SINGULAR        2
+
+typedef struct {
+        float coeff[3][MPU6050_THERMAL_TERMS];  // bias = sum(coeff[k] * dT^k), LSB at +/-250 deg/s
+        int16_t tempRef;                        // TEMP_OUT at dT = 0
+        int16_t baseOffset[3];                  // XG_OFFS_USR in effect during the fit
+        int16_t cachedTemp;                     // TEMP_OUT >> MPU6050_THERMAL_CACHE_SHIFT of the cached bias
+        int16_t cachedBias[3];                  // bias at cachedTemp, LSB at cachedRange
+        uint8_t cachedRange;                    // FS_SEL the cached bias was scaled for
+        bool_t cacheValid;
+        int16_t programmed[3];                  // XG_OFFS_USR last written by MPUthermalUpdateOffsets
+        bool_t programmedValid;
+} MPUThermalModel;
+
+typedef struct {
+        int32_t gyroSum[MPU6050_THERMAL_BINS][3];   // LSB at +/-250 deg/s
+        int32_t tempSum[MPU6050_THERMAL_BINS];      // TEMP_OUT - tempRef
+        uint16_t count[MPU6050_THERMAL_BINS];
+        int16_t tempRef;                            // TEMP_OUT of the first sample
+        int16_t baseOffset[3];                      // XG_OFFS_USR during the sweep
+        bool_t started;
+} MPUThermalFit;
+
+void MPUthermalFitReset(MPUThermalFit *fit);
+void MPUthermalFitAdd(MPUThermalFit *fit, int16_t temp, const int16_t *gyro);
+void MPUthermalFitSample(MPUThermalFit *fit);
+uint8_t MPUthermalFitSolve(const MPUThermalFit *fit, MPUThermalModel *model);
+
+void MPUthermalInit(MPUThermalModel *model, int16_t tempRef, const int16_t *baseOffset);
+float MPUthermalBias(const MPUThermalModel *model, uint8_t axis, int16_t temp);
+void MPUthermalCompensate(MPUThermalModel *model, int16_t temp, int16_t *gyro);
+void MPUthermalGetMotion6(MPUThermalModel *model, int16_t *accel, int16_t *gyro);
+bool_t MPUthermalUpdateOffsets(MPUThermalModel *model, int16_t temp);
+
+void MPUthermalToBlob(const MPUThermalModel *model, CalibrationBlob *blob);
+void MPUthermalFromBlob(MPUThermalModel *model, const CalibrationBlob *blob);
+
+#endif /* _MPU6050_THERMAL_H_ */
@@ -0,0 +1,243 @@
+// I2Cdev library collection - MPU6050 I2C device class, redundancy voting
+// Median voting and fault isolation over a sync group
+//
+// Changelog:
+//     2026-10-18 - initial release
+//     2026-10-18 - bus errors from the sync layer fault the sensor, zero persist/stuckSamples rejected
+//     2026-10-18 - a self-test restarts only the tested sensor's FIFO
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, voting code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#include "ch.h"
+#include "hal.h"
+
+#include "MPU6050.h"
+#include "MPU6050_Vote.h"
+#include "MPU6050_SelfTest.h"
+
+// fault bits MPUvoteCheck() can clear by testing the sensor again
+#define VOTE_RUNTIME_FAULTS     (MPU6050_VOTE_STUCK | MPU6050_VOTE_SATURATED | MPU6050_VOTE_RESIDUAL | MPU6050_VOTE_NOISY)
+
+static int16_t voteAxis(const MPUSyncSample *sample, uint8_t axis) {
+    return axis < 3 ? sample -> accel[axis] : sample -> gyro[axis - 3];
+}
+
+// median of up to MPU6050_SYNC_MAX_SENSORS values, sorted in place
+static int16_t voteMedian(int16_t *v, uint8_t n) {
+    uint8_t i, j;
+    int16_t t;
+    for (i = 1; i < n; i++) {
+        t = v[i];
+        for (j = i; j > 0 && v[j - 1] > t; j--) v[j] = v[j - 1];
+        v[j] = t;
+    }
+    if (n & 1) return v[n / 2];
+    return (int16_t)(((int32_t)v[n / 2 - 1] + v[n / 2]) / 2);
+}
+
+static int16_t voteClamp(int32_t x) {
+    return x > INT16_MAX ? INT16_MAX : (x < -INT16_MAX ? -INT16_MAX : (int16_t)x);
+}
+
+static int16_t voteAbs(int32_t x) {
+    return voteClamp(x < 0 ? -x : x);
+}
+
+static void voteFault(MPUVote *vote, uint8_t s, uint8_t fault) {
+    if (vote -> fault[s] == 0) vote -> stats.failovers++;
+    vote -> fault[s] |= fault;
+}
+
+static void voteClear(MPUVote *vote, uint8_t s) {
+    uint8_t axis;
+    vote -> over[s] = 0;
+    vote -> saturated[s] = 0;
+    vote -> same[s] = 0;
+    vote -> noise[s][0] = 0;
+    vote -> noise[s][1] = 0;
+    for (axis = 0; axis < 6; axis++) {
+        vote -> last[s][axis] = 0;
+        vote -> residual[s][axis] = 0;
+    }
+}
+
+/** Start voting over the sensors of a sync group, all healthy.
+ * @param vote Output, voting state
+ * @param count Sensors in the group, at most MPU6050_SYNC_MAX_SENSORS
+ * @param config Fault limits, copied; persist and stuckSamples at least 1
+ * @return FALSE if count is out of range or persist or stuckSamples is 0,
+ *         which would fault every sensor on the first frame
+ */
+bool_t MPUvoteInit(MPUVote *vote, uint8_t count, const MPUVoteConfig *config) {
+    uint8_t s, axis;
+    if (count == 0 || count > MPU6050_SYNC_MAX_SENSORS) return FALSE;
+    if (config -> persist == 0 || config -> stuckSamples == 0) return FALSE;
+    vote -> count = count;
+    vote -> config = *config;
+    for (s = 0; s < MPU6050_SYNC_MAX_SENSORS; s++) {
+        vote -> fault[s] = 0;
+        voteClear(vote, s);
+    }
+    for (axis = 0; axis < 3; axis++) {
+        vote -> output.accel[axis] = 0;
+        vote -> output.gyro[axis] = 0;
+    }
+    vote -> output.used = 0;
+    vote -> output.outliers = 0;
+    vote -> output.agreed = FALSE;
+    vote -> stats.frames = 0;
+    vote -> stats.disagreed = 0;
+    vote -> stats.failovers = 0;
+    vote -> stats.outages = 0;
+    return TRUE;
+}
+
+/** Vote one frame and update the health of every sensor.
+ * A sensor the sync layer reports with a bus error is faulted with
+ * MPU6050_VOTE_NO_ANSWER before the vote; one without data in this frame
+ * (relocking after an overflow) sits the frame out.
+ * @param vote State from MPUvoteInit()
+ * @param frame Aligned frame from MPUsyncPoll()
+ * @param out Output, voted sample; the last one is held if no sensor is healthy
+ * @return FALSE if no sensor is healthy
+ */
+bool_t MPUvoteUpdate(MPUVote *vote, const MPUSyncFrame *frame, MPUVoteOutput *out) {
+    const MPUVoteConfig *config = &vote -> config;
+    int16_t v[MPU6050_SYNC_MAX_SENSORS], median[6], x, limit;
+    uint8_t healthy[MPU6050_SYNC_MAX_SENSORS];
+    uint8_t n = 0, s, i, axis, type;
+    bool_t same, rail, over;
+    int32_t change, noise[2];
+    const MPUSyncSample *sample;
+
+    vote -> stats.frames++;
+    for (s = 0; s < vote -> count; s++) {
+        if (frame -> sample[s].status == MPU6050_SYNC_BUS_ERROR) voteFault(vote, s, MPU6050_VOTE_NO_ANSWER);
+        if (vote -> fault[s] == 0 && frame -> sample[s].status == MPU6050_SYNC_OK) healthy[n++] = s;
+    }
+    if (n == 0) {
+        vote -> stats.outages++;
+        vote -> output.used = 0;
+        vote -> output.outliers = 0;
+        vote -> output.agreed = FALSE;
+        *out = vote -> output;
+        return FALSE;
+    }
+
+    for (axis = 0; axis < 6; axis++) {
+        for (s = 0; s < n; s++) v[s] = voteAxis(&frame -> sample[healthy[s]], axis);
+        median[axis] = voteMedian(v, n);
+    }
+
+    vote -> output.outliers = 0;
+    for (s = 0; s < n; s++) {
+        i = healthy[s];
+        sample = &frame -> sample[i];
+        noise[0] = 0;
+        noise[1] = 0;
+        same = TRUE;
+        rail = FALSE;
+        over = FALSE;
+        for (axis = 0; axis < 6; axis++) {
+            type = axis < 3 ? 0 : 1;
+            limit = type ? config -> gyroResidual : config -> accelResidual;
+            x = voteAxis(sample, axis);
+            if (x != vote -> last[i][axis]) same = FALSE;
+            vote -> last[i][axis] = x;
+            if (voteAbs(x) >= MPU6050_VOTE_RAIL && voteAbs(median[axis]) < MPU6050_VOTE_RAIL) rail = TRUE;
+            change = (int32_t)x - median[axis];
+            if (voteAbs(change) > limit) over = TRUE;
+            noise[type] += voteAbs(change - vote -> residual[i][axis]);
+            vote -> residual[i][axis] = voteClamp(change);
+        }
+        for (type = 0; type < 2; type++)
+            vote -> noise[i][type] += noise[type] - (vote -> noise[i][type] >> MPU6050_VOTE_NOISE_SHIFT);
+
+        vote -> same[i] = same ? vote -> same[i] + 1 : 0;
+        vote -> saturated[i] = rail ? vote -> saturated[i] + 1 : 0;
+        vote -> over[i] = over ? vote -> over[i] + 1 : 0;
+        if (over) vote -> output.outliers |= 1 << i;
+
+        if (vote -> same[i] >= config -> stuckSamples) voteFault(vote, i, MPU6050_VOTE_STUCK);
+        if (vote -> saturated[i] >= config -> persist) voteFault(vote, i, MPU6050_VOTE_SATURATED);
+        // with two sensors residuals are symmetric and point at neither
+        if (n >= 3) {
+            if (vote -> over[i] >= config -> persist) voteFault(vote, i, MPU6050_VOTE_RESIDUAL);
+            if ((vote -> noise[i][0] >> MPU6050_VOTE_NOISE_SHIFT) > config -> accelNoise ||
+                (vote -> noise[i][1] >> MPU6050_VOTE_NOISE_SHIFT) > config -> gyroNoise) voteFault(vote, i, MPU6050_VOTE_NOISY);
+        }
+    }
+
+    for (axis = 0; axis < 3; axis++) {
+        vote -> output.accel[axis] = median[axis];
+        vote -> output.gyro[axis] = median[3 + axis];
+    }
+    vote -> output.used = n;
+    vote -> output.agreed = !(n == 2 && vote -> output.outliers);
+    if (!vote -> output.agreed) vote -> stats.disagreed++;
+    *out = vote -> output;
+    return TRUE;
+}
+
+/** Test one sensor on the bus and clear its faults if it passes.
+ * A self-test resets that sensor's FIFO: it sits out until the next
+ * strobe, the other sensors keep voting meanwhile.
+ * @param vote State from MPUvoteInit()
+ * @param group Sync group the vote runs on
+ * @param s Sensor index
+ * @param selfTest Run MPUselfTest() as well, keep the board still
+ * @return Fault bits of the sensor afterwards, 0 if healthy
+ */
+uint8_t MPUvoteCheck(MPUVote *vote, MPUSyncGroup *group, uint8_t s, bool_t selfTest) {
+    MPUSelfTestResult result;
+    uint8_t saved = MPUdevAddr;
+    uint8_t fault = 0;
+
+    if (s >= vote -> count) return 0;
+    MPUdevAddr = group -> address[s];
+    if (!MPUtestConnection()) fault = MPU6050_VOTE_NO_ANSWER;
+    else if (selfTest && MPUselfTest(&result) != 0) fault = MPU6050_VOTE_SELFTEST;
+    MPUdevAddr = saved;
+    if (selfTest && !(fault & MPU6050_VOTE_NO_ANSWER) && !MPUsyncRestart(group, s)) fault |= MPU6050_VOTE_NO_ANSWER;
+
+    if (fault) {
+        voteFault(vote, s, fault);
+    } else {
+        // a runtime fault clears, a failed self-test only by passing one
+        vote -> fault[s] &= selfTest ? 0 : ~(VOTE_RUNTIME_FAULTS | MPU6050_VOTE_NO_ANSWER);
+        if (vote -> fault[s] == 0) voteClear(vote, s);
+    }
+    return vote -> fault[s];
+}
+
+/** Healthy sensors as a bit per sensor index.
+ * @param vote State from MPUvoteInit()
+ * @return Bit i set if sensor i is in the vote
+ */
+uint8_t MPUvoteHealthy(const MPUVote *vote) {
+    uint8_t mask = 0, s;
+    for (s = 0; s < vote -> count; s++) if (vote -> fault[s] == 0) mask |= 1 << s;
+    return mask;
+}
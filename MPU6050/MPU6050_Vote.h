@@ -0,0 +1,116 @@
+// I2Cdev library collection - MPU6050 I2C device class, redundancy voting
+// Median voting and fault isolation over a sync group
+//
+// Changelog:
+//     2026-10-18 - initial release
+//     2026-10-18 - bus errors from the sync layer fault the sensor, zero persist/stuckSamples rejected
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, voting code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#ifndef _MPU6050_VOTE_H_
+#define _MPU6050_VOTE_H_
+
+#include "MPU6050_Sync.h"
+
+/* MPUvoteUpdate() takes one aligned frame from a sync group and votes each
+ * of the six axes: the median of the healthy sensors, the mean of the two
+ * middle values for an even count. Each healthy sensor's residual (sample
+ * minus median) feeds the fault checks:
+ *
+ *   stuck       all six axes unchanged for stuckSamples frames
+ *   saturated   an axis at the rail while the median is not, persist frames
+ *   residual    an axis further than the limit from the median, persist frames
+ *   noisy       smoothed |residual change| per sensor type above the limit
+ *
+ * A faulted sensor is dropped from the vote. It was already outvoted
+ * while it misbehaved, so with three or more sensors the output does not
+ * step at the failover. With two healthy sensors the median is their
+ * mean and a residual cannot tell which one is wrong: the frame is
+ * flagged as disagreeing, only stuck and saturation checks still isolate.
+ * A sensor whose sample reports a bus error is faulted in that frame and
+ * never votes with an empty sample; one relocking after an overflow just
+ * sits out until it has data again. Faults latch until MPUvoteCheck()
+ * tests the sensor again.
+ *
+ * The update works on raw LSB with integer math and no bus traffic, its
+ * cost is fixed by MPU6050_SYNC_MAX_SENSORS (a few hundred instructions),
+ * so it runs in a 1kHz loop. MPUvoteCheck() does I2C and, with the
+ * self-test, about 100ms of waiting; run it at boot or from a slower task.
+ */
+#define MPU6050_VOTE_RAIL               32700   // |raw| at or above counts as saturated
+#define MPU6050_VOTE_NOISE_SHIFT        4       // noise filter, 1/16 of each new value
+
+// fault bits, 0 means healthy
+#define MPU6050_VOTE_NO_ANSWER          0x01    // bus error in a frame or MPUtestConnection() failed
+#define MPU6050_VOTE_SELFTEST           0x02    // MPUselfTest() failed
+#define MPU6050_VOTE_STUCK              0x04
+#define MPU6050_VOTE_SATURATED          0x08
+#define MPU6050_VOTE_RESIDUAL           0x10
+#define MPU6050_VOTE_NOISY              0x20
+
+typedef struct {
+        int16_t accelResidual;      // max |sample - median|, raw LSB
+        int16_t gyroResidual;
+        int16_t accelNoise;         // max smoothed |residual change| summed over the axes, raw LSB
+        int16_t gyroNoise;
+        uint16_t persist;           // frames over the residual or saturation limit before a fault
+        uint16_t stuckSamples;      // identical frames before a fault
+} MPUVoteConfig;
+
+typedef struct {
+        int16_t accel[3];           // voted, raw LSB
+        int16_t gyro[3];
+        uint8_t used;               // healthy sensors with data in the vote
+        uint8_t outliers;           // bit per sensor over a residual limit in this frame
+        bool_t agreed;              // FALSE if two sensors disagree or none is healthy
+} MPUVoteOutput;
+
+typedef struct {
+        uint32_t frames;
+        uint32_t disagreed;         // frames with two healthy sensors over the residual limit
+        uint32_t failovers;         // sensors isolated
+        uint32_t outages;           // frames without a healthy sensor with data
+} MPUVoteStats;
+
+typedef struct {
+        uint8_t count;
+        MPUVoteConfig config;
+        uint8_t fault[MPU6050_SYNC_MAX_SENSORS];
+        uint16_t over[MPU6050_SYNC_MAX_SENSORS];        // consecutive frames over a residual limit
+        uint16_t saturated[MPU6050_SYNC_MAX_SENSORS];
+        uint16_t same[MPU6050_SYNC_MAX_SENSORS];        // consecutive identical frames
+        int16_t last[MPU6050_SYNC_MAX_SENSORS][6];      // previous accel, gyro
+        int16_t residual[MPU6050_SYNC_MAX_SENSORS][6];
+        int32_t noise[MPU6050_SYNC_MAX_SENSORS][2];     // accel, gyro, << MPU6050_VOTE_NOISE_SHIFT
+        MPUVoteOutput output;       // last result, held while no sensor is healthy
+        MPUVoteStats stats;
+} MPUVote;
+
+bool_t MPUvoteInit(MPUVote *vote, uint8_t count, const MPUVoteConfig *config);
+bool_t MPUvoteUpdate(MPUVote *vote, const MPUSyncFrame *frame, MPUVoteOutput *out);
+uint8_t MPUvoteCheck(MPUVote *vote, MPUSyncGroup *group, uint8_t s, bool_t selfTest);
+uint8_t MPUvoteHealthy(const MPUVote *vote);
+
+#endif /* _MPU6050_VOTE_H_ */
@@ -0,0 +1,140 @@
+// I2C device class (I2Cdev) MPU6050 class, calibration blob helper
+// Versioned, checksummed serialization of the calibration data
+//
+// Changelog:
+//     2026-10-18 - initial release, format version 1
+//     2026-10-18 - gain trims dropped from version 1, nothing applied them
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, calibration blob helper code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#ifndef _HELPER_CALBLOB_H_
+#define _HELPER_CALBLOB_H_
+
+/* Only <stdint.h>, no ChibiOS dependency, so tools/calblob.c can build and
+ * check blobs on the host with the exact same code the MCU uses.
+ *
+ * Blob layout, all multi-byte fields little-endian:
+ *
+ *   0  magic 'M' 'C'
+ *   2  format version
+ *   3  total length in bytes, CRC included
+ *   4  gyroOffset[3]       XG/YG/ZG_OFFS_USR register values
+ *  10  accelOffset[3]      XA/YA/ZA_OFFS register values
+ *  16  gyroTempCoeff[3]    gyro bias drift, 1/256 LSB (+/-250 deg/s) per degree C
+ *  22  tempRef             TEMP_OUT register value at calibration time
+ *  24  CRC-16/CCITT-FALSE over bytes 0..23
+ *
+ * Readers reject a newer version than they know; a later version only
+ * appends fields in front of the CRC, so the length byte tells old and new
+ * blobs apart without parsing them.
+ */
+#include <stdint.h>
+
+#define CALBLOB_MAGIC0          'M'
+#define CALBLOB_MAGIC1          'C'
+#define CALBLOB_VERSION         1
+#define CALBLOB_SIZE            26
+
+// calBlobUnpack() return codes
+#define CALBLOB_OK              0
+#define CALBLOB_BAD_MAGIC       1
+#define CALBLOB_BAD_VERSION     2
+#define CALBLOB_BAD_LENGTH      3
+#define CALBLOB_BAD_CRC         4
+#define CALBLOB_NO_DATA         5   // storage empty or unreadable
+
+typedef struct {
+        int16_t gyroOffset[3];
+        int16_t accelOffset[3];
+        int16_t gyroTempCoeff[3];
+        int16_t tempRef;
+} CalibrationBlob;
+
+static uint16_t calBlobCrc16(const uint8_t *data, uint16_t length) {
+		uint16_t crc = 0xFFFF;
+		uint8_t bit;
+		while (length--) {
+			crc ^= (uint16_t)(*data++) << 8;
+			for (bit = 0; bit < 8; bit++) crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+		}
+		return crc;
+}
+
+static void calBlobPutWords(uint8_t *out, const int16_t *words, uint8_t count) {
+		uint8_t i;
+		for (i = 0; i < count; i++) {
+			out[2 * i] = (uint8_t)((uint16_t)words[i] & 0xFF);
+			out[2 * i + 1] = (uint8_t)((uint16_t)words[i] >> 8);
+		}
+}
+
+static void calBlobGetWords(int16_t *words, const uint8_t *in, uint8_t count) {
+		uint8_t i;
+		for (i = 0; i < count; i++) words[i] = (int16_t)(in[2 * i] | ((uint16_t)in[2 * i + 1] << 8));
+}
+
+/** Serialize a calibration.
+ * @param blob Calibration data
+ * @param out Output buffer, at least CALBLOB_SIZE bytes
+ * @return Number of bytes written (CALBLOB_SIZE)
+ */
+static uint8_t calBlobPack(const CalibrationBlob *blob, uint8_t *out) {
+		uint16_t crc;
+		out[0] = CALBLOB_MAGIC0;
+		out[1] = CALBLOB_MAGIC1;
+		out[2] = CALBLOB_VERSION;
+		out[3] = CALBLOB_SIZE;
+		calBlobPutWords(out + 4, blob -> gyroOffset, 3);
+		calBlobPutWords(out + 10, blob -> accelOffset, 3);
+		calBlobPutWords(out + 16, blob -> gyroTempCoeff, 3);
+		calBlobPutWords(out + 22, &blob -> tempRef, 1);
+		crc = calBlobCrc16(out, CALBLOB_SIZE - 2);
+		out[CALBLOB_SIZE - 2] = (uint8_t)(crc & 0xFF);
+		out[CALBLOB_SIZE - 1] = (uint8_t)(crc >> 8);
+		return CALBLOB_SIZE;
+}
+
+/** Deserialize and verify a calibration.
+ * @param blob Output, only written when the blob is valid
+ * @param in Serialized blob
+ * @param length Number of bytes available in the input buffer
+ * @return CALBLOB_OK or one of the CALBLOB_* error codes
+ */
+static uint8_t calBlobUnpack(CalibrationBlob *blob, const uint8_t *in, uint16_t length) {
+		uint16_t crc;
+		if (length == 0) return CALBLOB_NO_DATA;
+		if (length < 4 || in[0] != CALBLOB_MAGIC0 || in[1] != CALBLOB_MAGIC1) return CALBLOB_BAD_MAGIC;
+		if (in[2] == 0 || in[2] > CALBLOB_VERSION) return CALBLOB_BAD_VERSION;
+		if (in[3] != CALBLOB_SIZE || length < CALBLOB_SIZE) return CALBLOB_BAD_LENGTH;
+		crc = calBlobCrc16(in, CALBLOB_SIZE - 2);
+		if (in[CALBLOB_SIZE - 2] != (uint8_t)(crc & 0xFF) || in[CALBLOB_SIZE - 1] != (uint8_t)(crc >> 8)) return CALBLOB_BAD_CRC;
+		calBlobGetWords(blob -> gyroOffset, in + 4, 3);
+		calBlobGetWords(blob -> accelOffset, in + 10, 3);
+		calBlobGetWords(blob -> gyroTempCoeff, in + 16, 3);
+		calBlobGetWords(&blob -> tempRef, in + 22, 1);
+		return CALBLOB_OK;
+}
+
+#endif /* _HELPER_CALBLOB_H_ */
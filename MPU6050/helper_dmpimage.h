@@ -0,0 +1,185 @@
+// I2C device class (I2Cdev) MPU6050 class, compressed DMP image helper
+// Streaming decoder for DMP memory images packed with tools/dmppack.c
+//
+// Changelog:
+//     2026-10-18 - initial release
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, DMP image helper code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#ifndef _HELPER_DMPIMAGE_H_
+#define _HELPER_DMPIMAGE_H_
+
+/* Only <stdint.h>, so tools/dmppack.c packs and checks images on the host
+ * with the decoder the MCU runs.
+ *
+ * Image layout, multi-byte fields little-endian:
+ *
+ *   0  unpacked length
+ *   2  CRC-16/CCITT-FALSE of the unpacked data
+ *   4  tokens
+ *
+ * Tokens:
+ *
+ *   00LLLLLL                   L + 1 literal bytes follow
+ *   01LLLLLL                   L + 1 zero bytes
+ *   1LLLLOOO OOOOOOOO          L + 3 bytes copied from image offset O
+ *
+ * A copy reads from the image itself (literals, but also token bytes that
+ * happen to match), never from the unpacked output. So the decoder needs no
+ * history window in RAM: it only keeps a few offsets and hands out the data
+ * in chunks of any size. The copy source has to end before the copy token,
+ * offsets reach the first 2048 bytes of the image.
+ */
+#include <stdint.h>
+
+#define DMPIMAGE_HEADER_SIZE    4
+#define DMPIMAGE_MAX_LITERAL    64
+#define DMPIMAGE_MAX_ZERO       64
+#define DMPIMAGE_MIN_COPY       3
+#define DMPIMAGE_MAX_COPY       18
+#define DMPIMAGE_MAX_OFFSET     2047
+
+#define DMPIMAGE_LITERAL        0x00
+#define DMPIMAGE_ZERO           0x40
+#define DMPIMAGE_COPY           0x80
+
+// dmpImageBegin()/dmpImageEnd() return codes
+#define DMPIMAGE_OK             0
+#define DMPIMAGE_BAD_LENGTH     1   // truncated image or unpacked length mismatch
+#define DMPIMAGE_BAD_TOKEN      2   // copy outside the image
+#define DMPIMAGE_BAD_CRC        3
+
+typedef struct {
+        const uint8_t *image;
+        uint16_t length;        // image bytes
+        uint16_t pos;           // next token
+        uint16_t from;          // next literal or copy source byte
+        uint8_t kind;           // DMPIMAGE_LITERAL, _ZERO or _COPY
+        uint8_t remaining;      // bytes left in the current token
+        uint16_t total;         // unpacked length from the header
+        uint16_t produced;
+        uint16_t crc;
+        uint8_t error;
+} DmpImageReader;
+
+static uint16_t dmpImageCrc16(uint16_t crc, const uint8_t *data, uint16_t length) {
+		uint8_t bit;
+		while (length--) {
+			crc ^= (uint16_t)(*data++) << 8;
+			for (bit = 0; bit < 8; bit++) crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+		}
+		return crc;
+}
+
+/** Unpacked length of an image.
+ * @param image Packed image, at least DMPIMAGE_HEADER_SIZE bytes
+ * @return Unpacked length
+ */
+static uint16_t dmpImageSize(const uint8_t *image) {
+		return image[0] | ((uint16_t)image[1] << 8);
+}
+
+/** Start decoding an image.
+ * @param reader Output, decoder state
+ * @param image Packed image, has to stay readable until the last dmpImageRead()
+ * @param length Packed length
+ * @return DMPIMAGE_OK or DMPIMAGE_BAD_LENGTH
+ */
+static uint8_t dmpImageBegin(DmpImageReader *reader, const uint8_t *image, uint16_t length) {
+		reader -> image = image;
+		reader -> length = length;
+		reader -> pos = DMPIMAGE_HEADER_SIZE;
+		reader -> from = 0;
+		reader -> kind = DMPIMAGE_LITERAL;
+		reader -> remaining = 0;
+		reader -> produced = 0;
+		reader -> crc = 0xFFFF;
+		reader -> error = (length < DMPIMAGE_HEADER_SIZE) ? DMPIMAGE_BAD_LENGTH : DMPIMAGE_OK;
+		reader -> total = reader -> error ? 0 : dmpImageSize(image);
+		return reader -> error;
+}
+
+/* Decode the next token header. */
+static uint8_t dmpImageToken(DmpImageReader *reader) {
+		uint8_t t;
+		uint16_t offset;
+		if (reader -> pos >= reader -> length) return DMPIMAGE_BAD_LENGTH;
+		t = reader -> image[reader -> pos];
+		if (t & DMPIMAGE_COPY) {
+			if (reader -> pos + 2 > reader -> length) return DMPIMAGE_BAD_LENGTH;
+			offset = ((uint16_t)(t & 0x07) << 8) | reader -> image[reader -> pos + 1];
+			reader -> kind = DMPIMAGE_COPY;
+			reader -> remaining = ((t >> 3) & 0x0F) + DMPIMAGE_MIN_COPY;
+			if (offset + reader -> remaining > reader -> pos) return DMPIMAGE_BAD_TOKEN;
+			reader -> from = offset;
+			reader -> pos += 2;
+		} else {
+			reader -> kind = t & DMPIMAGE_ZERO;
+			reader -> remaining = (t & 0x3F) + 1;
+			reader -> pos++;
+			if (reader -> kind == DMPIMAGE_LITERAL) {
+				if (reader -> pos + reader -> remaining > reader -> length) return DMPIMAGE_BAD_LENGTH;
+				reader -> from = reader -> pos;
+				reader -> pos += reader -> remaining;
+			}
+		}
+		return DMPIMAGE_OK;
+}
+
+/** Decode the next bytes of an image.
+ * @param reader Decoder state from dmpImageBegin()
+ * @param out Output buffer
+ * @param count Bytes wanted
+ * @return Bytes decoded, less than count at the end of the data or on an error
+ */
+static uint16_t dmpImageRead(DmpImageReader *reader, uint8_t *out, uint16_t count) {
+		uint16_t n = 0;
+		uint8_t *start = out;
+		while (n < count && reader -> produced < reader -> total && !reader -> error) {
+			if (reader -> remaining == 0) {
+				reader -> error = dmpImageToken(reader);
+				continue;
+			}
+			*out++ = (reader -> kind == DMPIMAGE_ZERO) ? 0 : reader -> image[reader -> from++];
+			reader -> remaining--;
+			reader -> produced++;
+			n++;
+		}
+		reader -> crc = dmpImageCrc16(reader -> crc, start, n);
+		return n;
+}
+
+/** Check that the whole image was decoded and matches its CRC.
+ * @param reader Decoder state after the last dmpImageRead()
+ * @return DMPIMAGE_OK or one of the DMPIMAGE_* error codes
+ */
+static uint8_t dmpImageEnd(const DmpImageReader *reader) {
+		if (reader -> error) return reader -> error;
+		if (reader -> produced != reader -> total || reader -> remaining != 0 || reader -> pos != reader -> length) return DMPIMAGE_BAD_LENGTH;
+		if (reader -> crc != (reader -> image[2] | ((uint16_t)reader -> image[3] << 8))) return DMPIMAGE_BAD_CRC;
+		return DMPIMAGE_OK;
+}
+
+#endif /* _HELPER_DMPIMAGE_H_ */
@@ -0,0 +1,84 @@
+// I2C device class (I2Cdev) MPU6050 class, fast float trigonometry helper
+// Polynomial atan/atan2/asin used by MPUdmpGetEuler and MPUdmpGetYawPitchRoll
+//
+// Changelog:
+//     2026-10-18 - initial release
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, fast trigonometry helper code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#ifndef _HELPER_FASTTRIG_H_
+#define _HELPER_FASTTRIG_H_
+
+/* Only <math.h> for sqrtf (a single VSQRT on Cortex-M4F), no ChibiOS
+ * dependency so the host benchmark in tools/ can include this as-is.
+ * All constants are float literals: nothing here promotes to double.
+ */
+#include <math.h>
+
+#define FASTTRIG_PI         3.14159265f
+#define FASTTRIG_PI_2       1.57079633f
+
+// worst case absolute error of the approximations below, in radians
+#define FASTTRIG_ATAN_MAX_ERROR     1.5e-5f
+#define FASTTRIG_ASIN_MAX_ERROR     7.0e-5f
+
+static float fastAtanUnit(float x) {
+		// atan(x) for |x| <= 1, Abramowitz & Stegun 4.4.49 (|error| <= 1e-5)
+		float x2 = x * x;
+		return x * (0.9998660f + x2 * (-0.3302995f + x2 * (0.1801410f + x2 * (-0.0851330f + x2 * 0.0208351f))));
+}
+
+static float fastAtan2f(float y, float x) {
+		float ax = fabsf(x), ay = fabsf(y), a;
+		if (ax == 0.0f && ay == 0.0f) return 0.0f;
+		// fold into the first octant so the polynomial argument stays in [0, 1]
+		if (ay > ax) {
+			a = FASTTRIG_PI_2 - fastAtanUnit(ax / ay);
+		} else {
+			a = fastAtanUnit(ay / ax);
+		}
+		if (x < 0.0f) a = FASTTRIG_PI - a;
+		return (y < 0.0f) ? -a : a;
+}
+
+static float fastAtanf(float x) {
+		if (x > 1.0f) return FASTTRIG_PI_2 - fastAtanUnit(1.0f / x);
+		if (x < -1.0f) return -FASTTRIG_PI_2 - fastAtanUnit(1.0f / x);
+		return fastAtanUnit(x);
+}
+
+static float fastAsinf(float x) {
+		// asin(x) = pi/2 - sqrt(1 - x) * P(x) for 0 <= x <= 1,
+		// Abramowitz & Stegun 4.4.45 (|error| <= 6.8e-5)
+		float ax = fabsf(x), a;
+		if (ax >= 1.0f) {
+			a = FASTTRIG_PI_2; // also clamps |x| > 1 caused by an unnormalized quaternion
+		} else {
+			a = FASTTRIG_PI_2 - sqrtf(1.0f - ax) * (1.5707288f + ax * (-0.2121144f + ax * (0.0742610f + ax * -0.0187293f)));
+		}
+		return (x < 0.0f) ? -a : a;
+}
+
+#endif /* _HELPER_FASTTRIG_H_ */
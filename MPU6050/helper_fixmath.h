@@ -0,0 +1,194 @@
+// I2C device class (I2Cdev) MPU6050 class, fixed-point 3D math helper
+// Mirrors helper_3dmath.h for targets without an FPU (Cortex-M0/M3)
+//
+// Changelog:
+//     2026-10-18 - initial release: Q30/Q14 quaternion kernels
+//     2026-10-18 - fixNormalizeVectQ30() for raw vectors of any full scale
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, fixed-point math helper code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#ifndef _HELPER_FIXMATH_H_
+#define _HELPER_FIXMATH_H_
+
+#include "ch.h"
+#include "helper_3dmath.h"
+
+/* The DMP delivers its quaternion as 32-bit Q30 (1.0 = 2^30, see
+ * MPUdmpGetQuaternion32) or, truncated to the high halfword, as Q14
+ * (1.0 = 16384, see MPUdmpGetQuaternion16). The kernels below keep that
+ * representation all the way through so no soft-float call is ever made.
+ * Gravity is returned in Q14 (1g = 16384) in a plain VectorInt16.
+ */
+#define FIX_Q30_ONE     (1L << 30)
+#define FIX_Q14_ONE     (1 << 14)
+
+typedef struct {
+        int32_t w;
+        int32_t x;
+        int32_t y;
+        int32_t z;
+} QuaternionQ30;
+
+typedef struct {
+        int16_t w;
+        int16_t x;
+        int16_t y;
+        int16_t z;
+} QuaternionQ14;
+
+static QuaternionQ30 getQuatQ30FromQ14(const QuaternionQ14* q) {
+		QuaternionQ30 tmp;
+		tmp.w = (int32_t)q->w << 16;
+		tmp.x = (int32_t)q->x << 16;
+		tmp.y = (int32_t)q->y << 16;
+		tmp.z = (int32_t)q->z << 16;
+		return tmp;
+}
+
+static Quaternion getQuatFloatFromQ30(const QuaternionQ30* q) {
+		Quaternion tmp;
+		tmp.w = (float)q->w / (float)FIX_Q30_ONE;
+		tmp.x = (float)q->x / (float)FIX_Q30_ONE;
+		tmp.y = (float)q->y / (float)FIX_Q30_ONE;
+		tmp.z = (float)q->z / (float)FIX_Q30_ONE;
+		return tmp;
+}
+
+static QuaternionQ30 getProductQ30(const QuaternionQ30* q1, const QuaternionQ30* q2) {
+		// same Hamilton product as getProduct(), accumulated in 64 bits (Q60)
+		// and shifted back to Q30 once per component
+		QuaternionQ30 tmp;
+		tmp.w = (int32_t)(((int64_t)q1->w * q2->w - (int64_t)q1->x * q2->x - (int64_t)q1->y * q2->y - (int64_t)q1->z * q2->z) >> 30);
+		tmp.x = (int32_t)(((int64_t)q1->w * q2->x + (int64_t)q1->x * q2->w + (int64_t)q1->y * q2->z - (int64_t)q1->z * q2->y) >> 30);
+		tmp.y = (int32_t)(((int64_t)q1->w * q2->y - (int64_t)q1->x * q2->z + (int64_t)q1->y * q2->w + (int64_t)q1->z * q2->x) >> 30);
+		tmp.z = (int32_t)(((int64_t)q1->w * q2->z + (int64_t)q1->x * q2->y - (int64_t)q1->y * q2->x + (int64_t)q1->z * q2->w) >> 30);
+		return tmp;
+}
+
+static QuaternionQ14 getProductQ14(const QuaternionQ14* q1, const QuaternionQ14* q2) {
+		// 32-bit only variant for cores without a 32x32->64 multiplier (Cortex-M0).
+		// Each component is bounded by |q1||q2| <= 2^28 so int32 cannot overflow.
+		QuaternionQ14 tmp;
+		tmp.w = (int16_t)(((int32_t)q1->w * q2->w - (int32_t)q1->x * q2->x - (int32_t)q1->y * q2->y - (int32_t)q1->z * q2->z) >> 14);
+		tmp.x = (int16_t)(((int32_t)q1->w * q2->x + (int32_t)q1->x * q2->w + (int32_t)q1->y * q2->z - (int32_t)q1->z * q2->y) >> 14);
+		tmp.y = (int16_t)(((int32_t)q1->w * q2->y - (int32_t)q1->x * q2->z + (int32_t)q1->y * q2->w + (int32_t)q1->z * q2->x) >> 14);
+		tmp.z = (int16_t)(((int32_t)q1->w * q2->z + (int32_t)q1->x * q2->y - (int32_t)q1->y * q2->x + (int32_t)q1->z * q2->w) >> 14);
+		return tmp;
+}
+
+static QuaternionQ30 getConjugateQ30(const QuaternionQ30* q) {
+		QuaternionQ30 tmp;
+		tmp.w = q->w;
+		tmp.x = -q->x;
+		tmp.y = -q->y;
+		tmp.z = -q->z;
+		return tmp;
+}
+
+/** Integer inverse square root.
+ * @param x Operand in unsigned Q30 (0 < x < 4.0)
+ * @return 1/sqrt(x) in unsigned Q30, saturated to 0xFFFFFFFF (0 if x == 0)
+ */
+static uint32_t fixInvSqrtQ30(uint32_t x) {
+		uint32_t y;
+		uint64_t xyy;
+		int8_t shift = 0, i;
+
+		if (x == 0) return 0;
+
+		// scale by powers of four into [0.25, 1.0) so that 1/sqrt lies in (1, 2]
+		while (x < (1UL << 28)) { x <<= 2; shift++; }
+		while (x >= (1UL << 30)) { x >>= 2; shift--; }
+
+		// chord of 1/sqrt(x) over [0.25, 1.0) as first guess (< 18% error),
+		// then Newton-Raphson: y' = y * (3 - x*y^2) / 2
+		y = (2UL << 30) - (((x - (1UL << 28)) * 4) / 3);
+		for (i = 0; i < 4; i++) {
+			xyy = ((uint64_t)x * (((uint64_t)y * y) >> 30)) >> 30;
+			y = (uint32_t)(((uint64_t)y * ((3ULL << 30) - xyy)) >> 31);
+		}
+
+		if (shift > 0) {
+			if (y > (0xFFFFFFFFUL >> shift)) return 0xFFFFFFFFUL;
+			return y << shift;
+		}
+		return y >> -shift;
+}
+
+/** Scale a raw 3-axis vector to unit length.
+ * Small vectors are shifted up first so that 1/|v| does not saturate:
+ * fixInvSqrtQ30() returns 2^45/|v|, which only fits for |v| >= 2^13.
+ * @param v Raw counts [x, y, z], any full scale
+ * @param out Unit vector in Q30
+ * @return 0 for a zero vector (out untouched), 1 otherwise
+ */
+static uint8_t fixNormalizeVectQ30(const int16_t* v, int32_t* out) {
+		uint32_t norm2;
+		int64_t inv;
+		uint8_t shift = 0, i;
+
+		// sum of squares is < 3 * 2^30, i.e. a valid unsigned Q30 operand
+		norm2 = (uint32_t)((int32_t)v[0] * v[0]) + (uint32_t)((int32_t)v[1] * v[1]) + (uint32_t)((int32_t)v[2] * v[2]);
+		if (norm2 == 0) return 0;
+		while (norm2 < (1UL << 26)) { norm2 <<= 2; shift++; }
+		// 1/sqrt(norm2 / 2^30) in Q30 equals 2^45 / (|v| << shift)
+		inv = fixInvSqrtQ30(norm2);
+		for (i = 0; i < 3; i++) out[i] = (int32_t)((((int64_t)v[i] << shift) * inv) >> 15);
+		return 1;
+}
+
+static uint32_t getMagnitudeSquaredQuatQ30(const QuaternionQ30* q) {
+		return (uint32_t)(((int64_t)q->w * q->w + (int64_t)q->x * q->x + (int64_t)q->y * q->y + (int64_t)q->z * q->z) >> 30);
+}
+
+static void normalizeQuatQ30(QuaternionQ30* q) {
+		// one inverse square root and four multiplies instead of sqrtf and four divides
+		int64_t inv = fixInvSqrtQ30(getMagnitudeSquaredQuatQ30(q));
+		q->w = (int32_t)((q->w * inv) >> 30);
+		q->x = (int32_t)((q->x * inv) >> 30);
+		q->y = (int32_t)((q->y * inv) >> 30);
+		q->z = (int32_t)((q->z * inv) >> 30);
+}
+
+static void rotateVectIntQ30(VectorInt16* v, const QuaternionQ30* q) {
+		// v' = v + w*t + (q x t) with t = 2*(q x v), q assumed normalized.
+		// t is kept in Q8 (counts * 256) so both products stay inside int64.
+		int64_t tx, ty, tz;
+		tx = ((int64_t)q->y * v->z - (int64_t)q->z * v->y) >> 21;
+		ty = ((int64_t)q->z * v->x - (int64_t)q->x * v->z) >> 21;
+		tz = ((int64_t)q->x * v->y - (int64_t)q->y * v->x) >> 21;
+		v->x += (int16_t)((q->w * tx + q->y * tz - q->z * ty + (1LL << 37)) >> 38);
+		v->y += (int16_t)((q->w * ty + q->z * tx - q->x * tz + (1LL << 37)) >> 38);
+		v->z += (int16_t)((q->w * tz + q->x * ty - q->y * tx + (1LL << 37)) >> 38);
+}
+
+static void getGravityQ14(VectorInt16* v, const QuaternionQ30* q) {
+		// fixed-point version of MPUdmpGetGravityVect(), result in Q14 (1g = 16384)
+		v->x = (int16_t)(((int64_t)q->x * q->z - (int64_t)q->w * q->y) >> 45);
+		v->y = (int16_t)(((int64_t)q->w * q->x + (int64_t)q->y * q->z) >> 45);
+		v->z = (int16_t)(((int64_t)q->w * q->w - (int64_t)q->x * q->x - (int64_t)q->y * q->y + (int64_t)q->z * q->z) >> 46);
+}
+
+#endif /* _HELPER_FIXMATH_H_ */
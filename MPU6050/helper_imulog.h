@@ -0,0 +1,359 @@
+// I2C device class (I2Cdev) MPU6050 class, compact sample log format
+// Delta/varint encoded, checksummed blocks for high-rate capture to SD
+//
+// Changelog:
+//     2026-10-18 - initial release
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, sample log format code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+
+#ifndef _HELPER_IMULOG_H_
+#define _HELPER_IMULOG_H_
+
+/* Only <stdint.h>, no ChibiOS dependency: the MCU writes blocks with
+ * imuLogBegin()/imuLogAdd()/imuLogFinish(), tools/imulog.c reads them back
+ * with imuLogCheck()/imuLogDecode() from the same header.
+ *
+ * A log is a sequence of self-contained blocks, all fields little-endian:
+ *
+ *   0  magic 'I' 'L'
+ *   2  format version
+ *   3  channels per sample, 1..IMULOG_MAX_CHANNELS
+ *   4  sample count
+ *   6  block length in bytes, header and CRC included
+ *   8  timestamp of the first sample (caller's unit, e.g. systime_t ticks)
+ *  12  samples
+ * n-2  CRC-16/CCITT-FALSE over bytes 0..n-3
+ *
+ * Each sample is the timestamp delta-of-delta followed by one delta per
+ * channel against the previous sample, all zig-zag mapped and varint
+ * packed (7 bits per byte, low bits first). At a fixed rate the timestamp
+ * costs one byte; a channel moving by less than +/-64 LSB costs one byte
+ * instead of two. Prediction restarts in every block, so a block decodes
+ * without its predecessors and a damaged one only loses its own samples;
+ * imuLogFind() resynchronizes on the next magic.
+ *
+ * Channels are int16 words: IMULOG_MOTION6_CHANNELS for MPUgetMotion6()
+ * (ax ay az gx gy gz), IMULOG_DMP_CHANNELS for a DMP FIFO packet taken as
+ * big-endian words (imuLogPacketToWords()), so DMP logs stay lossless.
+ *
+ * Cost per sample is bounded: at most IMULOG_MAX_SAMPLE_BYTES(channels)
+ * bytes and one pass over the channels, no division.
+ */
+#include <stdint.h>
+
+#define IMULOG_MAGIC0               'I'
+#define IMULOG_MAGIC1               'L'
+#define IMULOG_VERSION              1
+#define IMULOG_HEADER_SIZE          12
+#define IMULOG_CRC_SIZE             2
+#define IMULOG_MAX_CHANNELS         21
+#define IMULOG_BLOCK_SIZE           512     // one SD sector
+#define IMULOG_MOTION6_CHANNELS     6
+#define IMULOG_DMP_CHANNELS         21      // 42 byte MotionApps 2.0 packet
+#define IMULOG_MAX_SAMPLE_BYTES(channels)   (5 + 3 * (channels))
+
+// 1: byte-wise CRC with a 512 byte table (hosts, large flash), 0: 32 byte table
+#ifndef IMULOG_CRC_TABLE
+#define IMULOG_CRC_TABLE            0
+#endif
+
+// imuLogAdd()/imuLogCheck()/imuLogDecode() return codes
+#define IMULOG_OK                   0
+#define IMULOG_FULL                 1       // sample does not fit, finish the block first
+#define IMULOG_BAD_MAGIC            2
+#define IMULOG_BAD_VERSION          3
+#define IMULOG_BAD_LENGTH           4       // truncated block or impossible header
+#define IMULOG_BAD_CRC              5
+#define IMULOG_BAD_DATA             6       // payload does not match the sample count
+
+typedef struct {
+        uint8_t *buffer;
+        uint16_t capacity;
+        uint16_t length;            // bytes used, header included
+        uint16_t count;
+        uint8_t channels;
+        uint32_t lastTime;
+        int32_t lastDelta;
+        int16_t last[IMULOG_MAX_CHANNELS];
+} ImuLogWriter;
+
+typedef struct {
+        uint8_t channels;
+        uint16_t count;
+        uint16_t length;            // whole block
+        uint32_t firstTime;
+} ImuLogBlock;
+
+#if IMULOG_CRC_TABLE
+// CRC-16/CCITT-FALSE a byte at a time, 512 bytes of table
+static const uint16_t imuLogCrcTable[256] = {
+		0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+		0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+		0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+		0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+		0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+		0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+		0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+		0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+		0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+		0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+		0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+		0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+		0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+		0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+		0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+		0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+		0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+		0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+		0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+		0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+		0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+		0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+		0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+		0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+		0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+		0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+		0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+		0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+		0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+		0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+		0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+		0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+};
+
+static uint16_t imuLogCrc16(const uint8_t *data, uint16_t length) {
+		uint16_t crc = 0xFFFF;
+		while (length--) crc = (crc << 8) ^ imuLogCrcTable[(crc >> 8) ^ *data++];
+		return crc;
+}
+#else
+// CRC-16/CCITT-FALSE a nibble at a time, 32 bytes of table
+static const uint16_t imuLogCrcNibble[16] = {
+		0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+		0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+static uint16_t imuLogCrc16(const uint8_t *data, uint16_t length) {
+		uint16_t crc = 0xFFFF;
+		while (length--) {
+			crc = (crc << 4) ^ imuLogCrcNibble[(crc >> 12) ^ (*data >> 4)];
+			crc = (crc << 4) ^ imuLogCrcNibble[(crc >> 12) ^ (*data++ & 0x0F)];
+		}
+		return crc;
+}
+#endif
+
+static uint8_t imuLogPutVarint(uint8_t *out, uint32_t value) {
+		uint8_t n = 0;
+		while (value >= 0x80) {
+			out[n++] = (uint8_t)(value | 0x80);
+			value >>= 7;
+		}
+		out[n++] = (uint8_t)value;
+		return n;
+}
+
+// returns the bytes consumed, 0 if the varint runs past end or over 5 bytes
+static uint8_t imuLogGetVarint(const uint8_t *in, const uint8_t *end, uint32_t *value) {
+		uint32_t v = 0;
+		uint8_t n = 0;
+		do {
+			if (in + n >= end || n == 5) return 0;
+			v |= (uint32_t)(in[n] & 0x7F) << (7 * n);
+		} while (in[n++] & 0x80);
+		*value = v;
+		return n;
+}
+
+static uint32_t imuLogZigZag(int32_t value) {
+		return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t imuLogUnZigZag(uint32_t value) {
+		return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+/** Start a new block.
+ * @param writer Writer state
+ * @param buffer Block buffer, e.g. IMULOG_BLOCK_SIZE bytes
+ * @param capacity Size of the buffer, at least header, CRC and one sample
+ * @param channels Words per sample, 1..IMULOG_MAX_CHANNELS
+ */
+static void imuLogBegin(ImuLogWriter *writer, uint8_t *buffer, uint16_t capacity, uint8_t channels) {
+		uint8_t i;
+		writer -> buffer = buffer;
+		writer -> capacity = capacity;
+		writer -> length = IMULOG_HEADER_SIZE;
+		writer -> count = 0;
+		writer -> channels = channels;
+		writer -> lastTime = 0;
+		writer -> lastDelta = 0;
+		for (i = 0; i < IMULOG_MAX_CHANNELS; i++) writer -> last[i] = 0;
+}
+
+/** Append a sample to the current block.
+ * @param writer Writer state
+ * @param time Timestamp, non-decreasing within a block
+ * @param words One value per channel
+ * @return IMULOG_OK, or IMULOG_FULL if the block has to be finished first
+ */
+static uint8_t imuLogAdd(ImuLogWriter *writer, uint32_t time, const int16_t *words) {
+		uint8_t *out = writer -> buffer + writer -> length;
+		int32_t delta;
+		uint8_t i;
+		if (writer -> length + IMULOG_MAX_SAMPLE_BYTES(writer -> channels) + IMULOG_CRC_SIZE > writer -> capacity || writer -> count == 0xFFFF) return IMULOG_FULL;
+		if (writer -> count == 0) {
+			writer -> lastTime = time;
+			writer -> buffer[8] = (uint8_t)time;
+			writer -> buffer[9] = (uint8_t)(time >> 8);
+			writer -> buffer[10] = (uint8_t)(time >> 16);
+			writer -> buffer[11] = (uint8_t)(time >> 24);
+		}
+		delta = (int32_t)(time - writer -> lastTime);
+		out += imuLogPutVarint(out, imuLogZigZag((int32_t)((uint32_t)delta - (uint32_t)writer -> lastDelta)));
+		writer -> lastTime = time;
+		writer -> lastDelta = delta;
+		for (i = 0; i < writer -> channels; i++) {
+			out += imuLogPutVarint(out, imuLogZigZag((int32_t)words[i] - writer -> last[i]));
+			writer -> last[i] = words[i];
+		}
+		writer -> length = (uint16_t)(out - writer -> buffer);
+		writer -> count++;
+		return IMULOG_OK;
+}
+
+/** Close the current block: header and CRC.
+ * @param writer Writer state
+ * @return Block length to write out, 0 if the block is empty
+ */
+static uint16_t imuLogFinish(ImuLogWriter *writer) {
+		uint8_t *b = writer -> buffer;
+		uint16_t length = writer -> length + IMULOG_CRC_SIZE, crc;
+		if (writer -> count == 0) return 0;
+		b[0] = IMULOG_MAGIC0;
+		b[1] = IMULOG_MAGIC1;
+		b[2] = IMULOG_VERSION;
+		b[3] = writer -> channels;
+		b[4] = (uint8_t)writer -> count;
+		b[5] = (uint8_t)(writer -> count >> 8);
+		b[6] = (uint8_t)length;
+		b[7] = (uint8_t)(length >> 8);
+		crc = imuLogCrc16(b, writer -> length);
+		b[writer -> length] = (uint8_t)crc;
+		b[writer -> length + 1] = (uint8_t)(crc >> 8);
+		return length;
+}
+
+/** Verify a block header and CRC.
+ * @param in Block start
+ * @param available Bytes available from in
+ * @param block Output, header fields
+ * @return IMULOG_OK or one of the IMULOG_* error codes
+ */
+static uint8_t imuLogCheck(const uint8_t *in, uint32_t available, ImuLogBlock *block) {
+		uint16_t crc;
+		if (available < 2 || in[0] != IMULOG_MAGIC0 || in[1] != IMULOG_MAGIC1) return IMULOG_BAD_MAGIC;
+		if (available < IMULOG_HEADER_SIZE + IMULOG_CRC_SIZE) return IMULOG_BAD_LENGTH;
+		if (in[2] == 0 || in[2] > IMULOG_VERSION) return IMULOG_BAD_VERSION;
+		block -> channels = in[3];
+		block -> count = (uint16_t)(in[4] | (in[5] << 8));
+		block -> length = (uint16_t)(in[6] | (in[7] << 8));
+		block -> firstTime = (uint32_t)in[8] | ((uint32_t)in[9] << 8) | ((uint32_t)in[10] << 16) | ((uint32_t)in[11] << 24);
+		if (block -> channels == 0 || block -> channels > IMULOG_MAX_CHANNELS || block -> count == 0) return IMULOG_BAD_LENGTH;
+		if (block -> length < IMULOG_HEADER_SIZE + IMULOG_CRC_SIZE || block -> length > available) return IMULOG_BAD_LENGTH;
+		crc = imuLogCrc16(in, block -> length - IMULOG_CRC_SIZE);
+		if (in[block -> length - 2] != (uint8_t)crc || in[block -> length - 1] != (uint8_t)(crc >> 8)) return IMULOG_BAD_CRC;
+		return IMULOG_OK;
+}
+
+/** Decode all samples of a checked block.
+ * @param in Block start, verified with imuLogCheck()
+ * @param block Header from imuLogCheck()
+ * @param times Output, block -> count timestamps (may be 0)
+ * @param words Output, block -> count * block -> channels values, sample-major
+ * @return IMULOG_OK or IMULOG_BAD_DATA
+ */
+static uint8_t imuLogDecode(const uint8_t *in, const ImuLogBlock *block, uint32_t *times, int16_t *words) {
+		const uint8_t *p = in + IMULOG_HEADER_SIZE, *end = in + block -> length - IMULOG_CRC_SIZE;
+		int16_t last[IMULOG_MAX_CHANNELS];
+		uint32_t time = block -> firstTime, delta = 0, value;
+		uint16_t s;
+		uint8_t c, n;
+		for (c = 0; c < block -> channels; c++) last[c] = 0;
+		for (s = 0; s < block -> count; s++) {
+			if ((n = imuLogGetVarint(p, end, &value)) == 0) return IMULOG_BAD_DATA;
+			p += n;
+			delta += (uint32_t)imuLogUnZigZag(value);
+			time += delta;
+			if (times != 0) times[s] = time;
+			for (c = 0; c < block -> channels; c++) {
+				if ((n = imuLogGetVarint(p, end, &value)) == 0) return IMULOG_BAD_DATA;
+				p += n;
+				last[c] = (int16_t)(last[c] + imuLogUnZigZag(value));
+				*words++ = last[c];
+			}
+		}
+		return (p == end) ? IMULOG_OK : IMULOG_BAD_DATA;
+}
+
+/** Find the next position that starts a valid block.
+ * @param in Data
+ * @param available Bytes in data
+ * @return Offset of the next valid block, available if there is none
+ */
+static uint32_t imuLogFind(const uint8_t *in, uint32_t available) {
+		ImuLogBlock block;
+		uint32_t i;
+		for (i = 0; i + 1 < available; i++) {
+			if (in[i] == IMULOG_MAGIC0 && in[i + 1] == IMULOG_MAGIC1 && imuLogCheck(in + i, available - i, &block) == IMULOG_OK) return i;
+		}
+		return available;
+}
+
+/** Split a FIFO packet into big-endian words for logging.
+ * @param packet Packet, 2 * count bytes
+ * @param words Output
+ * @param count Words, IMULOG_DMP_CHANNELS for a MotionApps 2.0 packet
+ */
+static void imuLogPacketToWords(const uint8_t *packet, int16_t *words, uint8_t count) {
+		uint8_t i;
+		for (i = 0; i < count; i++) words[i] = (int16_t)((packet[2 * i] << 8) | packet[2 * i + 1]);
+}
+
+/** Rebuild a FIFO packet from logged words, e.g. for MPUdmpGetQuaternion().
+ * @param words Logged words
+ * @param packet Output, 2 * count bytes
+ * @param count Words
+ */
+static void imuLogWordsToPacket(const int16_t *words, uint8_t *packet, uint8_t count) {
+		uint8_t i;
+		for (i = 0; i < count; i++) {
+			packet[2 * i] = (uint8_t)((uint16_t)words[i] >> 8);
+			packet[2 * i + 1] = (uint8_t)words[i];
+		}
+}
+
+#endif /* _HELPER_IMULOG_H_ */
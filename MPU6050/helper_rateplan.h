@@ -0,0 +1,188 @@
+// I2C device class (I2Cdev) MPU6050 class, sample-rate planner
+// Picks SMPLRT_DIV, DLPF and a FIFO drain period for a rate/bandwidth/latency target
+//
+// Changelog:
+//     2026-10-18 - initial release
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 I2C device class, sample-rate planner code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#ifndef _HELPER_RATEPLAN_H_
+#define _HELPER_RATEPLAN_H_
+
+/* Only <stdint.h>, no ChibiOS dependency, so tools/rateplan.c can validate a
+ * configuration on the host with the code the MCU runs.
+ *
+ * Sample rate = gyro output rate / (1 + SMPLRT_DIV), and the gyro output rate
+ * is 8kHz with the DLPF off (DLPF_CFG 0) and 1kHz otherwise. Every DLPF
+ * setting trades bandwidth for group delay:
+ *
+ *   DLPF_CFG  gyro BW  gyro delay  accel BW  accel delay
+ *   0         256Hz    0.98ms      260Hz     0ms         (accel still 1kHz)
+ *   1         188Hz    1.9ms       184Hz     2.0ms
+ *   2          98Hz    2.8ms        94Hz     3.0ms
+ *   3          42Hz    4.8ms        44Hz     4.9ms
+ *   4          20Hz    8.3ms        21Hz     8.5ms
+ *   5          10Hz   13.4ms        10Hz    13.8ms
+ *   6           5Hz   18.6ms         5Hz    19.0ms
+ *
+ * rateplanSolve() picks, in this order: a DLPF with at least the requested
+ * bandwidth, the divider that gets closest to the target rate, the narrowest
+ * such DLPF (least noise and aliasing), and then the largest FIFO batch
+ * (watermark) whose worst case latency - filter delay + batch period + bus
+ * transfer - still fits the budget. Fewer, larger drains cost less bus time.
+ *
+ * Bus model: each drain is one FIFO_COUNT read plus reads of at most
+ * RATEPLAN_MAX_READ bytes (I2CDEV_BUFFER_LENGTH) in whole packets; a read of
+ * n bytes is START, address, register, repeated START, address, n bytes and
+ * STOP, 9 clocks per byte.
+ *
+ * Apply a plan with MPUsetDLPFMode(plan.dlpf) and MPUsetRate(plan.divider),
+ * then drain the FIFO every plan.drainPeriodUs or at plan.watermark packets.
+ */
+#include <stdint.h>
+
+#define RATEPLAN_DLPF_COUNT     7
+#define RATEPLAN_FIFO_SIZE      1024
+#define RATEPLAN_FIFO_HEADROOM  2       // drain at most 1/2 of the FIFO at once
+#define RATEPLAN_MAX_READ       64      // I2CDEV_BUFFER_LENGTH
+#define RATEPLAN_BUS_LIMIT      0.5f    // utilization above this is reported
+
+// rateplanSolve() return codes
+#define RATEPLAN_OK             0
+#define RATEPLAN_BAD_ARGUMENT   1       // zero rate, packet size or bus clock
+#define RATEPLAN_NO_BANDWIDTH   2       // more bandwidth than the DLPF passes
+#define RATEPLAN_LATENCY        3       // not even single-packet drains fit the budget
+#define RATEPLAN_BUS_OVERLOAD   4       // plan found, but above RATEPLAN_BUS_LIMIT
+
+// RatePlan flags
+#define RATEPLAN_ACCEL_REPEATS  0x01    // rate above 1kHz, accel samples are repeated
+#define RATEPLAN_ALIASING       0x02    // DLPF bandwidth above half the sample rate
+
+typedef struct {
+        uint32_t rateHz;            // target output rate
+        uint16_t bandwidthHz;       // signal bandwidth that must pass the DLPF
+        uint32_t maxLatencyUs;      // motion to host, worst case
+        uint8_t packetSize;         // bytes per FIFO sample, e.g. 12 for accel+gyro, 42 for DMP
+        uint32_t busHz;             // I2C clock
+} RatePlanRequest;
+
+typedef struct {
+        uint8_t dlpf;               // DLPF_CFG
+        uint8_t divider;            // SMPLRT_DIV
+        float rateHz;               // achieved output rate
+        uint16_t bandwidthHz;       // gyro bandwidth of the DLPF
+        uint32_t filterDelayUs;
+        uint16_t watermark;         // packets per drain
+        uint32_t drainPeriodUs;
+        uint32_t transferUs;        // bus time per drain
+        uint32_t latencyUs;         // worst case
+        float busUtilization;       // 0..1
+        uint8_t flags;              // RATEPLAN_ACCEL_REPEATS, RATEPLAN_ALIASING
+} RatePlan;
+
+static const uint16_t rateplanBandwidth[RATEPLAN_DLPF_COUNT] = { 256, 188, 98, 42, 20, 10, 5 };
+static const uint16_t rateplanDelayUs[RATEPLAN_DLPF_COUNT] = { 980, 2000, 3000, 4900, 8500, 13800, 19000 };
+
+/** Bus time of one register read.
+ * @param bytes Data bytes
+ * @param busHz I2C clock
+ * @return Microseconds
+ */
+static uint32_t rateplanReadUs(uint32_t bytes, uint32_t busHz) {
+		uint32_t clocks = 9 * (3 + bytes) + 3;
+		return (uint32_t)(((uint64_t)clocks * 1000000 + busHz - 1) / busHz);
+}
+
+/** Bus time to drain a batch: FIFO_COUNT plus the packets in whole-packet reads.
+ * @param packets Packets in the batch
+ * @param packetSize Bytes per packet
+ * @param busHz I2C clock
+ * @return Microseconds
+ */
+static uint32_t rateplanDrainUs(uint16_t packets, uint8_t packetSize, uint32_t busHz) {
+		uint32_t perRead = RATEPLAN_MAX_READ / packetSize, us = rateplanReadUs(2, busHz);
+		if (perRead == 0) perRead = 1;
+		while (packets > 0) {
+			uint32_t n = (packets < perRead) ? packets : perRead;
+			us += rateplanReadUs(n * packetSize, busHz);
+			packets -= n;
+		}
+		return us;
+}
+
+/** Pick divider, DLPF and FIFO drain period for a target.
+ * @param request Target rate, bandwidth, latency budget, packet size, bus clock
+ * @param plan Output, valid for RATEPLAN_OK and RATEPLAN_BUS_OVERLOAD
+ * @return RATEPLAN_OK or one of the RATEPLAN_* error codes
+ */
+static uint8_t rateplanSolve(const RatePlanRequest *request, RatePlan *plan) {
+		uint32_t base, divider, bestError = 0xFFFFFFFF, error, maxPackets, period;
+		uint16_t packets;
+		int8_t cfg, best = -1;
+		float rate;
+
+		if (request -> rateHz == 0 || request -> packetSize == 0 || request -> busHz == 0) return RATEPLAN_BAD_ARGUMENT;
+		if (request -> bandwidthHz > rateplanBandwidth[0]) return RATEPLAN_NO_BANDWIDTH;
+
+		// narrowest passing DLPF first, so ties in rate error keep the narrower one
+		for (cfg = RATEPLAN_DLPF_COUNT - 1; cfg >= 0; cfg--) {
+			if (rateplanBandwidth[cfg] < request -> bandwidthHz) continue;
+			base = cfg ? 1000 : 8000;
+			divider = (base + request -> rateHz / 2) / request -> rateHz;
+			divider = (divider < 1) ? 0 : (divider > 256) ? 255 : divider - 1;
+			rate = (float)base / (1 + divider);
+			error = (uint32_t)(((rate > request -> rateHz) ? rate - request -> rateHz : request -> rateHz - rate) * 1000.0f);
+			if (error < bestError) {
+				bestError = error;
+				best = cfg;
+				plan -> divider = (uint8_t)divider;
+				plan -> rateHz = rate;
+			}
+		}
+		plan -> dlpf = (uint8_t)best;
+		plan -> bandwidthHz = rateplanBandwidth[best];
+		plan -> filterDelayUs = rateplanDelayUs[best];
+		plan -> flags = 0;
+		if (plan -> rateHz > 1000.0f) plan -> flags |= RATEPLAN_ACCEL_REPEATS;
+		if (plan -> bandwidthHz * 2.0f > plan -> rateHz) plan -> flags |= RATEPLAN_ALIASING;
+
+		// largest batch that meets the latency budget: the oldest sample waits
+		// one batch period, then the whole batch crosses the bus
+		maxPackets = RATEPLAN_FIFO_SIZE / RATEPLAN_FIFO_HEADROOM / request -> packetSize;
+		if (maxPackets == 0) maxPackets = 1;
+		for (packets = (uint16_t)maxPackets; packets > 0; packets--) {
+			period = (uint32_t)(packets * 1000000.0f / plan -> rateHz + 0.5f);
+			plan -> transferUs = rateplanDrainUs(packets, request -> packetSize, request -> busHz);
+			plan -> latencyUs = plan -> filterDelayUs + period + plan -> transferUs;
+			if (plan -> latencyUs <= request -> maxLatencyUs) break;
+		}
+		if (packets == 0) return RATEPLAN_LATENCY;
+		plan -> watermark = packets;
+		plan -> drainPeriodUs = period;
+		plan -> busUtilization = (float)plan -> transferUs / period;
+		return (plan -> busUtilization > RATEPLAN_BUS_LIMIT) ? RATEPLAN_BUS_OVERLOAD : RATEPLAN_OK;
+}
+
+#endif /* _HELPER_RATEPLAN_H_ */
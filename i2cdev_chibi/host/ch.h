@@ -0,0 +1,99 @@
+// I2Cdev library collection - host build shim, ChibiOS kernel
+// Types and virtual clock for running the drivers on a PC
+//
+// Changelog:
+//     2026-10-18 - initial release
+
+/* ============================================
+ChibiOS I2Cdev host build shims are placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#ifndef _HOST_CH_H_
+#define _HOST_CH_H_
+
+/* Time is virtual and owned by the bus backend (chhost.c): the replay
+ * advances it by the recorded deltas, the simulator by the modelled bus
+ * time. Sleeping advances it only if the backend asks for that, so a run
+ * is as fast as the host allows and identical every time. There is only
+ * one thread; locks and semaphores never block, and created threads never
+ * run (drain their work by polling). */
+#include <stdint.h>
+#include <stddef.h>
+
+typedef int32_t bool_t;
+typedef int32_t msg_t;
+typedef uint32_t systime_t;
+
+#define TRUE                    1
+#define FALSE                   0
+
+#define RDY_OK                  0
+#define RDY_TIMEOUT             -1
+#define RDY_RESET               -2
+
+#define CH_FREQUENCY            1000
+#define TIME_IMMEDIATE          ((systime_t)0)
+#define TIME_INFINITE           ((systime_t)-1)
+#define S2ST(sec)               ((systime_t)((sec) * CH_FREQUENCY))
+#define MS2ST(msec)             ((systime_t)(((((uint32_t)(msec)) * ((uint64_t)CH_FREQUENCY) - 1UL) / 1000UL) + 1UL))
+
+typedef struct {
+        int locked;
+} Mutex;
+#define _MUTEX_DATA(name)       { 0 }
+#define MUTEX_DECL(name)        Mutex name = _MUTEX_DATA(name)
+
+typedef struct {
+        int taken;
+} BinarySemaphore;
+#define _BSEMAPHORE_DATA(name, taken)   { taken }
+#define BSEMAPHORE_DECL(name, taken)    BinarySemaphore name = _BSEMAPHORE_DATA(name, taken)
+
+typedef int32_t tprio_t;
+typedef msg_t (*tfunc_t)(void *);
+typedef struct Thread Thread;
+#define LOWPRIO                 1
+#define NORMALPRIO              64
+#define WORKING_AREA(s, n)      uint8_t s[n]
+
+systime_t chTimeNow(void);
+void chThdSleepMilliseconds(uint32_t msec);
+void chMtxLock(Mutex *mp);
+Mutex *chMtxUnlock(void);
+msg_t chBSemWaitTimeout(BinarySemaphore *bsp, systime_t time);
+void chBSemSignalI(BinarySemaphore *bsp);
+Thread *chThdCreateStatic(void *wsp, size_t size, tprio_t prio, tfunc_t pf, void *arg);
+#define chRegSetThreadName(name)
+#define chSysLock()
+#define chSysUnlock()
+#define chSysLockFromIsr()
+#define chSysUnlockFromIsr()
+
+// host only, for the bus backends
+void chHostReset(bool_t sleepAdvances);
+void chHostAdvance(uint64_t ns);
+uint64_t chHostTimeNs(void);
+uint32_t chHostSleptMs(void);
+void chHostSetReleaseHook(void (*hook)(void));
+
+#endif /* _HOST_CH_H_ */
@@ -0,0 +1,148 @@
+// I2Cdev library collection - host build shim, kernel functions
+// Virtual clock, no-op locking and bus ownership for host builds
+//
+// Changelog:
+//     2026-10-18 - initial release
+//     2026-10-18 - bus release hook, i2cGetErrors() reports the backend's flags
+
+/* ============================================
+ChibiOS I2Cdev host build shims are placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "chprintf.h"
+
+I2CDriver I2CD1;
+BaseChannel SD2;
+
+static uint64_t hostNs = 0;
+static uint32_t hostSlept = 0;
+static bool_t hostSleepAdvances = FALSE;
+static void (*hostReleaseHook)(void) = NULL;
+
+/** Restart the virtual clock.
+ * @param sleepAdvances TRUE if chThdSleepMilliseconds() moves the clock
+ */
+void chHostReset(bool_t sleepAdvances) {
+    hostNs = 0;
+    hostSlept = 0;
+    hostSleepAdvances = sleepAdvances;
+}
+
+/** Move the virtual clock forward.
+ * @param ns Nanoseconds
+ */
+void chHostAdvance(uint64_t ns) {
+    hostNs += ns;
+}
+
+/** Get the virtual clock.
+ * @return Nanoseconds since chHostReset()
+ */
+uint64_t chHostTimeNs() {
+    return hostNs;
+}
+
+/** Get the time requested through chThdSleepMilliseconds().
+ * @return Milliseconds since chHostReset()
+ */
+uint32_t chHostSleptMs() {
+    return hostSlept;
+}
+
+systime_t chTimeNow() {
+    return (systime_t)(hostNs / (1000000000 / CH_FREQUENCY));
+}
+
+void chThdSleepMilliseconds(uint32_t msec) {
+    hostSlept += msec;
+    if (hostSleepAdvances) hostNs += (uint64_t)msec * 1000000;
+}
+
+void i2cAcquireBus(I2CDriver *i2cp) {
+    (void)i2cp;
+}
+
+/** Run a function whenever the bus is released, standing in for a thread
+ * that waited for it.
+ * @param hook Function, NULL for none
+ */
+void chHostSetReleaseHook(void (*hook)(void)) {
+    hostReleaseHook = hook;
+}
+
+void i2cReleaseBus(I2CDriver *i2cp) {
+    (void)i2cp;
+    if (hostReleaseHook) hostReleaseHook();
+}
+
+i2cflags_t i2cGetErrors(I2CDriver *i2cp) {
+    return i2cp -> errors;
+}
+
+// host cycle counter stand-in, nanoseconds
+uint32_t halGetCounterValue() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+Thread *chThdCreateStatic(void *wsp, size_t size, tprio_t prio, tfunc_t pf, void *arg) {
+    (void)wsp;
+    (void)size;
+    (void)prio;
+    (void)pf;
+    (void)arg;
+    return 0;
+}
+
+void chMtxLock(Mutex *mp) {
+    mp -> locked = 1;
+}
+
+Mutex *chMtxUnlock() {
+    return 0;
+}
+
+msg_t chBSemWaitTimeout(BinarySemaphore *bsp, systime_t time) {
+    (void)time;
+    bsp -> taken = 1;
+    return RDY_OK;
+}
+
+void chBSemSignalI(BinarySemaphore *bsp) {
+    bsp -> taken = 0;
+}
+
+void chprintf(BaseChannel *chp, const char *fmt, ...) {
+    va_list ap;
+    (void)chp;
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+}
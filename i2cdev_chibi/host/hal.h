@@ -0,0 +1,61 @@
+// I2Cdev library collection - host build shim, ChibiOS HAL
+// I2C driver declarations for running the drivers on a PC
+//
+// Changelog:
+//     2026-10-18 - initial release
+//     2026-10-18 - I2CDriver carries the error flags of the last transfer
+
+/* ============================================
+ChibiOS I2Cdev host build shims are placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#ifndef _HOST_HAL_H_
+#define _HOST_HAL_H_
+
+#include "ch.h"
+
+typedef uint8_t i2caddr_t;
+typedef uint32_t i2cflags_t;
+
+#define I2CD_ACK_FAILURE        0x04
+
+typedef struct {
+        i2cflags_t errors;              // set by the bus backend, read by i2cGetErrors()
+} I2CDriver;
+
+typedef struct {
+        int dummy;
+} BaseChannel;
+
+extern I2CDriver I2CD1;
+extern BaseChannel SD2;
+
+void i2cAcquireBus(I2CDriver *i2cp);
+void i2cReleaseBus(I2CDriver *i2cp);
+msg_t i2cMasterTransmitTimeout(I2CDriver *i2cp, i2caddr_t addr, const uint8_t *txbuf, size_t txbytes, uint8_t *rxbuf, size_t rxbytes, systime_t timeout);
+#define i2cMasterTransmit(i2cp, addr, txbuf, txbytes, rxbuf, rxbytes) \
+        i2cMasterTransmitTimeout(i2cp, addr, txbuf, txbytes, rxbuf, rxbytes, TIME_INFINITE)
+i2cflags_t i2cGetErrors(I2CDriver *i2cp);
+uint32_t halGetCounterValue(void);
+
+#endif /* _HOST_HAL_H_ */
@@ -0,0 +1,129 @@
+// I2Cdev library collection - several MPU6050 FIFOs with frame sync
+// FIFO model for the sync group and voting checks
+//
+// Changelog:
+//     2026-10-18 - initial release
+
+/* ============================================
+ChibiOS I2Cdev FSYNC bus code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "i2cdev_fsync.h"
+#include "MPU6050.h"
+#include "MPU6050_Sync.h"
+
+I2CfsyncDevice I2CfsyncDevices[I2CFSYNC_DEVICES];
+
+static I2CfsyncDevice *fsyncDevice(uint8_t addr) {
+    if (addr < MPU6050_DEFAULT_ADDRESS || addr >= MPU6050_DEFAULT_ADDRESS + I2CFSYNC_DEVICES) return NULL;
+    return &I2CfsyncDevices[addr - MPU6050_DEFAULT_ADDRESS];
+}
+
+static uint8_t fsyncRead(I2CfsyncDevice *d, uint8_t reg) {
+    uint8_t value;
+    switch (reg) {
+        case MPU6050_RA_FIFO_COUNTH: return d -> count >> 8;
+        case MPU6050_RA_FIFO_COUNTL: return d -> count & 0xFF;
+        case MPU6050_RA_FIFO_R_W:
+            if (d -> count == 0) return 0;
+            value = d -> fifo[d -> head];
+            d -> head = (d -> head + 1) % I2CFSYNC_FIFO_SIZE;
+            d -> count--;
+            return value;
+        default: return d -> reg[reg & 0x7F];
+    }
+}
+
+static void fsyncWrite(I2CfsyncDevice *d, uint8_t reg, uint8_t value) {
+    if (reg == MPU6050_RA_USER_CTRL && (value & (1 << MPU6050_USERCTRL_FIFO_RESET_BIT))) {
+        d -> head = d -> count = 0;
+        value &= ~(1 << MPU6050_USERCTRL_FIFO_RESET_BIT);
+    }
+    d -> reg[reg & 0x7F] = value;
+}
+
+msg_t i2cMasterTransmitTimeout(I2CDriver *i2cp, i2caddr_t addr, const uint8_t *txbuf, size_t txbytes, uint8_t *rxbuf, size_t rxbytes, systime_t timeout) {
+    I2CfsyncDevice *d = fsyncDevice(addr);
+    uint8_t reg = txbuf[0];
+    size_t i;
+    (void)timeout;
+
+    if (d == NULL || d -> dead) {
+        i2cp -> errors = I2CD_ACK_FAILURE;
+        return RDY_RESET;
+    }
+    i2cp -> errors = 0;
+    if (rxbytes > 0) {
+        for (i = 0; i < rxbytes; i++) {
+            rxbuf[i] = fsyncRead(d, reg);
+            if (reg != MPU6050_RA_FIFO_R_W) reg++;
+        }
+    } else {
+        for (i = 1; i < txbytes; i++) fsyncWrite(d, reg++, txbuf[i]);
+    }
+    return RDY_OK;
+}
+
+/** Clear every device: empty FIFOs, registers 0 except WHO_AM_I, all answering.
+ */
+void I2CfsyncStart(void) {
+    uint8_t dev;
+    memset(I2CfsyncDevices, 0, sizeof(I2CfsyncDevices));
+    for (dev = 0; dev < I2CFSYNC_DEVICES; dev++) I2CfsyncDevices[dev].reg[MPU6050_RA_WHO_AM_I] = 0x68;
+}
+
+/** Append one FIFO record: accel x = tick, accel y = device, FSYNC flag in
+ * TEMP_OUT_L bit 0. A full FIFO loses the rest, the count stays at 1024.
+ * @param dev Device index
+ * @param mark Set the FSYNC flag
+ */
+void I2CfsyncPush(uint8_t dev, uint8_t mark) {
+    I2CfsyncDevice *d = &I2CfsyncDevices[dev];
+    uint8_t record[MPU6050_SYNC_SAMPLE_SIZE];
+    uint8_t i;
+
+    memset(record, 0, sizeof(record));
+    record[0] = d -> tick >> 8;
+    record[1] = d -> tick & 0xFF;
+    record[3] = dev;
+    record[6] = 0x12;
+    record[7] = 0x34 | (mark ? 1 : 0);
+    d -> tick++;
+    for (i = 0; i < sizeof(record); i++) {
+        if (d -> count == I2CFSYNC_FIFO_SIZE) return;
+        d -> fifo[(d -> head + d -> count) % I2CFSYNC_FIFO_SIZE] = record[i];
+        d -> count++;
+    }
+}
+
+/** One sample clock tick on every device, optionally strobed.
+ * @param strobe Set the FSYNC flag everywhere
+ */
+void I2CfsyncTick(uint8_t strobe) {
+    uint8_t dev;
+    for (dev = 0; dev < I2CFSYNC_DEVICES; dev++) I2CfsyncPush(dev, strobe);
+}
@@ -0,0 +1,62 @@
+// I2Cdev library collection - several MPU6050 FIFOs with frame sync
+// FIFO model for the sync group and voting checks
+//
+// Changelog:
+//     2026-10-18 - initial release
+
+/* ============================================
+ChibiOS I2Cdev FSYNC bus code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#ifndef _I2CDEV_FSYNC_H_
+#define _I2CDEV_FSYNC_H_
+
+/* Link chhost.c and i2cdev_fsync.c (instead of i2cdev_sim.c) to run sync
+ * groups on the host: I2CFSYNC_DEVICES MPU6050s from
+ * MPU6050_DEFAULT_ADDRESS up, each with a 128 byte register file and a
+ * 1024 byte FIFO. The FIFOs only fill through I2CfsyncPush() and
+ * I2CfsyncTick(); FIFO_RESET in USER_CTRL empties one. Every record
+ * carries the tick it was sampled at and the device index, so alignment
+ * is checked directly. A dead device NACKs everything with
+ * I2CD_ACK_FAILURE in i2cGetErrors().
+ */
+#include "ch.h"
+
+#define I2CFSYNC_DEVICES        3
+#define I2CFSYNC_FIFO_SIZE      1024
+
+typedef struct {
+        uint8_t reg[128];
+        uint8_t fifo[I2CFSYNC_FIFO_SIZE];
+        uint16_t head, count;
+        uint8_t dead;                   // NACK everything
+        uint16_t tick;                  // label of the next record
+} I2CfsyncDevice;
+
+extern I2CfsyncDevice I2CfsyncDevices[I2CFSYNC_DEVICES];
+
+void I2CfsyncStart(void);
+void I2CfsyncPush(uint8_t dev, uint8_t mark);
+void I2CfsyncTick(uint8_t strobe);
+
+#endif /* _I2CDEV_FSYNC_H_ */
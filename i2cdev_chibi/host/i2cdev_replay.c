@@ -0,0 +1,120 @@
+// I2Cdev library collection - trace replay backend
+// Feeds a recorded trace back as the I2C bus on the host
+//
+// Changelog:
+//     2026-10-18 - initial release
+
+/* ============================================
+ChibiOS I2Cdev trace replay code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "i2cdev_replay.h"
+
+static const uint8_t *replayData = 0;
+static uint32_t replayLength = 0, replayPos = 0, replayIndex = 0;
+static uint32_t replayWriteMismatches = 0;
+static uint8_t replayStatus = I2CREPLAY_END;
+static I2CdevTraceRecord replayExpected, replayActual;
+
+/** Serve the following transfers from a trace.
+ * @param trace Records as dumped by I2CdevtraceDump(), must stay valid
+ * @param length Bytes in the trace
+ */
+void I2CreplayStart(const uint8_t *trace, uint32_t length) {
+    replayData = trace;
+    replayLength = length;
+    replayPos = replayIndex = replayWriteMismatches = 0;
+    chHostReset(FALSE);
+    replayStatus = (length > 0) ? I2CREPLAY_RUNNING : I2CREPLAY_END;
+    memset(&replayExpected, 0, sizeof(replayExpected));
+    memset(&replayActual, 0, sizeof(replayActual));
+}
+
+/** Get the replay state.
+ * @return I2CREPLAY_RUNNING, _END or _DIVERGED
+ */
+uint8_t I2CreplayGetStatus() {
+    return replayStatus;
+}
+
+/** Get the number of records consumed.
+ * @return Index of the next record
+ */
+uint32_t I2CreplayGetIndex() {
+    return replayIndex;
+}
+
+/** Get the number of writes whose payload differed from the trace.
+ * @return Mismatching writes
+ */
+uint32_t I2CreplayGetWriteMismatches() {
+    return replayWriteMismatches;
+}
+
+/** Get the record that did not match and the transfer that was attempted.
+ * @param expected Output, next record of the trace (payload into the trace)
+ * @param actual Output, the transfer (payload NULL)
+ */
+void I2CreplayGetDivergence(I2CdevTraceRecord *expected, I2CdevTraceRecord *actual) {
+    *expected = replayExpected;
+    *actual = replayActual;
+}
+
+msg_t i2cMasterTransmitTimeout(I2CDriver *i2cp, i2caddr_t addr, const uint8_t *txbuf, size_t txbytes, uint8_t *rxbuf, size_t rxbytes, systime_t timeout) {
+    I2CdevTraceRecord record;
+    uint16_t size;
+    (void)i2cp;
+    (void)timeout;
+
+    if (replayStatus != I2CREPLAY_RUNNING) return RDY_RESET;
+    size = i2cdevTraceDecode(replayData + replayPos, replayLength - replayPos, &record);
+    if (size == 0) {
+        replayStatus = I2CREPLAY_END;
+        return RDY_RESET;
+    }
+
+    replayActual.devAddr = addr;
+    replayActual.read = (rxbytes > 0) ? 1 : 0;
+    replayActual.regAddr = txbuf[0];
+    replayActual.length = (uint8_t)(replayActual.read ? rxbytes : txbytes - 1);
+    replayActual.payload = 0;
+    if (record.devAddr != replayActual.devAddr || record.read != replayActual.read || record.regAddr != replayActual.regAddr || record.length != replayActual.length) {
+        replayExpected = record;
+        replayStatus = I2CREPLAY_DIVERGED;
+        return RDY_RESET;
+    }
+
+    chHostAdvance((uint64_t)record.delta * (1000000000 / CH_FREQUENCY));
+    if (record.read && record.payload) memcpy(rxbuf, record.payload, record.length);
+    if (!record.read && record.length > 0 && memcmp(record.payload, txbuf + 1, record.length) != 0) replayWriteMismatches++;
+    replayPos += size;
+    replayIndex++;
+    if (replayPos >= replayLength) replayStatus = I2CREPLAY_END;
+
+    if (record.result == I2CDEV_TRACE_OK) return RDY_OK;
+    return (record.result == I2CDEV_TRACE_TIMEOUT) ? RDY_TIMEOUT : RDY_RESET;
+}
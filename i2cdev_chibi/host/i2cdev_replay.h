@@ -0,0 +1,61 @@
+// I2Cdev library collection - trace replay backend
+// Feeds a recorded trace back as the I2C bus on the host
+//
+// Changelog:
+//     2026-10-18 - initial release
+
+/* ============================================
+ChibiOS I2Cdev trace replay code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#ifndef _I2CDEV_REPLAY_H_
+#define _I2CDEV_REPLAY_H_
+
+/* Build the drivers for the host with host/ first on the include path and
+ * link chhost.c and i2cdev_replay.c instead of ChibiOS; i2cdev_chibi.c and
+ * the device code compile unchanged. Each transfer consumes the next record:
+ *
+ *  - address, direction, register and length must match, otherwise the
+ *    replay stops (I2CREPLAY_DIVERGED) and every further transfer fails;
+ *  - reads return the recorded payload and result;
+ *  - writes are compared with the recorded payload; a difference is counted,
+ *    not fatal, so e.g. a changed calibration shows up without aborting.
+ *
+ * The code under test has to issue the same sequence as the recorded
+ * firmware, see tools/i2creplay.c.
+ */
+#include "ch.h"
+#include "i2cdev_trace.h"
+
+// I2CreplayGetStatus() values
+#define I2CREPLAY_RUNNING       0
+#define I2CREPLAY_END           1       // all records consumed, later transfers fail
+#define I2CREPLAY_DIVERGED      2       // transfer did not match the next record
+
+void I2CreplayStart(const uint8_t *trace, uint32_t length);
+uint8_t I2CreplayGetStatus(void);
+uint32_t I2CreplayGetIndex(void);
+uint32_t I2CreplayGetWriteMismatches(void);
+void I2CreplayGetDivergence(I2CdevTraceRecord *expected, I2CdevTraceRecord *actual);
+
+#endif /* _I2CDEV_REPLAY_H_ */
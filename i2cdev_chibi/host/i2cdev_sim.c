@@ -0,0 +1,257 @@
+// I2Cdev library collection - simulated MPU6050 bus backend
+// Register file, DMP memory and FIFO model with an I2C timing model
+//
+// Changelog:
+//     2026-10-18 - initial release
+//     2026-10-18 - NACK injection, per-transaction hook, ACK failures through i2cGetErrors()
+
+/* ============================================
+ChibiOS I2Cdev simulated bus code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "i2cdev_sim.h"
+#include "MPU6050.h"
+
+#define SIM_FIFO_SIZE           1024
+#define SIM_BANKS               32
+#define SIM_DMP_PACKET          42
+
+static I2CsimTiming simTiming = I2CSIM_TIMING_400K;
+static I2CsimStats simStats;
+static uint8_t simReg[128];
+static uint8_t simMem[SIM_BANKS][256];
+static uint8_t simFifo[SIM_FIFO_SIZE];
+static uint16_t simFifoHead, simFifoCount;
+static uint64_t simProduced;
+static uint16_t simNacks;
+static void (*simHook)(uint32_t transaction);
+static uint32_t simHookCount;
+
+static void simReset(void) {
+    memset(simReg, 0, sizeof(simReg));
+    simReg[MPU6050_RA_WHO_AM_I] = MPU6050_DEFAULT_ADDRESS;
+    simReg[MPU6050_RA_PWR_MGMT_1] = 1 << MPU6050_PWR1_SLEEP_BIT;
+    simReg[MPU6050_RA_ACCEL_ZOUT_H] = 0x40;     // 1g at +/-2g
+    simFifoHead = simFifoCount = 0;
+    simProduced = chHostTimeNs();
+}
+
+static void simPush(uint8_t value) {
+    if (simFifoCount == SIM_FIFO_SIZE) {
+        simReg[MPU6050_RA_INT_STATUS] |= 1 << MPU6050_INTERRUPT_FIFO_OFLOW_BIT;
+        return;
+    }
+    simFifo[(simFifoHead + simFifoCount) % SIM_FIFO_SIZE] = value;
+    simFifoCount++;
+}
+
+static uint8_t simPop(void) {
+    uint8_t value;
+    if (simFifoCount == 0) return 0;
+    value = simFifo[simFifoHead];
+    simFifoHead = (simFifoHead + 1) % SIM_FIFO_SIZE;
+    simFifoCount--;
+    return value;
+}
+
+static uint16_t simPacketSize(void) {
+    uint8_t en = simReg[MPU6050_RA_FIFO_EN];
+    uint16_t size = 0;
+    if (simReg[MPU6050_RA_USER_CTRL] & (1 << MPU6050_USERCTRL_DMP_EN_BIT)) return SIM_DMP_PACKET;
+    if (en & (1 << MPU6050_TEMP_FIFO_EN_BIT)) size += 2;
+    if (en & (1 << MPU6050_XG_FIFO_EN_BIT)) size += 2;
+    if (en & (1 << MPU6050_YG_FIFO_EN_BIT)) size += 2;
+    if (en & (1 << MPU6050_ZG_FIFO_EN_BIT)) size += 2;
+    if (en & (1 << MPU6050_ACCEL_FIFO_EN_BIT)) size += 6;
+    return size;
+}
+
+// add the samples taken since the last call
+static void simProduce(void) {
+    uint64_t now = chHostTimeNs(), period;
+    uint16_t size, i;
+    uint8_t dlpf = simReg[MPU6050_RA_CONFIG] & 0x07;
+
+    period = (uint64_t)(1 + simReg[MPU6050_RA_SMPLRT_DIV]) * ((dlpf == 0 || dlpf == 7) ? 125000 : 1000000);
+    size = simPacketSize();
+    if (!(simReg[MPU6050_RA_USER_CTRL] & (1 << MPU6050_USERCTRL_FIFO_EN_BIT)) || size == 0) {
+        simProduced = now;
+        return;
+    }
+    while (now - simProduced >= period) {
+        simProduced += period;
+        for (i = 0; i < size; i++) simPush((size == SIM_DMP_PACKET && i == 0) ? 0x40 : 0);
+        simReg[MPU6050_RA_INT_STATUS] |= (1 << MPU6050_INTERRUPT_DATA_RDY_BIT) | ((size == SIM_DMP_PACKET) ? 1 << MPU6050_INTERRUPT_DMP_INT_BIT : 0);
+    }
+}
+
+static void simWrite(uint8_t reg, uint8_t value) {
+    switch (reg) {
+        case MPU6050_RA_PWR_MGMT_1:
+            if (value & (1 << MPU6050_PWR1_DEVICE_RESET_BIT)) {
+                simReset();
+                return;
+            }
+            break;
+        case MPU6050_RA_USER_CTRL:
+            if (value & (1 << MPU6050_USERCTRL_FIFO_RESET_BIT)) simFifoHead = simFifoCount = 0;
+            value &= ~((1 << MPU6050_USERCTRL_FIFO_RESET_BIT) | (1 << MPU6050_USERCTRL_DMP_RESET_BIT) | (1 << MPU6050_USERCTRL_I2C_MST_RESET_BIT) | (1 << MPU6050_USERCTRL_SIG_COND_RESET_BIT));
+            break;
+        case MPU6050_RA_MEM_R_W:
+            simMem[simReg[MPU6050_RA_BANK_SEL] % SIM_BANKS][simReg[MPU6050_RA_MEM_START_ADDR]++] = value;
+            return;
+        case MPU6050_RA_FIFO_R_W:
+            simPush(value);
+            return;
+        case MPU6050_RA_WHO_AM_I:
+        case MPU6050_RA_INT_STATUS:
+            return;
+    }
+    simReg[reg] = value;
+}
+
+static uint8_t simRead(uint8_t reg) {
+    uint8_t value;
+    switch (reg) {
+        case MPU6050_RA_MEM_R_W:
+            return simMem[simReg[MPU6050_RA_BANK_SEL] % SIM_BANKS][simReg[MPU6050_RA_MEM_START_ADDR]++];
+        case MPU6050_RA_FIFO_R_W:
+            return simPop();
+        case MPU6050_RA_FIFO_COUNTH:
+            return (uint8_t)(simFifoCount >> 8);
+        case MPU6050_RA_FIFO_COUNTL:
+            return (uint8_t)(simFifoCount & 0xFF);
+        case MPU6050_RA_INT_STATUS:
+            value = simReg[reg];
+            simReg[reg] = 0;
+            return value;
+    }
+    return simReg[reg];
+}
+
+static void simAccount(size_t bytes, uint8_t conditions) {
+    uint64_t clocks = 9 * ((conditions == 3 ? 3 : 2) + bytes) + (uint64_t)conditions * simTiming.conditionClocks;
+    uint64_t ns = clocks * 1000000000 / simTiming.busHz + simTiming.stretchNs + (uint64_t)simTiming.stretchByteNs * bytes;
+    simStats.transactions++;
+    simStats.bytes += (uint32_t)bytes;
+    simStats.busNs += ns;
+    chHostAdvance(ns);
+}
+
+// address phase, FALSE if the device does not acknowledge
+static bool_t simAddress(I2CDriver *i2cp, i2caddr_t addr) {
+    if (addr != MPU6050_DEFAULT_ADDRESS || simNacks > 0) {
+        if (addr == MPU6050_DEFAULT_ADDRESS) simNacks--;
+        simStats.failed++;
+        i2cp -> errors = I2CD_ACK_FAILURE;
+        return FALSE;
+    }
+    i2cp -> errors = 0;
+    return TRUE;
+}
+
+/** Power-on reset the simulated device and restart the virtual clock.
+ * @param timing Bus timing model
+ */
+void I2CsimStart(const I2CsimTiming *timing) {
+    chHostReset(TRUE);
+    simTiming = *timing;
+    memset(simMem, 0, sizeof(simMem));
+    simReset();
+    simNacks = 0;
+    simHook = NULL;
+    I2CsimResetStats();
+}
+
+/** Change the bus timing model, the device keeps its state.
+ * @param timing Bus timing model
+ */
+void I2CsimSetTiming(const I2CsimTiming *timing) {
+    simTiming = *timing;
+}
+
+/** Get the bus counters.
+ * @param stats Output
+ */
+void I2CsimGetStats(I2CsimStats *stats) {
+    *stats = simStats;
+}
+
+/** Clear the bus counters. */
+void I2CsimResetStats() {
+    memset(&simStats, 0, sizeof(simStats));
+}
+
+/** Put bytes into the FIFO directly, e.g. a backlog for a drain benchmark.
+ * DMP packets carry an identity quaternion.
+ * @param bytes Number of bytes
+ */
+void I2CsimFillFIFO(uint16_t bytes) {
+    uint16_t i;
+    for (i = 0; i < bytes; i++) simPush((i % SIM_DMP_PACKET == 0) ? 0x40 : 0);
+}
+
+/** NACK the next transactions at the address, e.g. a write cycle.
+ * @param transactions Number of transactions, 0 to stop
+ */
+void I2CsimNack(uint16_t transactions) {
+    simNacks = transactions;
+}
+
+/** Run a function before every transaction.
+ * @param hook Function, called with the transactions since it was set; NULL for none
+ */
+void I2CsimSetHook(void (*hook)(uint32_t transaction)) {
+    simHook = hook;
+    simHookCount = 0;
+}
+
+msg_t i2cMasterTransmitTimeout(I2CDriver *i2cp, i2caddr_t addr, const uint8_t *txbuf, size_t txbytes, uint8_t *rxbuf, size_t rxbytes, systime_t timeout) {
+    uint8_t reg = txbuf[0];
+    size_t i;
+    (void)timeout;
+
+    if (simHook) simHook(simHookCount++);
+    simProduce();
+    if (rxbytes > 0) {
+        simAccount(rxbytes, 3);
+        if (!simAddress(i2cp, addr)) return RDY_RESET;
+        for (i = 0; i < rxbytes; i++) {
+            rxbuf[i] = simRead(reg);
+            // FIFO_R_W and MEM_R_W do not advance the register pointer
+            if (reg != MPU6050_RA_FIFO_R_W && reg != MPU6050_RA_MEM_R_W) reg++;
+        }
+    } else {
+        simAccount(txbytes - 1, 2);
+        if (!simAddress(i2cp, addr)) return RDY_RESET;
+        for (i = 1; i < txbytes; i++) {
+            simWrite(reg, txbuf[i]);
+            if (reg != MPU6050_RA_FIFO_R_W && reg != MPU6050_RA_MEM_R_W) reg++;
+        }
+    }
+    return RDY_OK;
+}
@@ -0,0 +1,88 @@
+// I2Cdev library collection - simulated MPU6050 bus backend
+// Register file, DMP memory and FIFO model with an I2C timing model
+//
+// Changelog:
+//     2026-10-18 - initial release
+//     2026-10-18 - NACK injection, per-transaction hook, ACK failures through i2cGetErrors()
+
+/* ============================================
+ChibiOS I2Cdev simulated bus code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#ifndef _I2CDEV_SIM_H_
+#define _I2CDEV_SIM_H_
+
+/* Link chhost.c and i2cdev_sim.c (instead of i2cdev_replay.c) to run the
+ * drivers on the host against a simulated MPU6050 at MPU6050_DEFAULT_ADDRESS.
+ *
+ * Device model: 128 registers with auto-increment, power-on defaults and
+ * DEVICE_RESET, INT_STATUS clear-on-read, DMP memory banks through
+ * BANK_SEL/MEM_START_ADDR/MEM_R_W, and a 1024 byte FIFO that fills at the
+ * configured sample rate (42 byte DMP packets with an identity quaternion
+ * while the DMP runs, the FIFO_EN selection otherwise). Enough for
+ * MPUdmpInitialize(), the FIFO drain and the motion reads; it does not
+ * compute sensor values.
+ *
+ * Timing model, per transaction:
+ *
+ *   write: S addr reg data... P          9 clocks per byte, 2 conditions
+ *   read:  S addr reg Sr addr data... P  9 clocks per byte, 3 conditions
+ *
+ * plus conditionClocks per START/STOP (setup and hold, bus free time) and
+ * clock stretching per transaction and per data byte. The virtual clock
+ * (chTimeNow()) advances by the bus time and by every sleep.
+ *
+ * A NACKed transaction (wrong address, I2CsimNack()) returns RDY_RESET
+ * with I2CD_ACK_FAILURE in i2cGetErrors(), like a busy EEPROM does. The
+ * hook set with I2CsimSetHook() runs before every transaction, e.g. to
+ * let another class start waiting in the middle of a sliced transfer.
+ */
+#include "ch.h"
+
+typedef struct {
+        uint32_t busHz;                 // SCL
+        uint8_t conditionClocks;        // SCL periods per START, repeated START or STOP
+        uint32_t stretchNs;             // clock stretching per transaction
+        uint32_t stretchByteNs;         // clock stretching per data byte
+} I2CsimTiming;
+
+#define I2CSIM_TIMING_100K      { 100000, 1, 0, 0 }
+#define I2CSIM_TIMING_400K      { 400000, 1, 0, 0 }
+#define I2CSIM_TIMING_1M        { 1000000, 1, 0, 0 }
+
+typedef struct {
+        uint32_t transactions;
+        uint32_t bytes;                 // data bytes, without address and register
+        uint64_t busNs;
+        uint32_t failed;                // NACKed: wrong address or I2CsimNack()
+} I2CsimStats;
+
+void I2CsimStart(const I2CsimTiming *timing);
+void I2CsimSetTiming(const I2CsimTiming *timing);
+void I2CsimGetStats(I2CsimStats *stats);
+void I2CsimResetStats(void);
+void I2CsimFillFIFO(uint16_t bytes);
+void I2CsimNack(uint16_t transactions);
+void I2CsimSetHook(void (*hook)(uint32_t transaction));
+
+#endif /* _I2CDEV_SIM_H_ */
@@ -3,6 +3,11 @@
 // 6/9/2012 by Jeff Rowberg <jeff@rowberg.net>
 //
 // Changelog:
+//     2026-10-18 - priority classes, transfer slicing and blocking statistics (I2CDEV_ARBITER)
+//     2026-10-18 - caller-supplied scratch buffer instead of stack arrays (I2CDEV_STATIC_SCRATCH)
+//                - fix word indexing in I2CdevreadWords/I2CdevwriteWords
+//     2026-10-18 - deferred error log instead of chprintf in the bus path (I2CDEV_ERRLOG)
+//     2026-10-18 - optional transaction trace recorder (I2CDEV_TRACE)
 //     2012-06-09 - fix major issue with reading > 32 bytes at a time with Arduino Wire
 //                - add compiler warnings when using outdated or IDE or limited I2Cdev implementation
 //     2011-11-01 - fix write*Bits mask calculation (thanks sasquatch @ Arduino forums)
@@ -56,6 +61,477 @@ THE SOFTWARE.
 //for memcpy
 #include <string.h>
 
+#if I2CDEV_TRACE
+#include "i2cdev_trace.h"
+
+/* Records are appended while the bus is held, so the ring needs no lock of
+ * its own and the order matches the bus. */
+static uint8_t traceRing[I2CDEV_TRACE_SIZE];
+static uint16_t traceHead = 0, traceTail = 0, traceUsed = 0;
+static uint32_t traceDropped = 0;
+static systime_t traceLast;
+static bool_t traceEnabled = FALSE;
+
+static uint8_t tracePeek(uint16_t offset) {
+	return traceRing[(traceTail + offset) % I2CDEV_TRACE_SIZE];
+}
+
+static uint16_t traceSizeAt(uint16_t offset) {
+	uint8_t first = tracePeek(offset);
+	return i2cdevTraceSize((first & I2CDEV_TRACE_READ) ? 1 : 0, tracePeek(offset + 2), tracePeek(offset + 3));
+}
+
+static void tracePut(const uint8_t *data, uint16_t length) {
+	while (length--) {
+		traceRing[traceHead] = *data++;
+		traceHead = (traceHead + 1) % I2CDEV_TRACE_SIZE;
+	}
+}
+
+static void traceRecord(uint8_t devAddr, uint8_t regAddr, uint8_t read, uint8_t length, msg_t rdymsg, const uint8_t *payload) {
+	I2CdevTraceRecord record;
+	uint8_t header[I2CDEV_TRACE_HEADER];
+	systime_t now, delta;
+	uint16_t size;
+
+	if (!traceEnabled) return;
+	now = chTimeNow();
+	delta = now - traceLast;
+	traceLast = now;
+	record.devAddr = devAddr;
+	record.regAddr = regAddr;
+	record.read = read;
+	record.length = length;
+	record.result = (rdymsg == RDY_OK) ? I2CDEV_TRACE_OK : (rdymsg == RDY_TIMEOUT) ? I2CDEV_TRACE_TIMEOUT : I2CDEV_TRACE_RESET;
+	record.delta = (delta > I2CDEV_TRACE_MAX_DELTA) ? I2CDEV_TRACE_MAX_DELTA : (uint16_t)delta;
+	size = i2cdevTraceSize(read, length, record.result);
+	if (size > I2CDEV_TRACE_SIZE) return;
+
+	// overwrite the oldest records
+	while (I2CDEV_TRACE_SIZE - traceUsed < size) {
+		uint16_t oldest = traceSizeAt(0);
+		traceTail = (traceTail + oldest) % I2CDEV_TRACE_SIZE;
+		traceUsed -= oldest;
+		traceDropped++;
+	}
+	i2cdevTraceEncodeHeader(header, &record);
+	tracePut(header, I2CDEV_TRACE_HEADER);
+	tracePut(payload, size - I2CDEV_TRACE_HEADER);
+	traceUsed += size;
+}
+
+#define TRACE_RECORD(devAddr, regAddr, read, length, rdymsg, payload) traceRecord(devAddr, regAddr, read, length, rdymsg, payload)
+
+/** Start or stop recording.
+ * @param enabled TRUE to record every following transfer
+ */
+void I2CdevtraceEnable(bool_t enabled) {
+	i2cAcquireBus(&I2C_MPU);
+	if (enabled && !traceEnabled) traceLast = chTimeNow();
+	traceEnabled = enabled;
+	i2cReleaseBus(&I2C_MPU);
+}
+
+/** Drop all recorded transfers. */
+void I2CdevtraceClear(void) {
+	i2cAcquireBus(&I2C_MPU);
+	traceHead = traceTail = traceUsed = 0;
+	traceDropped = 0;
+	traceLast = chTimeNow();
+	i2cReleaseBus(&I2C_MPU);
+}
+
+/** Copy the trace out, oldest record first, whole records only.
+ * The ring is left untouched, e.g. dump after a fault and keep recording.
+ * @param out Output buffer
+ * @param max Size of the output buffer
+ * @return Number of bytes written
+ */
+uint16_t I2CdevtraceDump(uint8_t *out, uint16_t max) {
+	uint16_t offset = 0, size, i;
+	i2cAcquireBus(&I2C_MPU);
+	while (offset < traceUsed) {
+		size = traceSizeAt(offset);
+		if (offset + size > max) break;
+		for (i = 0; i < size; i++) out[offset + i] = tracePeek(offset + i);
+		offset += size;
+	}
+	i2cReleaseBus(&I2C_MPU);
+	return offset;
+}
+
+/** Get the number of records overwritten since the last clear.
+ * @return Dropped records
+ */
+uint32_t I2CdevtraceDropped(void) {
+	return traceDropped;
+}
+#else
+#define TRACE_RECORD(devAddr, regAddr, read, length, rdymsg, payload)
+#endif
+
+#if I2CDEV_ERRLOG
+/* Fixed-size records in a ring indexed by free-running counters. Producers
+ * and the consumer only hold the kernel lock for the few stores of one
+ * record, like the ChibiOS I/O queues, so logging never blocks and never
+ * waits for the serial port. Formatting happens in the drain thread. */
+static I2CdevError errlogRing[I2CDEV_ERRLOG_SIZE];
+static uint16_t errlogHead = 0, errlogTail = 0;
+static uint16_t errlogWindowCount = 0;
+static systime_t errlogWindowStart = 0;
+static uint32_t errlogTotal = 0, errlogSuppressed = 0;
+static BaseChannel *errlogChannel;
+static WORKING_AREA(waErrlog, I2CDEV_ERRLOG_STACK);
+
+static void errlogRecord(uint8_t code, uint8_t devAddr, uint8_t regAddr, uint8_t length) {
+	// bus error flags are only valid while the bus is still held
+	i2cflags_t flags = (code == I2CDEV_ERROR_BUS) ? i2cGetErrors(&I2C_MPU) : 0;
+	systime_t now;
+	I2CdevError *e;
+
+	chSysLock();
+	now = chTimeNow();
+	errlogTotal++;
+	if (now - errlogWindowStart >= S2ST(1)) {
+		errlogWindowStart = now;
+		errlogWindowCount = 0;
+	}
+	// rate limit and full ring: count only, the storm costs one increment
+	if (errlogWindowCount >= I2CDEV_ERRLOG_RATE || (uint16_t)(errlogHead - errlogTail) >= I2CDEV_ERRLOG_SIZE) {
+		errlogSuppressed++;
+		chSysUnlock();
+		return;
+	}
+	errlogWindowCount++;
+	e = &errlogRing[errlogHead % I2CDEV_ERRLOG_SIZE];
+	e -> time = now;
+	e -> flags = flags;
+	e -> code = code;
+	e -> devAddr = devAddr;
+	e -> regAddr = regAddr;
+	e -> length = length;
+	errlogHead++;
+	chSysUnlock();
+}
+
+#define ERRLOG_RECORD(code, devAddr, regAddr, length) errlogRecord(code, devAddr, regAddr, length)
+#define ERRLOG_BUS(devAddr, regAddr, length, rdymsg) do { \
+	if (rdymsg != RDY_OK) errlogRecord((rdymsg == RDY_TIMEOUT) ? I2CDEV_ERROR_TIMEOUT : I2CDEV_ERROR_BUS, devAddr, regAddr, length); \
+} while (0)
+
+/** Take the oldest error record, for applications that drain the log themselves.
+ * @param error Output
+ * @return TRUE if a record was taken, FALSE if the log is empty
+ */
+bool_t I2CdeverrlogRead(I2CdevError *error) {
+	chSysLock();
+	if (errlogTail == errlogHead) {
+		chSysUnlock();
+		return FALSE;
+	}
+	*error = errlogRing[errlogTail % I2CDEV_ERRLOG_SIZE];
+	errlogTail++;
+	chSysUnlock();
+	return TRUE;
+}
+
+/** Get the number of errors since startup.
+ * @return Errors, logged or not
+ */
+uint32_t I2CdeverrlogTotal(void) {
+	return errlogTotal;
+}
+
+/** Get the number of errors that were only counted (rate limit or full log).
+ * @return Suppressed errors
+ */
+uint32_t I2CdeverrlogSuppressed(void) {
+	return errlogSuppressed;
+}
+
+static msg_t errlogThread(void *arg) {
+	static const char *names[] = { "", "length > I2CDEV_BUFFER_LENGTH", "timeout", "bus error" };
+	uint32_t reported = 0, suppressed;
+	I2CdevError e;
+
+	(void)arg;
+	chRegSetThreadName("i2cdev errlog");
+	while (TRUE) {
+		while (I2CdeverrlogRead(&e)) {
+			chprintf(errlogChannel, "I2C ERROR %u: %s, addr 0x%x reg 0x%x len %u flags 0x%x\r\n",
+				e.time, names[e.code], e.devAddr, e.regAddr, e.length, e.flags);
+		}
+		suppressed = errlogSuppressed;
+		if (suppressed != reported) {
+			chprintf(errlogChannel, "I2C ERROR: %u more not logged\r\n", suppressed - reported);
+			reported = suppressed;
+		}
+		chThdSleepMilliseconds(I2CDEV_ERRLOG_DRAIN_MS);
+	}
+	return 0;
+}
+
+/** Start the thread that prints logged errors, e.g. on (BaseChannel *)&SD2.
+ * Give it a priority below every thread that uses the bus.
+ * @param chp Output channel
+ * @param prio Thread priority, e.g. LOWPRIO + 1
+ */
+void I2CdeverrlogStart(BaseChannel *chp, tprio_t prio) {
+	errlogChannel = chp;
+	chThdCreateStatic(waErrlog, sizeof(waErrlog), prio, errlogThread, NULL);
+}
+#else
+#define ERRLOG_RECORD(code, devAddr, regAddr, length)
+#define ERRLOG_BUS(devAddr, regAddr, length, rdymsg)
+#endif
+
+#if I2CDEV_STATIC_SCRATCH
+/* Only used while the bus is held, so the bus lock also guards the buffer. */
+static uint8_t *i2cdevScratch;
+
+/** Supply the transfer buffer for I2CdevreadWords/I2CdevwriteBytes/I2CdevwriteWords.
+ * Call once before the first transfer.
+ * @param arena Buffer of exactly I2CDEV_SCRATCH_SIZE bytes, e.g. &buffer for a static array
+ */
+void I2CdevsetScratch(uint8_t (*arena)[I2CDEV_SCRATCH_SIZE]) {
+	i2cdevScratch = *arena;
+}
+
+#define I2CDEV_SCRATCH(name) uint8_t *name = i2cdevScratch
+#else
+#define I2CDEV_SCRATCH(name) uint8_t name[I2CDEV_SCRATCH_SIZE]
+#endif
+
+#if I2CDEV_ARBITER
+#if HAL_IMPLEMENTS_COUNTERS
+#define ARB_NOW()		((uint32_t)halGetCounterValue())
+#else
+#define ARB_NOW()		((uint32_t)chTimeNow())
+#endif
+#define ARB_POLL_MS		1
+
+typedef struct {
+	uint8_t devAddr;
+	uint8_t cls;
+	uint8_t slice;
+	uint8_t page;
+	uint16_t busyMs;
+} ArbDevice;
+
+/* Statistics change only while the bus is held. The device table is read
+ * before the bus is taken, so register devices before they are used; the
+ * waiter counts are read between slices without the bus lock. */
+static ArbDevice arbDevices[I2CDEV_ARB_DEVICES];
+static uint8_t arbCount = 0;
+static volatile uint8_t arbWaiting[I2CDEV_CLASSES];
+static I2CdevArbStats arbStats[I2CDEV_CLASSES];
+static uint32_t arbHeldSince;
+#if I2CDEV_ARB_TEST
+static uint8_t arbPosted[I2CDEV_CLASSES];		// waiters announced by I2CdevarbWait()
+static uint32_t arbPostedSince[I2CDEV_CLASSES];
+#endif
+
+static const ArbDevice *arbFind(uint8_t devAddr) {
+	uint8_t i;
+	for (i = 0; i < arbCount; i++) {
+		if (arbDevices[i].devAddr == devAddr) return &arbDevices[i];
+	}
+	return NULL;
+}
+
+static uint8_t arbClass(uint8_t devAddr) {
+	const ArbDevice *dev = arbFind(devAddr);
+	return dev ? dev -> cls : I2CDEV_CLASS_CRITICAL;
+}
+
+static void arbAcquire(uint8_t cls) {
+	uint32_t start = ARB_NOW(), wait;
+	chSysLock();
+#if I2CDEV_ARB_TEST
+	if (arbPosted[cls]) {
+		// already counted as waiting, the wait started at the announcement
+		arbPosted[cls]--;
+		start = arbPostedSince[cls];
+	} else {
+		arbWaiting[cls]++;
+	}
+#else
+	arbWaiting[cls]++;
+#endif
+	chSysUnlock();
+	i2cAcquireBus(&I2C_MPU);
+	chSysLock();
+	arbWaiting[cls]--;
+	chSysUnlock();
+	arbHeldSince = ARB_NOW();
+	wait = arbHeldSince - start;
+	arbStats[cls].totalWait += wait;
+	if (wait > arbStats[cls].maxWait) arbStats[cls].maxWait = wait;
+}
+
+static void arbRelease(uint8_t cls) {
+	uint32_t hold = ARB_NOW() - arbHeldSince;
+	if (hold > arbStats[cls].maxHold) arbStats[cls].maxHold = hold;
+	i2cReleaseBus(&I2C_MPU);
+}
+
+static void arbBegin(uint8_t devAddr) {
+	uint8_t cls = arbClass(devAddr);
+	arbAcquire(cls);
+	arbStats[cls].transfers++;
+}
+
+// hand the bus over between slices if a higher class waits
+static void arbYield(uint8_t cls) {
+	uint8_t higher;
+	for (higher = 0; higher < cls; higher++) {
+		if (arbWaiting[higher]) {
+			arbStats[cls].yields++;
+			arbRelease(cls);
+			arbAcquire(cls);
+			return;
+		}
+	}
+}
+
+// wait out a NACK of a busy device with the bus released, TRUE to try again
+static bool_t arbRetry(const ArbDevice *dev, msg_t rdymsg, systime_t start) {
+	if (rdymsg != RDY_RESET || dev == NULL || dev -> busyMs == 0) return FALSE;
+	if (!(i2cGetErrors(&I2C_MPU) & I2CD_ACK_FAILURE)) return FALSE;
+	if ((systime_t)(chTimeNow() - start) >= MS2ST(dev -> busyMs)) return FALSE;
+	arbStats[dev -> cls].retries++;
+	arbRelease(dev -> cls);
+	chThdSleepMilliseconds(ARB_POLL_MS);
+	arbAcquire(dev -> cls);
+	return TRUE;
+}
+
+// bytes of the next slice starting at regAddr
+static uint8_t arbSlice(const ArbDevice *dev, uint8_t regAddr, uint8_t remaining) {
+	uint8_t n = remaining;
+	if (dev == NULL) return n;
+	if (dev -> slice && n > dev -> slice) n = dev -> slice;
+	if (dev -> page && n > dev -> page - regAddr % dev -> page) n = dev -> page - regAddr % dev -> page;
+	return n;
+}
+
+// largest slice of a transfer of length bytes, what has to fit the scratch buffer
+static uint8_t arbMaxSlice(uint8_t devAddr, uint8_t length) {
+	const ArbDevice *dev = arbFind(devAddr);
+	uint8_t n = length;
+	if (dev == NULL) return n;
+	if (dev -> slice && n > dev -> slice) n = dev -> slice;
+	if (dev -> page && n > dev -> page) n = dev -> page;
+	return n;
+}
+
+/* Slices of a byte transfer, called with the bus held. Writes go through
+ * txbuf, refilled per slice since the bus may change hands in between. */
+static msg_t arbTransfer(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data, uint8_t *txbuf, uint16_t timeout) {
+	const ArbDevice *dev = arbFind(devAddr);
+	uint8_t cls = dev ? dev -> cls : I2CDEV_CLASS_CRITICAL;
+	uint8_t done = 0, n = 0, reg = regAddr;
+	systime_t start;
+	msg_t rdymsg = RDY_OK;
+
+	// do, so a zero-length transfer still addresses the device
+	do {
+		reg = regAddr + done;
+		n = arbSlice(dev, reg, length - done);
+		start = chTimeNow();
+		do {
+			arbStats[cls].slices++;
+			if (txbuf) {
+				txbuf[0] = reg;
+				memcpy(txbuf + sizeof(uint8_t), data + done, sizeof(uint8_t) * n);
+				rdymsg = i2cMasterTransmit(&I2C_MPU, devAddr, txbuf, n + 1, NULL, 0);
+				TRACE_RECORD(devAddr, reg, 0, n, rdymsg, txbuf + 1);
+			} else {
+				rdymsg = i2cMasterTransmitTimeout(&I2C_MPU, devAddr, &reg, 1, data + done, n, MS2ST(timeout));
+				TRACE_RECORD(devAddr, reg, 1, n, rdymsg, data + done);
+			}
+		} while (arbRetry(dev, rdymsg, start));
+		if (rdymsg != RDY_OK) break;
+		done += n;
+		if (done < length) arbYield(cls);
+	} while (done < length);
+	ERRLOG_BUS(devAddr, reg, n, rdymsg);
+	return rdymsg;
+}
+
+/** Set the priority class and slicing of a device.
+ * @param devAddr I2C slave device address
+ * @param cls I2CDEV_CLASS_NORMAL or _BULK; I2CDEV_CLASS_CRITICAL removes the device
+ * @param slice Max bytes per transaction, 0 for no limit
+ * @param page Slices never cross a multiple of page bytes (EEPROM page), 0 for none
+ * @param busyMs Retry NACKs for up to this long, 0 to fail at the first one
+ * @return FALSE if the table (I2CDEV_ARB_DEVICES) is full or cls is invalid
+ */
+bool_t I2CdevarbSetDevice(uint8_t devAddr, uint8_t cls, uint8_t slice, uint8_t page, uint16_t busyMs) {
+	ArbDevice *dev = (ArbDevice *)arbFind(devAddr);
+	bool_t ok = TRUE;
+	if (cls >= I2CDEV_CLASSES) return FALSE;
+	i2cAcquireBus(&I2C_MPU);
+	if (cls == I2CDEV_CLASS_CRITICAL) {
+		if (dev) *dev = arbDevices[--arbCount];
+	} else {
+		if (dev == NULL && arbCount < I2CDEV_ARB_DEVICES) dev = &arbDevices[arbCount++];
+		if (dev) {
+			dev -> devAddr = devAddr;
+			dev -> cls = cls;
+			dev -> slice = slice;
+			dev -> page = page;
+			dev -> busyMs = busyMs;
+		} else {
+			ok = FALSE;
+		}
+	}
+	i2cReleaseBus(&I2C_MPU);
+	return ok;
+}
+
+/** Get the arbitration statistics of a class.
+ * @param cls I2CDEV_CLASS_*
+ * @param stats Output
+ */
+void I2CdevarbGetStats(uint8_t cls, I2CdevArbStats *stats) {
+	if (cls >= I2CDEV_CLASSES) return;
+	i2cAcquireBus(&I2C_MPU);
+	*stats = arbStats[cls];
+	i2cReleaseBus(&I2C_MPU);
+}
+
+/** Clear the statistics of all classes. */
+void I2CdevarbResetStats(void) {
+	i2cAcquireBus(&I2C_MPU);
+	memset(arbStats, 0, sizeof(arbStats));
+	i2cReleaseBus(&I2C_MPU);
+}
+
+#if I2CDEV_ARB_TEST
+/** Announce the next transfer of a class as waiting from now on. Stands in
+ * for a blocked thread where only one thread runs (host checks): transfers
+ * of lower classes yield at their next slice boundary until a transfer of
+ * cls follows, which counts its wait from this call.
+ * @param cls I2CDEV_CLASS_*
+ */
+void I2CdevarbWait(uint8_t cls) {
+	if (cls >= I2CDEV_CLASSES) return;
+	chSysLock();
+	if (arbPosted[cls] == 0) arbPostedSince[cls] = ARB_NOW();
+	arbPosted[cls]++;
+	arbWaiting[cls]++;
+	chSysUnlock();
+}
+#endif
+
+#define BUS_ACQUIRE(devAddr)	arbBegin(devAddr)
+#define BUS_RELEASE(devAddr)	arbRelease(arbClass(devAddr))
+#else
+#define BUS_ACQUIRE(devAddr)	i2cAcquireBus(&I2C_MPU)
+#define BUS_RELEASE(devAddr)	i2cReleaseBus(&I2C_MPU)
+#endif
+
 /** Read a single bit from an 8-bit device register.
  * @param devAddr I2C slave device address
  * @param regAddr Register regAddr to read from
@@ -171,14 +647,19 @@ int8_t I2CdevreadBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t
 	//uint8_t mpu_txbuf[1], mpu_rxbuf[I2CDEV_BUFFER_LENGTH], i;
 	msg_t rdymsg;
 	if(length > I2CDEV_BUFFER_LENGTH) {
-		chprintf((BaseChannel *)&SD2,"ERROR readBytes: length > I2CDEV BUFFERLENGTH\n");
+		ERRLOG_RECORD(I2CDEV_ERROR_LENGTH, devAddr, regAddr, length);
 		return FALSE;
 	}
-	i2cAcquireBus(&I2C_MPU);
+	BUS_ACQUIRE(devAddr);
+#if I2CDEV_ARBITER
+	rdymsg = arbTransfer(devAddr, regAddr, length, data, NULL, timeout);
+#else
 	rdymsg = i2cMasterTransmitTimeout(&I2C_MPU, devAddr, &regAddr, 1, data, length, MS2ST(timeout));
-	i2cReleaseBus(&I2C_MPU);
+	TRACE_RECORD(devAddr, regAddr, 1, length, rdymsg, data);
+	ERRLOG_BUS(devAddr, regAddr, length, rdymsg);
+#endif
+	BUS_RELEASE(devAddr);
 	if(rdymsg == RDY_TIMEOUT || rdymsg == RDY_RESET) {
-		chprintf((BaseChannel *)&SD2,"I2C ERROR: %d\n", i2cGetErrors(&I2CD1));
 		return FALSE;
 	}
 	return TRUE;
@@ -193,24 +674,27 @@ int8_t I2CdevreadBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t
  * @return Number of words read (0 indicates failure)
  */
 int8_t I2CdevreadWords(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint16_t *data, uint16_t timeout) {
-	uint8_t mpu_txbuf[1], mpu_rxbuf[I2CDEV_BUFFER_LENGTH], i;
+	I2CDEV_SCRATCH(mpu_rxbuf);
+	uint8_t i;
 	msg_t rdymsg;
 	if((length * 2) > I2CDEV_BUFFER_LENGTH) {
+		ERRLOG_RECORD(I2CDEV_ERROR_LENGTH, devAddr, regAddr, length * 2);
 		return FALSE;
 	}
-	mpu_txbuf[0] = regAddr;
+	BUS_ACQUIRE(devAddr);
 	for(i=0;i<(length * 2);i++) {
 		mpu_rxbuf[i] = 0x00;
 	}
-	i2cAcquireBus(&I2C_MPU);
-	rdymsg = i2cMasterTransmitTimeout(&I2C_MPU, devAddr, mpu_txbuf, 1, mpu_rxbuf, length * 2, MS2ST(timeout));
-	i2cReleaseBus(&I2C_MPU);
+	rdymsg = i2cMasterTransmitTimeout(&I2C_MPU, devAddr, &regAddr, 1, mpu_rxbuf, length * 2, MS2ST(timeout));
+	TRACE_RECORD(devAddr, regAddr, 1, length * 2, rdymsg, mpu_rxbuf);
+	ERRLOG_BUS(devAddr, regAddr, length * 2, rdymsg);
+	for(i=0;rdymsg == RDY_OK && i<length;i++) {
+		data[i] = (mpu_rxbuf[2 * i] << 8) + mpu_rxbuf[2 * i + 1];
+	}
+	BUS_RELEASE(devAddr);
 	if(rdymsg == RDY_TIMEOUT || rdymsg == RDY_RESET) {
 		return FALSE;
 	}
-	for(i=0;i<length * 2;i += 2) {
-		data[i] = (mpu_rxbuf[i] << 8) + mpu_rxbuf[i+1];
-	}
 	return TRUE;
 }
 
@@ -328,18 +812,29 @@ bool_t I2CdevwriteWord(uint8_t devAddr, uint8_t regAddr, uint16_t data) {
  * @return Status of operation (true = success)
  */
 bool_t I2CdevwriteBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data) {
-	uint8_t mpu_txbuf[I2CDEV_BUFFER_LENGTH], mpu_rxbuf[1];
+	I2CDEV_SCRATCH(mpu_txbuf);
 	msg_t rdymsg;
+#if I2CDEV_ARBITER
+	// txbuf is refilled per slice, only a slice has to fit
+	if((arbMaxSlice(devAddr, length) + 1)> I2CDEV_BUFFER_LENGTH) {
+#else
 	if((length + 1)> I2CDEV_BUFFER_LENGTH) {
-		chprintf((BaseChannel *)&SD2,"ERROR readBytes: length + 1 > I2CDEV BUFFERLENGTH\n");
+#endif
+		ERRLOG_RECORD(I2CDEV_ERROR_LENGTH, devAddr, regAddr, length);
 		return FALSE;
 	}
+	
+	BUS_ACQUIRE(devAddr);
+#if I2CDEV_ARBITER
+	rdymsg = arbTransfer(devAddr, regAddr, length, data, mpu_txbuf, 0);
+#else
 	mpu_txbuf[0] = regAddr;
 	memcpy(mpu_txbuf + sizeof(uint8_t), data, sizeof(uint8_t) * length);
-	
-	i2cAcquireBus(&I2C_MPU);
-	rdymsg = i2cMasterTransmit(&I2C_MPU, devAddr, mpu_txbuf, length + 1, mpu_rxbuf, 0);
-	i2cReleaseBus(&I2C_MPU);
+	rdymsg = i2cMasterTransmit(&I2C_MPU, devAddr, mpu_txbuf, length + 1, NULL, 0);
+	TRACE_RECORD(devAddr, regAddr, 0, length, rdymsg, mpu_txbuf + 1);
+	ERRLOG_BUS(devAddr, regAddr, length, rdymsg);
+#endif
+	BUS_RELEASE(devAddr);
 	if(rdymsg == RDY_TIMEOUT || rdymsg == RDY_RESET) {
 		return FALSE;
 	}
@@ -354,21 +849,25 @@ bool_t I2CdevwriteBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_
  * @return Status of operation (true = success)
  */
 bool_t I2CdevwriteWords(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint16_t *data) {
-	uint8_t mpu_txbuf[I2CDEV_BUFFER_LENGTH], mpu_rxbuf[1], i;
+	I2CDEV_SCRATCH(mpu_txbuf);
+	uint8_t i;
 	msg_t rdymsg;
 	if(((length * 2) + 1)> I2CDEV_BUFFER_LENGTH) {
+		ERRLOG_RECORD(I2CDEV_ERROR_LENGTH, devAddr, regAddr, length * 2);
 		return FALSE;
 	}
+	
+	BUS_ACQUIRE(devAddr);
 	mpu_txbuf[0] = regAddr;
-	for(i=0;i<(length*2); i += 2)
+	for(i=0;i<length; i++)
 	{
-		mpu_txbuf[i+1] = (data[i] >> 8) & 0xff;
-		mpu_txbuf[i+2] = data[i] & 0xff;
+		mpu_txbuf[2 * i + 1] = (data[i] >> 8) & 0xff;
+		mpu_txbuf[2 * i + 2] = data[i] & 0xff;
 	}
-	
-	i2cAcquireBus(&I2C_MPU);
-	rdymsg = i2cMasterTransmit(&I2C_MPU, devAddr, mpu_txbuf, (length * 2) + 1, mpu_rxbuf, 0);
-	i2cReleaseBus(&I2C_MPU);
+	rdymsg = i2cMasterTransmit(&I2C_MPU, devAddr, mpu_txbuf, (length * 2) + 1, NULL, 0);
+	TRACE_RECORD(devAddr, regAddr, 0, length * 2, rdymsg, mpu_txbuf + 1);
+	ERRLOG_BUS(devAddr, regAddr, length * 2, rdymsg);
+	BUS_RELEASE(devAddr);
 	if(rdymsg == RDY_TIMEOUT || rdymsg == RDY_RESET) {
 		return FALSE;
 	}
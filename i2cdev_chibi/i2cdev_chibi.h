@@ -3,6 +3,11 @@
 // 6/9/2012 by Jeff Rowberg <jeff@rowberg.net>
 //
 // Changelog:
+//     2026-10-18 - reject an I2CDEV_ERRLOG_SIZE that is not a power of two
+//     2026-10-18 - priority classes, transfer slicing and blocking statistics (I2CDEV_ARBITER)
+//     2026-10-18 - caller-supplied scratch buffer instead of stack arrays (I2CDEV_STATIC_SCRATCH)
+//     2026-10-18 - deferred error log instead of chprintf in the bus path (I2CDEV_ERRLOG)
+//     2026-10-18 - optional transaction trace recorder (I2CDEV_TRACE)
 //     2012-06-09 - fix major issue with reading > 32 bytes at a time with Arduino Wire
 //                - add compiler warnings when using outdated or IDE or limited I2Cdev implementation
 //     2011-11-01 - fix write*Bits mask calculation (thanks sasquatch @ Arduino forums)
@@ -60,6 +65,110 @@ THE SOFTWARE.
 #define I2CDEV_DEFAULT_READ_TIMEOUT     1000
 #define I2CDEV_BUFFER_LENGTH			64
 
+/* Set I2CDEV_TRACE to TRUE to record every transfer into a ring of
+ * I2CDEV_TRACE_SIZE bytes (format in i2cdev_trace.h, oldest records are
+ * overwritten). Dumps replay on the host through host/i2cdev_replay.c. */
+#ifndef I2CDEV_TRACE
+#define I2CDEV_TRACE					FALSE
+#endif
+#ifndef I2CDEV_TRACE_SIZE
+#define I2CDEV_TRACE_SIZE				2048
+#endif
+
+/* I2CdevreadWords/I2CdevwriteBytes/I2CdevwriteWords need a transfer
+ * buffer of I2CDEV_SCRATCH_SIZE bytes. By default it is on the caller's
+ * stack; with I2CDEV_STATIC_SCRATCH set to TRUE the application supplies
+ * one static buffer through I2CdevsetScratch(), shared under the bus lock.
+ * tools/stackreport.c reports the worst-case stack per entry point. */
+#ifndef I2CDEV_STATIC_SCRATCH
+#define I2CDEV_STATIC_SCRATCH			FALSE
+#endif
+#define I2CDEV_SCRATCH_SIZE				I2CDEV_BUFFER_LENGTH
+
+/* Length and bus errors go into a ring of I2CDEV_ERRLOG_SIZE fixed-size
+ * records instead of being printed in the bus path. At most
+ * I2CDEV_ERRLOG_RATE records per second are kept, the rest of a storm is
+ * only counted. I2CdeverrlogStart() runs a low-priority thread that prints
+ * the records every I2CDEV_ERRLOG_DRAIN_MS; without it, poll
+ * I2CdeverrlogRead(). Set I2CDEV_ERRLOG to FALSE to drop errors silently. */
+#ifndef I2CDEV_ERRLOG
+#define I2CDEV_ERRLOG					TRUE
+#endif
+#ifndef I2CDEV_ERRLOG_SIZE
+#define I2CDEV_ERRLOG_SIZE				16		// power of two
+#endif
+#if I2CDEV_ERRLOG_SIZE < 1 || (I2CDEV_ERRLOG_SIZE & (I2CDEV_ERRLOG_SIZE - 1)) != 0
+#error "I2CDEV_ERRLOG_SIZE must be a power of two"
+#endif
+#ifndef I2CDEV_ERRLOG_RATE
+#define I2CDEV_ERRLOG_RATE				10		// records per second
+#endif
+#ifndef I2CDEV_ERRLOG_DRAIN_MS
+#define I2CDEV_ERRLOG_DRAIN_MS			100
+#endif
+#ifndef I2CDEV_ERRLOG_STACK
+#define I2CDEV_ERRLOG_STACK				512
+#endif
+
+/* With I2CDEV_ARBITER set to TRUE every device has a priority class.
+ * Devices not registered with I2CdevarbSetDevice() are CRITICAL and keep
+ * one transaction per call, as without the arbiter. Byte reads and writes
+ * to a NORMAL or BULK device are split into slices of at most 'slice'
+ * bytes that never cross a 'page' boundary, with the register address
+ * advanced per slice, so only register-auto-incrementing devices and
+ * memories may be registered. Between slices the bus is handed over if a
+ * transfer of a higher class waits: a critical read blocks for at most
+ * one slice instead of the whole transfer. A device with busyMs set is
+ * polled while it NACKs (EEPROM write cycle) with the bus released between
+ * attempts, up to busyMs. Every write slice starts a write cycle of its
+ * own, so write slices trade logger throughput for IMU latency. Writes
+ * are limited by their largest slice instead of their length: a 64 byte
+ * EEPROM page goes out with slice 32, page 64 (register address plus
+ * slice has to fit I2CDEV_BUFFER_LENGTH).
+ * The bus mutex orders waiters by thread priority: run the IMU thread
+ * above the threads of lower classes. Wait and hold times are counted per
+ * class in halGetCounterValue() ticks, system ticks without HAL counters. */
+#ifndef I2CDEV_ARBITER
+#define I2CDEV_ARBITER					FALSE
+#endif
+#ifndef I2CDEV_ARB_DEVICES
+#define I2CDEV_ARB_DEVICES				4		// registered NORMAL/BULK devices
+#endif
+// host checks only: I2CdevarbWait() fakes a thread blocked on the bus
+#ifndef I2CDEV_ARB_TEST
+#define I2CDEV_ARB_TEST					FALSE
+#endif
+
+// I2CdevarbSetDevice() classes, highest first
+#define I2CDEV_CLASS_CRITICAL			0
+#define I2CDEV_CLASS_NORMAL				1
+#define I2CDEV_CLASS_BULK				2
+#define I2CDEV_CLASSES					3
+
+typedef struct {
+	uint32_t transfers;
+	uint32_t slices;			// transactions, including busy retries
+	uint32_t yields;			// bus handed to a higher class between slices
+	uint32_t retries;			// NACKs while the device was busy
+	uint32_t maxWait;			// longest wait for the bus
+	uint32_t totalWait;
+	uint32_t maxHold;			// longest time the bus was held in one go
+} I2CdevArbStats;
+
+// I2CdevError codes
+#define I2CDEV_ERROR_LENGTH				1		// transfer longer than I2CDEV_BUFFER_LENGTH, not started
+#define I2CDEV_ERROR_TIMEOUT			2		// RDY_TIMEOUT, the driver needs a restart
+#define I2CDEV_ERROR_BUS				3		// RDY_RESET, flags from i2cGetErrors()
+
+typedef struct {
+	systime_t time;
+	i2cflags_t flags;
+	uint8_t code;
+	uint8_t devAddr;
+	uint8_t regAddr;
+	uint8_t length;
+} I2CdevError;
+
 int8_t I2CdevreadBit(uint8_t devAddr, uint8_t regAddr, uint8_t bitNum, uint8_t *data, uint16_t timeout);
 int8_t I2CdevreadBitW(uint8_t devAddr, uint8_t regAddr, uint8_t bitNum, uint16_t *data, uint16_t timeout);
 int8_t I2CdevreadBits(uint8_t devAddr, uint8_t regAddr, uint8_t bitStart, uint8_t length, uint8_t *data, uint16_t timeout);
@@ -78,4 +187,31 @@ bool_t I2CdevwriteWord(uint8_t devAddr, uint8_t regAddr, uint16_t data);
 bool_t I2CdevwriteBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data);
 bool_t I2CdevwriteWords(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint16_t *data);
 
+#if I2CDEV_STATIC_SCRATCH
+void I2CdevsetScratch(uint8_t (*arena)[I2CDEV_SCRATCH_SIZE]);
+#endif
+
+#if I2CDEV_ARBITER
+bool_t I2CdevarbSetDevice(uint8_t devAddr, uint8_t cls, uint8_t slice, uint8_t page, uint16_t busyMs);
+void I2CdevarbGetStats(uint8_t cls, I2CdevArbStats *stats);
+void I2CdevarbResetStats(void);
+#if I2CDEV_ARB_TEST
+void I2CdevarbWait(uint8_t cls);
+#endif
+#endif
+
+#if I2CDEV_TRACE
+void I2CdevtraceEnable(bool_t enabled);
+void I2CdevtraceClear(void);
+uint16_t I2CdevtraceDump(uint8_t *out, uint16_t max);
+uint32_t I2CdevtraceDropped(void);
+#endif
+
+#if I2CDEV_ERRLOG
+void I2CdeverrlogStart(BaseChannel *chp, tprio_t prio);
+bool_t I2CdeverrlogRead(I2CdevError *error);
+uint32_t I2CdeverrlogTotal(void);
+uint32_t I2CdeverrlogSuppressed(void);
+#endif
+
 #endif /* _I2CDEV_CHIBI_H_ */
@@ -0,0 +1,114 @@
+// I2Cdev library collection - transaction trace format
+// Record layout shared by the recorder and the host tools
+//
+// Changelog:
+//     2026-10-18 - initial release
+
+/* ============================================
+ChibiOS I2Cdev trace format code is placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#ifndef _I2CDEV_TRACE_H_
+#define _I2CDEV_TRACE_H_
+
+/* Only <stdint.h>, so the MCU recorder (I2CDEV_TRACE in i2cdev_chibi.h), the
+ * replay backend (host/) and host tools share one encoder and decoder.
+ *
+ * A trace is a plain concatenation of records, oldest first:
+ *
+ *   0  devAddr | I2CDEV_TRACE_READ for reads
+ *   1  regAddr
+ *   2  length, bytes requested or written
+ *   3  result, I2CDEV_TRACE_OK / _TIMEOUT / _RESET
+ *   4  ticks since the previous record, little-endian, saturates at 0xFFFF
+ *   6  payload: the bytes written, or the bytes read if result is OK
+ *
+ * Word transfers (I2Cdev*Words) are recorded as the raw bytes on the bus.
+ */
+#include <stdint.h>
+
+#define I2CDEV_TRACE_HEADER     6
+#define I2CDEV_TRACE_READ       0x80
+#define I2CDEV_TRACE_ADDR_MASK  0x7F
+#define I2CDEV_TRACE_MAX_DELTA  0xFFFF
+
+// result codes
+#define I2CDEV_TRACE_OK         0
+#define I2CDEV_TRACE_TIMEOUT    1
+#define I2CDEV_TRACE_RESET      2
+
+typedef struct {
+        uint8_t devAddr;
+        uint8_t regAddr;
+        uint8_t read;           // 1 for reads, 0 for writes
+        uint8_t length;
+        uint8_t result;
+        uint16_t delta;         // ticks since the previous record
+        const uint8_t *payload; // NULL for failed reads
+} I2CdevTraceRecord;
+
+/** Size of a record with the given header fields.
+ * @param read 1 for reads
+ * @param length Bytes requested or written
+ * @param result Result code
+ * @return Bytes
+ */
+static uint16_t i2cdevTraceSize(uint8_t read, uint8_t length, uint8_t result) {
+		return I2CDEV_TRACE_HEADER + ((read && result != I2CDEV_TRACE_OK) ? 0 : length);
+}
+
+/** Write the header of a record.
+ * @param out Output, I2CDEV_TRACE_HEADER bytes
+ * @param record Header fields, payload is ignored
+ */
+static void i2cdevTraceEncodeHeader(uint8_t *out, const I2CdevTraceRecord *record) {
+		out[0] = (record -> devAddr & I2CDEV_TRACE_ADDR_MASK) | (record -> read ? I2CDEV_TRACE_READ : 0);
+		out[1] = record -> regAddr;
+		out[2] = record -> length;
+		out[3] = record -> result;
+		out[4] = (uint8_t)(record -> delta & 0xFF);
+		out[5] = (uint8_t)(record -> delta >> 8);
+}
+
+/** Decode the record at the start of a buffer.
+ * @param data Trace bytes
+ * @param length Bytes available
+ * @param record Output, payload points into data
+ * @return Record size, 0 if the buffer ends inside the record
+ */
+static uint16_t i2cdevTraceDecode(const uint8_t *data, uint32_t length, I2CdevTraceRecord *record) {
+		uint16_t size;
+		if (length < I2CDEV_TRACE_HEADER) return 0;
+		record -> devAddr = data[0] & I2CDEV_TRACE_ADDR_MASK;
+		record -> read = (data[0] & I2CDEV_TRACE_READ) ? 1 : 0;
+		record -> regAddr = data[1];
+		record -> length = data[2];
+		record -> result = data[3];
+		record -> delta = (uint16_t)(data[4] | ((uint16_t)data[5] << 8));
+		size = i2cdevTraceSize(record -> read, record -> length, record -> result);
+		if (size > length) return 0;
+		record -> payload = (size > I2CDEV_TRACE_HEADER) ? data + I2CDEV_TRACE_HEADER : 0;
+		return size;
+}
+
+#endif /* _I2CDEV_TRACE_H_ */
@@ -0,0 +1,187 @@
+/* Host serializer for MPU6050/helper_calblob.h
+ * Writes calibration blobs for provisioning, dumps and verifies stored ones,
+ * and checks the format round-trip with the same code the MCU runs.
+ *
+ * Build and run on the host:
+ *     gcc -O2 -Wall -o calblob calblob.c
+ *     ./calblob check
+ *     ./calblob pack out.bin gx gy gz ax ay az [tempRef]
+ *     ./calblob dump in.bin
+ */
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 host tools are placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../MPU6050/helper_calblob.h"
+#include "toolcheck.h"
+
+static const char *statusName(uint8_t status) {
+    switch (status) {
+        case CALBLOB_OK:            return "ok";
+        case CALBLOB_BAD_MAGIC:     return "bad magic";
+        case CALBLOB_BAD_VERSION:   return "unsupported version";
+        case CALBLOB_BAD_LENGTH:    return "bad length";
+        case CALBLOB_BAD_CRC:       return "bad crc";
+        case CALBLOB_NO_DATA:       return "no data";
+    }
+    return "unknown";
+}
+
+static int blobEqual(const CalibrationBlob *a, const CalibrationBlob *b) {
+    int i;
+    for (i = 0; i < 3; i++) {
+        if (a -> gyroOffset[i] != b -> gyroOffset[i] || a -> accelOffset[i] != b -> accelOffset[i]) return 0;
+        if (a -> gyroTempCoeff[i] != b -> gyroTempCoeff[i]) return 0;
+    }
+    return a -> tempRef == b -> tempRef;
+}
+
+static void randomBlob(CalibrationBlob *blob) {
+    int16_t *words = (int16_t *)blob;
+    size_t i;
+    for (i = 0; i < sizeof(CalibrationBlob) / sizeof(int16_t); i++) words[i] = (int16_t)(rand() & 0xFFFF);
+}
+
+static int check(void) {
+    static const uint8_t crcCheck[9] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+    CalibrationBlob in, out;
+    uint8_t data[CALBLOB_SIZE], copy[CALBLOB_SIZE];
+    int failures = 0, round, byte, bit;
+
+    // CRC-16/CCITT-FALSE reference value
+    failures += expect(calBlobCrc16(crcCheck, 9) == 0x29B1, "crc check value");
+
+    // extremes and random contents survive the round trip
+    srand(1);
+    for (round = 0; round < 10000; round++) {
+        if (round == 0) memset(&in, 0, sizeof(in));
+        else if (round == 1) memset(&in, 0x80, sizeof(in));
+        else if (round == 2) memset(&in, 0x7F, sizeof(in));
+        else randomBlob(&in);
+        failures += expect(calBlobPack(&in, data) == CALBLOB_SIZE, "pack size");
+        memset(&out, 0, sizeof(out));
+        failures += expect(calBlobUnpack(&out, data, CALBLOB_SIZE) == CALBLOB_OK, "unpack status");
+        failures += expect(blobEqual(&in, &out), "round trip");
+        if (failures) return failures;
+    }
+
+    // every single bit flip is rejected
+    for (byte = 0; byte < CALBLOB_SIZE; byte++) {
+        for (bit = 0; bit < 8; bit++) {
+            memcpy(copy, data, CALBLOB_SIZE);
+            copy[byte] ^= 1 << bit;
+            failures += expect(calBlobUnpack(&out, copy, CALBLOB_SIZE) != CALBLOB_OK, "bit flip detected");
+        }
+    }
+
+    // truncated, empty, erased and future blobs
+    failures += expect(calBlobUnpack(&out, data, CALBLOB_SIZE - 1) == CALBLOB_BAD_LENGTH, "truncated");
+    failures += expect(calBlobUnpack(&out, data, 0) == CALBLOB_NO_DATA, "empty");
+    memset(copy, 0xFF, CALBLOB_SIZE);
+    failures += expect(calBlobUnpack(&out, copy, CALBLOB_SIZE) == CALBLOB_BAD_MAGIC, "erased flash");
+    memcpy(copy, data, CALBLOB_SIZE);
+    copy[2] = CALBLOB_VERSION + 1;
+    failures += expect(calBlobUnpack(&out, copy, CALBLOB_SIZE) == CALBLOB_BAD_VERSION, "newer version");
+
+    // a rejected blob leaves the output untouched
+    memcpy(&in, &out, sizeof(in));
+    copy[2] = CALBLOB_VERSION;
+    copy[CALBLOB_SIZE - 1] ^= 0x01;
+    calBlobUnpack(&out, copy, CALBLOB_SIZE);
+    failures += expect(blobEqual(&in, &out), "output untouched on error");
+
+    printf("%s\n", failures ? "calblob check FAILED" : "calblob check passed");
+    return failures;
+}
+
+static int pack(int argc, char **argv) {
+    CalibrationBlob blob;
+    uint8_t data[CALBLOB_SIZE];
+    FILE *f;
+    int i;
+
+    if (argc != 9 && argc != 10) {
+        fprintf(stderr, "usage: calblob pack out.bin gx gy gz ax ay az [tempRef]\n");
+        return 2;
+    }
+    memset(&blob, 0, sizeof(blob));
+    for (i = 0; i < 3; i++) {
+        blob.gyroOffset[i] = (int16_t)strtol(argv[3 + i], 0, 0);
+        blob.accelOffset[i] = (int16_t)strtol(argv[6 + i], 0, 0);
+    }
+    if (argc == 10) blob.tempRef = (int16_t)strtol(argv[9], 0, 0);
+    calBlobPack(&blob, data);
+
+    f = fopen(argv[2], "wb");
+    if (f == 0 || fwrite(data, 1, CALBLOB_SIZE, f) != CALBLOB_SIZE) {
+        perror(argv[2]);
+        return 1;
+    }
+    fclose(f);
+    return 0;
+}
+
+static int dump(int argc, char **argv) {
+    CalibrationBlob blob;
+    uint8_t data[256];
+    size_t length;
+    uint8_t status;
+    FILE *f;
+
+    if (argc != 3) {
+        fprintf(stderr, "usage: calblob dump in.bin\n");
+        return 2;
+    }
+    f = fopen(argv[2], "rb");
+    if (f == 0) {
+        perror(argv[2]);
+        return 1;
+    }
+    length = fread(data, 1, sizeof(data), f);
+    fclose(f);
+
+    status = calBlobUnpack(&blob, data, (uint16_t)length);
+    if (status != CALBLOB_OK) {
+        printf("%s: %s\n", argv[2], statusName(status));
+        return 1;
+    }
+    printf("version         %d\n", data[2]);
+    printf("gyroOffset      %6d %6d %6d\n", blob.gyroOffset[0], blob.gyroOffset[1], blob.gyroOffset[2]);
+    printf("accelOffset     %6d %6d %6d\n", blob.accelOffset[0], blob.accelOffset[1], blob.accelOffset[2]);
+    printf("gyroTempCoeff   %6d %6d %6d\n", blob.gyroTempCoeff[0], blob.gyroTempCoeff[1], blob.gyroTempCoeff[2]);
+    printf("tempRef         %6d\n", blob.tempRef);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 2 && strcmp(argv[1], "check") == 0) return check() ? 1 : 0;
+    if (argc >= 2 && strcmp(argv[1], "pack") == 0) return pack(argc, argv);
+    if (argc >= 2 && strcmp(argv[1], "dump") == 0) return dump(argc, argv);
+    fprintf(stderr, "usage: calblob check | pack out.bin gx gy gz ax ay az [tempRef] | dump in.bin\n");
+    return 2;
+}
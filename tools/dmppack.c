@@ -0,0 +1,263 @@
+/* Packer for the DMP memory image
+ * Compresses dmpMemory[] into the format of MPU6050/helper_dmpimage.h and
+ * prints dmpMemoryPacked[] for MPU6050_6Axis_MotionApps20.c. 'check' packs
+ * and unpacks test data with the firmware decoder, makes sure the packed
+ * image in the source is current and compares the upload of both images
+ * against the simulated MPU6050.
+ *
+ * Build and run on the host (the raw image is only compiled in without
+ * MPU6050_DMP_COMPRESSED):
+ *     gcc -O2 -Wall -Wno-unused-function -DMPU6050_DMP_COMPRESSED=FALSE -I../i2cdev_chibi/host -I../i2cdev_chibi -I../MPU6050 -o dmppack \
+ *         dmppack.c ../i2cdev_chibi/host/chhost.c ../i2cdev_chibi/host/i2cdev_sim.c ../i2cdev_chibi/i2cdev_chibi.c \
+ *         ../MPU6050/MPU6050.c ../MPU6050/MPU6050_6Axis_MotionApps20.c ../MPU6050/MPU6050_Calibration.c -lm
+ *     ./dmppack check
+ *     ./dmppack > packed.txt          after changing dmpMemory[]
+ * or 'make check' in this directory. Built by hand, the check looks for
+ * the MPU6050 sources relative to the working directory; add
+ * -DDMPPACK_SOURCE_DIR='"/path/to/MPU6050"' to run it from elsewhere.
+ *
+ * The packer is greedy: at every position it takes whichever of zero run,
+ * copy or literal saves the most bytes right there. Copies are searched in
+ * everything emitted so far, including the pending literal run.
+ */
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 host tools are placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "i2cdev_sim.h"
+#include "MPU6050.h"
+#include "MPU6050_6Axis_MotionApps20.h"
+#include "helper_dmpimage.h"
+#include "toolcheck.h"
+
+#define MAX_IMAGE               4096
+#ifndef DMPPACK_SOURCE_DIR
+#define DMPPACK_SOURCE_DIR      "../MPU6050"        // the Makefile sets an absolute path
+#endif
+#define SOURCE_PATH             DMPPACK_SOURCE_DIR "/MPU6050_6Axis_MotionApps20.c"
+#define HEADER_PATH             DMPPACK_SOURCE_DIR "/MPU6050_6Axis_MotionApps20.h"
+#define MEMORY_SIZE             (MPU6050_DMP_MEMORY_BANKS * MPU6050_DMP_MEMORY_BANK_SIZE)
+
+/* Commit the pending literal run that pack() keeps written ahead at 'pos'. */
+static uint16_t packFlush(uint16_t pos, uint8_t *pending) {
+    if (*pending == 0) return pos;
+    pos += 1 + *pending;
+    *pending = 0;
+    return pos;
+}
+
+/** Pack data into the helper_dmpimage.h format.
+ * @return Packed length, 0 if it does not fit
+ */
+static uint16_t pack(const uint8_t *data, uint16_t length, uint8_t *out, uint16_t size) {
+    uint16_t pos = DMPIMAGE_HEADER_SIZE, end, crc, i = 0, o, bestOffset = 0;
+    uint8_t pending = 0, zero, best, l;
+
+    crc = dmpImageCrc16(0xFFFF, data, length);
+    out[0] = length & 0xFF;
+    out[1] = length >> 8;
+    out[2] = crc & 0xFF;
+    out[3] = crc >> 8;
+    while (i < length) {
+        if (pos + 2 + DMPIMAGE_MAX_LITERAL > size) return 0;
+        for (zero = 0; i + zero < length && zero < DMPIMAGE_MAX_ZERO && data[i + zero] == 0; zero++);
+
+        // the pending run is already written at pos, a copy may use it
+        end = pending ? pos + 1 + pending : pos;
+        best = 0;
+        for (o = 0; o < end && o <= DMPIMAGE_MAX_OFFSET; o++) {
+            for (l = 0; l < DMPIMAGE_MAX_COPY && i + l < length && o + l < end && out[o + l] == data[i + l]; l++);
+            if (l > best) {
+                best = l;
+                bestOffset = o;
+            }
+        }
+
+        if (zero >= 2 && zero - 1 >= best - 2) {
+            pos = packFlush(pos, &pending);
+            out[pos++] = DMPIMAGE_ZERO | (zero - 1);
+            i += zero;
+        } else if (best >= DMPIMAGE_MIN_COPY) {
+            pos = packFlush(pos, &pending);
+            out[pos++] = DMPIMAGE_COPY | ((best - DMPIMAGE_MIN_COPY) << 3) | (bestOffset >> 8);
+            out[pos++] = bestOffset & 0xFF;
+            i += best;
+        } else {
+            out[pos] = DMPIMAGE_LITERAL | pending;
+            out[pos + 1 + pending] = data[i++];
+            if (++pending == DMPIMAGE_MAX_LITERAL) pos = packFlush(pos, &pending);
+        }
+    }
+    return packFlush(pos, &pending);
+}
+
+/** Unpack with the firmware decoder, in chunks of 'step' bytes.
+ * @return DMPIMAGE_OK or one of the DMPIMAGE_* error codes
+ */
+static uint8_t unpack(const uint8_t *image, uint16_t length, uint8_t *out, uint16_t step) {
+    DmpImageReader reader;
+    uint16_t n, total = 0;
+    if (dmpImageBegin(&reader, image, length) != DMPIMAGE_OK) return DMPIMAGE_BAD_LENGTH;
+    while ((n = dmpImageRead(&reader, out + total, step)) > 0) total += n;
+    return dmpImageEnd(&reader);
+}
+
+static void printImage(FILE *f, const uint8_t *image, uint16_t length) {
+    uint16_t i;
+    fprintf(f, "const uint8_t dmpMemoryPacked[MPU6050_DMP_PACKED_SIZE] = {\n");
+    for (i = 0; i < length; i++) {
+        fprintf(f, "%s0x%02X,%s", (i % 16 == 0) ? "    " : "", image[i], (i % 16 == 15 || i == length - 1) ? "\n" : " ");
+    }
+    fprintf(f, "};\n");
+}
+
+static char *readFile(const char *path) {
+    FILE *f = fopen(path, "rb");
+    char *text;
+    long size;
+    if (f == NULL) return NULL;
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    text = malloc(size + 1);
+    if (text == NULL || fread(text, 1, size, f) != (size_t)size) size = 0;
+    text[size] = 0;
+    fclose(f);
+    return text;
+}
+
+/* Upload an image from power-on and return the bus statistics. */
+static bool_t upload(bool_t packed, const uint8_t *image, uint16_t length, bool_t dirty, I2CsimStats *stats) {
+    static const I2CsimTiming timing = I2CSIM_TIMING_400K;
+    static uint8_t ones[MPU6050_DMP_MEMORY_CHUNK_SIZE];
+    bool_t ok;
+    uint16_t i;
+
+    I2CsimStart(&timing);
+    if (dirty) {
+        memset(ones, 0xFF, sizeof(ones));
+        for (i = 0; i < MEMORY_SIZE; i += sizeof(ones)) MPUwriteMemoryBlock(ones, sizeof(ones), i >> 8, i & 0xFF, FALSE, FALSE);
+    }
+    I2CsimResetStats();
+    ok = packed ? MPUwritePackedMemoryBlock(image, length, 0, 0, TRUE) : MPUwriteProgMemoryBlock(image, length, 0, 0, TRUE);
+    I2CsimGetStats(stats);
+    return ok;
+}
+
+static int check(void) {
+    static uint8_t image[MAX_IMAGE], data[MAX_IMAGE], out[MAX_IMAGE], readBack[MEMORY_SIZE];
+    static const uint16_t steps[] = { 1, 7, 16, MAX_IMAGE };
+    uint16_t length, i, n;
+    uint32_t seed = 12345;
+    I2CsimStats raw, packed, dirty;
+    char *source, *header, *expected, define[80];
+    size_t size;
+    FILE *f;
+    int failed = 0;
+
+    // round trips: the DMP image in several chunk sizes, random and degenerate data
+    length = pack(dmpMemory, MPU6050_DMP_CODE_SIZE, image, sizeof(image));
+    failed += expect(length > 0 && length < MPU6050_DMP_CODE_SIZE, "DMP image shrinks");
+    for (i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+        memset(out, 0xAA, sizeof(out));
+        failed += expect(unpack(image, length, out, steps[i]) == DMPIMAGE_OK && memcmp(out, dmpMemory, MPU6050_DMP_CODE_SIZE) == 0, "DMP image round trip");
+    }
+    for (i = 0; i < 2048; i++) {
+        seed = seed * 1103515245 + 12345;
+        data[i] = (seed >> 16) & ((i & 0x100) ? 0x03 : 0xFF);
+    }
+    n = pack(data, 2048, image, sizeof(image));
+    failed += expect(n > 0 && unpack(image, n, out, 5) == DMPIMAGE_OK && memcmp(out, data, 2048) == 0, "random data round trip");
+    memset(data, 0, 1000);
+    n = pack(data, 1000, image, sizeof(image));
+    failed += expect(n == DMPIMAGE_HEADER_SIZE + 16 && unpack(image, n, out, 64) == DMPIMAGE_OK && memcmp(out, data, 1000) == 0, "zero data round trip");
+    n = pack(data, 0, image, sizeof(image));
+    failed += expect(n == DMPIMAGE_HEADER_SIZE && unpack(image, n, out, 64) == DMPIMAGE_OK, "empty image");
+
+    // corruption is caught by the token checks or the CRC
+    length = pack(dmpMemory, MPU6050_DMP_CODE_SIZE, image, sizeof(image));
+    image[length / 2] ^= 0x01;
+    failed += expect(unpack(image, length, out, 16) != DMPIMAGE_OK, "corrupt image rejected");
+    image[length / 2] ^= 0x01;
+    failed += expect(unpack(image, length - 1, out, 16) != DMPIMAGE_OK, "truncated image rejected");
+    failed += expect(unpack(image, 2, out, 16) == DMPIMAGE_BAD_LENGTH, "missing header rejected");
+
+    // the image in the source is current
+    source = readFile(SOURCE_PATH);
+    header = readFile(HEADER_PATH);
+    failed += expect(source != NULL && header != NULL, "sources readable (run from tools/ or build with DMPPACK_SOURCE_DIR)");
+    if (source != NULL && header != NULL) {
+        f = open_memstream(&expected, &size);
+        printImage(f, image, length);
+        fclose(f);
+        snprintf(define, sizeof(define), "#define MPU6050_DMP_PACKED_SIZE     %u ", length);
+        failed += expect(strstr(source, expected) != NULL, "dmpMemoryPacked[] matches dmpMemory[]");
+        failed += expect(strstr(header, define) != NULL, "MPU6050_DMP_PACKED_SIZE matches");
+        free(expected);
+    }
+    free(source);
+    free(header);
+
+    // upload: same memory content, fewer transfers
+    failed += expect(upload(FALSE, dmpMemory, MPU6050_DMP_CODE_SIZE, FALSE, &raw), "raw upload");
+    failed += expect(upload(TRUE, image, length, FALSE, &packed), "packed upload");
+    MPUreadMemoryBlock(readBack, MPU6050_DMP_CODE_SIZE, 0, 0);
+    failed += expect(memcmp(readBack, dmpMemory, MPU6050_DMP_CODE_SIZE) == 0, "packed upload content");
+    failed += expect(packed.transactions < raw.transactions && packed.busNs < raw.busNs, "packed upload is faster");
+    failed += expect(upload(TRUE, image, length, TRUE, &dirty), "packed upload over stale memory");
+    MPUreadMemoryBlock(readBack, MPU6050_DMP_CODE_SIZE, 0, 0);
+    failed += expect(memcmp(readBack, dmpMemory, MPU6050_DMP_CODE_SIZE) == 0, "zero chunks rewritten over stale memory");
+    image[length / 2] ^= 0x01;
+    failed += expect(!upload(TRUE, image, length, FALSE, &dirty), "corrupt image upload fails");
+    image[length / 2] ^= 0x01;
+
+    printf("image %u -> %u bytes (%.1f%%)\n", MPU6050_DMP_CODE_SIZE, length, 100.0 * length / MPU6050_DMP_CODE_SIZE);
+    printf("upload raw    %u transactions, %u bytes, %.1f ms\n", raw.transactions, raw.bytes, raw.busNs / 1e6);
+    printf("upload packed %u transactions, %u bytes, %.1f ms\n", packed.transactions, packed.bytes, packed.busNs / 1e6);
+    printf(failed ? "dmppack check failed\n" : "dmppack check passed\n");
+    return failed;
+}
+
+int main(int argc, char **argv) {
+    static uint8_t image[MAX_IMAGE];
+    uint16_t length;
+
+    MPU6050(MPU6050_DEFAULT_ADDRESS);
+    if (argc == 2 && strcmp(argv[1], "check") == 0) return check() ? 1 : 0;
+    if (argc != 1) {
+        fprintf(stderr, "usage: %s [check]\n", argv[0]);
+        return 2;
+    }
+    length = pack(dmpMemory, MPU6050_DMP_CODE_SIZE, image, sizeof(image));
+    printf("#define MPU6050_DMP_PACKED_SIZE     %u     // dmpMemoryPacked[]\n\n", length);
+    printf("// packed with tools/dmppack.c from dmpMemory[] (%u bytes, CRC 0x%02X%02X)\n", MPU6050_DMP_CODE_SIZE, image[3], image[2]);
+    printImage(stdout, image, length);
+    return 0;
+}
@@ -0,0 +1,97 @@
+/* Host benchmark for MPU6050/helper_fasttrig.h
+ * Compares fastAtan2f/fastAsinf/fastAtanf against libm (float and double)
+ * for worst case error and time per call.
+ *
+ * Build and run on the host:
+ *     gcc -O2 -o fasttrig_bench fasttrig_bench.c -lm && ./fasttrig_bench
+ */
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 host tools are placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "../MPU6050/helper_fasttrig.h"
+
+#define SAMPLES     (1 << 20)
+#define ROUNDS      20
+
+static float inA[SAMPLES], inB[SAMPLES];
+static volatile float sink;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* ns per call of an atan2-shaped function over the sample set */
+#define TIME_2ARG(expr, result) do { \
+        int r_, i_; float acc_ = 0; double t0_ = now(); \
+        for (r_ = 0; r_ < ROUNDS; r_++) \
+            for (i_ = 0; i_ < SAMPLES; i_++) { float a = inA[i_], b = inB[i_]; acc_ += (expr); } \
+        sink = acc_; \
+        result = (now() - t0_) * 1e9 / ((double)ROUNDS * SAMPLES); \
+    } while (0)
+
+int main(void) {
+    int i;
+    double errAtan2 = 0, errAsin = 0, errAtan = 0, e;
+    double tFast, tFloat, tDouble;
+
+    srand(1);
+    for (i = 0; i < SAMPLES; i++) {
+        inA[i] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+        inB[i] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+    }
+
+    // accuracy against double precision libm
+    for (i = 0; i < SAMPLES; i++) {
+        e = fabs(fastAtan2f(inA[i], inB[i]) - atan2(inA[i], inB[i]));
+        if (e > errAtan2) errAtan2 = e;
+        e = fabs(fastAsinf(inA[i]) - asin(inA[i]));
+        if (e > errAsin) errAsin = e;
+        e = fabs(fastAtanf(inA[i] * 50.0f) - atan(inA[i] * 50.0f));
+        if (e > errAtan) errAtan = e;
+    }
+    printf("function   max_error_rad  bound\n");
+    printf("atan2      %.3e      %.1e\n", errAtan2, FASTTRIG_ATAN_MAX_ERROR);
+    printf("asin       %.3e      %.1e\n", errAsin, FASTTRIG_ASIN_MAX_ERROR);
+    printf("atan       %.3e      %.1e\n", errAtan, FASTTRIG_ATAN_MAX_ERROR);
+
+    printf("\nfunction   fast_ns  float_ns  double_ns\n");
+    TIME_2ARG(fastAtan2f(a, b), tFast);
+    TIME_2ARG(atan2f(a, b), tFloat);
+    TIME_2ARG((float)atan2(a, b), tDouble);
+    printf("atan2      %7.2f  %8.2f  %9.2f\n", tFast, tFloat, tDouble);
+    TIME_2ARG(fastAsinf(a) + b, tFast);
+    TIME_2ARG(asinf(a) + b, tFloat);
+    TIME_2ARG((float)asin(a) + b, tDouble);
+    printf("asin       %7.2f  %8.2f  %9.2f\n", tFast, tFloat, tDouble);
+
+    return (errAtan2 > 1e-4 || errAsin > 1e-4 || errAtan > 1e-4) ? 1 : 0;
+}
@@ -0,0 +1,145 @@
+/* Host checks for the raw-mode fusion filters (MPU6050/MPU6050_Fusion.c)
+ * Normalizes accelerometer vectors at every full scale with the Q30 helper
+ * and runs the float and Q30 Mahony filters side by side on a tilted,
+ * resting sensor at each accelerometer range. Both filters have to settle
+ * on the same attitude, at the same speed, whatever the range.
+ *
+ * Build and run on the host:
+ *     gcc -O2 -Wall -Wno-unused-function -I../i2cdev_chibi/host -I../i2cdev_chibi -I../MPU6050 -o fusioncheck \
+ *         fusioncheck.c ../i2cdev_chibi/host/chhost.c ../i2cdev_chibi/host/i2cdev_sim.c ../i2cdev_chibi/i2cdev_chibi.c \
+ *         ../MPU6050/MPU6050.c ../MPU6050/MPU6050_Fusion.c -lm
+ *     ./fusioncheck check
+ */
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 host tools are placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "MPU6050.h"
+#include "MPU6050_Fusion.h"
+#include "helper_fixmath.h"
+#include "toolcheck.h"
+
+#define RATE_HZ                 100.0f
+#define SETTLE_STEPS            600     // 6s at kp 0.5
+#define TILT_DEG                30.0f
+
+// counts per g for AFS_SEL 0..3
+static const float accelLsb[4] = { 16384.0f, 8192.0f, 4096.0f, 2048.0f };
+
+static double lengthQ30(const int32_t *v) {
+    double x = v[0] / (double)FIX_Q30_ONE, y = v[1] / (double)FIX_Q30_ONE, z = v[2] / (double)FIX_Q30_ONE;
+    return sqrt(x * x + y * y + z * z);
+}
+
+static int checkNormalize(void) {
+    static const float dirs[4][3] = { { 0, 0, 1 }, { 0.5f, -0.5f, 0.7071f }, { -1, 0, 0 }, { 0.267f, 0.535f, -0.802f } };
+    static const float gs[4] = { 0.25f, 1.0f, 1.9f, 3.9f };
+    static const int16_t tiny[3][3] = { { 1, 0, 0 }, { 0, -3, 4 }, { 90, 90, 90 } };
+    int16_t v[3];
+    int32_t out[3];
+    double worst = 0, err;
+    char what[80];
+    int failed = 0, range, d, g, i;
+
+    for (range = 0; range < 4; range++) {
+        for (d = 0; d < 4; d++) {
+            for (g = 0; g < 4; g++) {
+                if (gs[g] * accelLsb[range] >= 32767.0f) continue;
+                for (i = 0; i < 3; i++) v[i] = (int16_t)lrintf(dirs[d][i] * gs[g] * accelLsb[range]);
+                fixNormalizeVectQ30(v, out);
+                err = fabs(lengthQ30(out) - 1.0);
+                if (err > worst) worst = err;
+            }
+        }
+    }
+    failed += expect(worst < 1e-4, "raw accel normalizes to unit length at every full scale");
+    for (i = 0; i < 3; i++) {
+        snprintf(what, sizeof(what), "tiny vector %d normalizes to unit length", i);
+        failed += expect(fixNormalizeVectQ30(tiny[i], out) && fabs(lengthQ30(out) - 1.0) < 1e-4, what);
+    }
+    v[0] = v[1] = v[2] = 0;
+    failed += expect(fixNormalizeVectQ30(v, out) == 0, "zero vector is rejected");
+    printf("normalize: worst |length - 1| %.2e\n", worst);
+    return failed;
+}
+
+// roll (degrees) of a quaternion, rotation about x
+static double rollOf(double w, double x, double y, double z) {
+    return atan2(2.0 * (w * x + y * z), 1.0 - 2.0 * (x * x + y * y)) * 180.0 / M_PI;
+}
+
+static int checkFilters(void) {
+    int16_t accel[3], gyro[3] = { 0, 0, 0 };
+    double rollFloat[4], rollQ30[4], halfQ30[4];
+    MPUFusion f;
+    MPUFusionQ30 fq;
+    Quaternion q;
+    char what[80];
+    int failed = 0, range, i;
+
+    for (range = 0; range < 4; range++) {
+        // resting, rolled about x: gravity along +z in the body frame, tilted towards +y
+        accel[0] = 0;
+        accel[1] = (int16_t)lrintf(sinf(TILT_DEG * (float)M_PI / 180.0f) * accelLsb[range]);
+        accel[2] = (int16_t)lrintf(cosf(TILT_DEG * (float)M_PI / 180.0f) * accelLsb[range]);
+        MPUfusionInit(&f, RATE_HZ, MPU6050_GYRO_FS_250, MPU6050_FUSION_DEFAULT_KP, 0.0f);
+        MPUfusionInitQ30(&fq, RATE_HZ, MPU6050_GYRO_FS_250, MPU6050_FUSION_DEFAULT_KP, 0.0f);
+        halfQ30[range] = 0;
+        for (i = 0; i < SETTLE_STEPS; i++) {
+            MPUfusionUpdate(&f, accel, gyro);
+            MPUfusionUpdateQ30(&fq, accel, gyro);
+            if (i == SETTLE_STEPS / 10) {
+                q = getQuatFloatFromQ30(&fq.q);
+                halfQ30[range] = rollOf(q.w, q.x, q.y, q.z);
+            }
+        }
+        rollFloat[range] = rollOf(f.q.w, f.q.x, f.q.y, f.q.z);
+        q = getQuatFloatFromQ30(&fq.q);
+        rollQ30[range] = rollOf(q.w, q.x, q.y, q.z);
+        printf("range %d: roll float %.3f Q30 %.3f, Q30 after %d steps %.3f\n", range, rollFloat[range], rollQ30[range], SETTLE_STEPS / 10, halfQ30[range]);
+        snprintf(what, sizeof(what), "AFS_SEL %d: Q30 filter settles like the float filter", range);
+        failed += expect(fabs(rollQ30[range] - rollFloat[range]) < 0.05 && fabs(fabs(rollFloat[range]) - TILT_DEG) < 0.5, what);
+        snprintf(what, sizeof(what), "AFS_SEL %d: Q30 feedback gain does not depend on the range", range);
+        failed += expect(fabs(halfQ30[range] - halfQ30[0]) < 0.05, what);
+    }
+    return failed;
+}
+
+static int check(void) {
+    int failed = checkNormalize() + checkFilters();
+    printf(failed ? "fusioncheck check failed\n" : "fusioncheck check passed\n");
+    return failed;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 2 && strcmp(argv[1], "check") == 0) return check() ? 1 : 0;
+    fprintf(stderr, "usage: %s check\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,493 @@
+/* Host benchmarks for the driver hot paths
+ * Runs MPUgetMotion6(), the FIFO drain, MPUdmpReadAndProcessFIFOPacket() and
+ * MPUdmpInitialize() against the simulated MPU6050 (i2cdev_sim.h) and
+ * reports per call: bus time from the timing model, elapsed virtual time
+ * (bus plus sleeps), host CPU time, transactions and data bytes.
+ *
+ * Build and run on the host:
+ *     gcc -O2 -Wall -Wno-unused-function -I../i2cdev_chibi/host -I../i2cdev_chibi -I../MPU6050 -o i2cbench \
+ *         i2cbench.c ../i2cdev_chibi/host/chhost.c ../i2cdev_chibi/host/i2cdev_sim.c ../i2cdev_chibi/i2cdev_chibi.c \
+ *         ../MPU6050/MPU6050.c ../MPU6050/MPU6050_6Axis_MotionApps20.c ../MPU6050/MPU6050_Calibration.c -lm
+ *     ./i2cbench check
+ * Add -DMPU6050_STATIC_SCRATCH=TRUE -DI2CDEV_STATIC_SCRATCH=TRUE for the
+ * static scratch arena mode.
+ * Add -DI2CDEV_ARBITER=TRUE to check transfer slicing and busy retries, and
+ * -DI2CDEV_ARB_TEST=TRUE as well for yielding.
+ *     ./i2cbench > new.jsonl                  100kHz, 400kHz and 1MHz
+ *     ./i2cbench busHz conditionClocks stretchNs stretchByteNs > new.jsonl
+ *     ./i2cbench compare old.jsonl new.jsonl [tolerancePercent [cpuTolerancePercent]]
+ *
+ * Output is one JSON object per benchmark and timing model. 'compare' exits
+ * with 1 if a deterministic metric (bus, elapsed, transactions, bytes) grew
+ * by more than the tolerance (default 1%), or the CPU time by more than the
+ * CPU tolerance (default off, the host is noisy).
+ */
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 host tools are placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "i2cdev_chibi.h"
+#include "i2cdev_sim.h"
+#include "MPU6050.h"
+#include "MPU6050_6Axis_MotionApps20.h"
+#include "toolcheck.h"
+
+#define MAX_RESULTS     64
+
+typedef struct {
+        const char *name;
+        uint32_t calls;
+        void (*setup)(void);
+        uint8_t (*run)(void);           // 0 on success
+} Benchmark;
+
+typedef struct {
+        char name[32];
+        uint32_t busHz;
+        uint32_t calls;
+        double transactions;            // all per call
+        double bytes;
+        double busUs;
+        double elapsedUs;
+        double cpuNs;
+} Result;
+
+static int16_t sink[6];
+#if MPU6050_STATIC_SCRATCH
+static uint8_t mpuScratch[MPU6050_SCRATCH_SIZE];
+#endif
+#if I2CDEV_STATIC_SCRATCH
+static uint8_t i2cScratch[I2CDEV_SCRATCH_SIZE];
+#endif
+
+static uint64_t cpuNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void setupAwake(void) {
+    MPUinitialize();
+}
+
+static void setupDMP(void) {
+    MPUinitialize();
+    MPUdmpInitialize();
+    MPUsetDMPEnabled(TRUE);
+    MPUresetFIFO();
+}
+
+static uint8_t runMotion6(void) {
+    MPUgetMotion6(&sink[0], &sink[1], &sink[2], &sink[3], &sink[4], &sink[5]);
+    return 0;
+}
+
+static uint8_t runAcceleration(void) {
+    MPUgetAcceleration(&sink[0], &sink[1], &sink[2]);
+    return 0;
+}
+
+// the usual polling loop: count, then one packet if there is one
+static uint8_t runDrain(void) {
+    uint8_t buffer[64];
+    I2CsimFillFIFO(MPUdmpGetFIFOPacketSize());
+    if (MPUgetFIFOCount() < MPUdmpGetFIFOPacketSize()) return 1;
+    MPUgetFIFOBytes(buffer, MPUdmpGetFIFOPacketSize());
+    return 0;
+}
+
+static uint8_t runProcessPacket(void) {
+    I2CsimFillFIFO(MPUdmpGetFIFOPacketSize());
+    return MPUdmpReadAndProcessFIFOPacket(1, 0);
+}
+
+static uint8_t runDMPInitialize(void) {
+    return MPUdmpInitialize();
+}
+
+static const Benchmark benchmarks[] = {
+    { "getMotion6", 1000, setupAwake, runMotion6 },
+    { "getAcceleration", 1000, setupAwake, runAcceleration },
+    { "fifoDrain", 1000, setupDMP, runDrain },
+    { "dmpReadAndProcessFIFOPacket", 1000, setupDMP, runProcessPacket },
+    { "dmpInitialize", 10, setupAwake, runDMPInitialize },
+};
+#define BENCHMARK_COUNT (sizeof(benchmarks) / sizeof(benchmarks[0]))
+
+static uint8_t measure(const Benchmark *bench, const I2CsimTiming *timing, Result *result) {
+    I2CsimStats stats;
+    uint64_t start, cpu;
+    uint32_t i;
+    uint8_t status = 0;
+
+    I2CsimStart(timing);
+    bench -> setup();
+    I2CsimResetStats();
+    start = chHostTimeNs();
+    cpu = cpuNs();
+    for (i = 0; i < bench -> calls && status == 0; i++) status = bench -> run();
+    cpu = cpuNs() - cpu;
+    I2CsimGetStats(&stats);
+
+    snprintf(result -> name, sizeof(result -> name), "%s", bench -> name);
+    result -> busHz = timing -> busHz;
+    result -> calls = bench -> calls;
+    result -> transactions = (double)stats.transactions / bench -> calls;
+    result -> bytes = (double)stats.bytes / bench -> calls;
+    result -> busUs = stats.busNs / 1000.0 / bench -> calls;
+    result -> elapsedUs = (chHostTimeNs() - start) / 1000.0 / bench -> calls;
+    result -> cpuNs = (double)cpu / bench -> calls;
+    if (stats.failed > 0 && status == 0) status = 0xFF;
+    return status;
+}
+
+static void printResult(const Result *result) {
+    printf("{\"bench\":\"%s\",\"bus_hz\":%u,\"calls\":%u,\"transactions\":%.3f,\"bytes\":%.3f,"
+        "\"bus_us\":%.3f,\"elapsed_us\":%.3f,\"cpu_ns\":%.1f}\n",
+        result -> name, result -> busHz, result -> calls, result -> transactions, result -> bytes,
+        result -> busUs, result -> elapsedUs, result -> cpuNs);
+}
+
+static int parseResult(const char *line, Result *result) {
+    return sscanf(line, "{\"bench\":\"%31[^\"]\",\"bus_hz\":%u,\"calls\":%u,\"transactions\":%lf,\"bytes\":%lf,"
+        "\"bus_us\":%lf,\"elapsed_us\":%lf,\"cpu_ns\":%lf}",
+        result -> name, &result -> busHz, &result -> calls, &result -> transactions, &result -> bytes,
+        &result -> busUs, &result -> elapsedUs, &result -> cpuNs) == 8;
+}
+
+static int runAll(const I2CsimTiming *timings, uint8_t count) {
+    Result result;
+    uint8_t t, status, failed = 0;
+    uint32_t b;
+
+    for (t = 0; t < count; t++) {
+        for (b = 0; b < BENCHMARK_COUNT; b++) {
+            status = measure(&benchmarks[b], &timings[t], &result);
+            if (status != 0) {
+                fprintf(stderr, "%s at %uHz failed (%u)\n", benchmarks[b].name, timings[t].busHz, status);
+                failed = 1;
+                continue;
+            }
+            printResult(&result);
+        }
+    }
+    return failed;
+}
+
+static uint32_t load(const char *path, Result *results) {
+    char line[256];
+    uint32_t count = 0;
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        perror(path);
+        return 0;
+    }
+    while (count < MAX_RESULTS && fgets(line, sizeof(line), f) != NULL) {
+        if (parseResult(line, &results[count])) count++;
+    }
+    fclose(f);
+    return count;
+}
+
+static int worse(const char *name, uint32_t busHz, const char *metric, double old, double now, double tolerance) {
+    if (tolerance < 0 || now <= old * (1.0 + tolerance / 100.0) + 1e-9) return 0;
+    printf("REGRESSION %s@%u %s: %.3f -> %.3f (%+.1f%%)\n", name, busHz, metric, old, now,
+        old > 0 ? (now - old) * 100.0 / old : 100.0);
+    return 1;
+}
+
+static int compareResults(const Result *old, uint32_t oldCount, const Result *now, uint32_t nowCount, double tolerance, double cpuTolerance) {
+    uint32_t i, j;
+    int regressions = 0;
+    for (i = 0; i < nowCount; i++) {
+        for (j = 0; j < oldCount; j++) {
+            if (strcmp(old[j].name, now[i].name) == 0 && old[j].busHz == now[i].busHz) break;
+        }
+        if (j == oldCount) {
+            printf("new %s@%u\n", now[i].name, now[i].busHz);
+            continue;
+        }
+        regressions += worse(now[i].name, now[i].busHz, "transactions", old[j].transactions, now[i].transactions, tolerance);
+        regressions += worse(now[i].name, now[i].busHz, "bytes", old[j].bytes, now[i].bytes, tolerance);
+        regressions += worse(now[i].name, now[i].busHz, "bus_us", old[j].busUs, now[i].busUs, tolerance);
+        regressions += worse(now[i].name, now[i].busHz, "elapsed_us", old[j].elapsedUs, now[i].elapsedUs, tolerance);
+        regressions += worse(now[i].name, now[i].busHz, "cpu_ns", old[j].cpuNs, now[i].cpuNs, cpuTolerance);
+    }
+    return regressions;
+}
+
+static int compare(int argc, char **argv) {
+    static Result old[MAX_RESULTS], now[MAX_RESULTS];
+    uint32_t oldCount = load(argv[2], old), nowCount = load(argv[3], now);
+    double tolerance = (argc > 4) ? atof(argv[4]) : 1.0;
+    double cpuTolerance = (argc > 5) ? atof(argv[5]) : -1.0;
+    int regressions;
+
+    if (oldCount == 0 || nowCount == 0) {
+        fprintf(stderr, "no results\n");
+        return 2;
+    }
+    regressions = compareResults(old, oldCount, now, nowCount, tolerance, cpuTolerance);
+    printf("%u benchmarks, %d regressions\n", nowCount, regressions);
+    return regressions > 0 ? 1 : 0;
+}
+
+#if I2CDEV_ARBITER && I2CDEV_ARB_TEST
+#define ARB_CHECK_ADDRESS       0x10        // CRITICAL device, not on the bus: NACKs, but waits like any other
+
+static bool_t arbCriticalPending;
+
+// a critical transfer starts waiting in the middle of the second slice
+static void arbCriticalArrives(uint32_t transaction) {
+    if (transaction != 1) return;
+    I2CdevarbWait(I2CDEV_CLASS_CRITICAL);
+    arbCriticalPending = TRUE;
+}
+
+// and gets the bus as soon as it is released
+static void arbCriticalRuns(void) {
+    uint8_t value;
+    if (!arbCriticalPending) return;
+    arbCriticalPending = FALSE;
+    I2CdevreadByte(ARB_CHECK_ADDRESS, MPU6050_RA_WHO_AM_I, &value, I2CDEV_DEFAULT_READ_TIMEOUT);
+}
+#endif
+
+static int check(void) {
+    static const I2CsimTiming fast = I2CSIM_TIMING_400K, slow = I2CSIM_TIMING_100K;
+    I2CsimTiming stretched = I2CSIM_TIMING_400K;
+    Result a, b, c;
+    int failed = 0;
+
+    // 14 byte read: S addr reg Sr addr data[14] P, 17 bytes * 9 + 3 conditions
+    failed += expect(measure(&benchmarks[0], &fast, &a) == 0, "getMotion6 runs");
+    failed += expect(a.transactions == 1.0 && a.bytes == 14.0, "getMotion6 is one 14 byte read");
+    failed += expect(a.busUs > 389.9 && a.busUs < 390.1, "getMotion6 takes 156 clocks at 400kHz");
+    failed += expect(measure(&benchmarks[0], &slow, &b) == 0 && b.busUs > 4 * a.busUs - 0.01 && b.busUs < 4 * a.busUs + 0.01, "bus time scales with the clock");
+    stretched.stretchNs = 1000;
+    stretched.stretchByteNs = 100;
+    failed += expect(measure(&benchmarks[0], &stretched, &c) == 0 && c.busUs > a.busUs + 2.39 && c.busUs < a.busUs + 2.41, "clock stretching is added");
+
+    failed += expect(measure(&benchmarks[4], &fast, &a) == 0, "dmpInitialize succeeds on the simulator");
+    failed += expect(a.elapsedUs > a.busUs, "dmpInitialize sleeps are counted");
+    failed += expect(measure(&benchmarks[3], &fast, &a) == 0 && a.bytes == 42.0, "dmpReadAndProcessFIFOPacket reads one packet");
+    failed += expect(measure(&benchmarks[2], &fast, &b) == 0 && b.transactions == 2.0, "drain is a count and a packet read");
+
+#if I2CDEV_ERRLOG
+    // an error storm is counted, only I2CDEV_ERRLOG_RATE records per second are kept
+    {
+        I2CdevError e;
+        uint8_t buffer[2];
+        uint32_t logged = 0, total = I2CdeverrlogTotal(), suppressed = I2CdeverrlogSuppressed();
+        int i;
+        I2CsimStart(&fast);
+        while (I2CdeverrlogRead(&e));
+        for (i = 0; i < 1000; i++) I2CdevreadBytes(0x10, MPU6050_RA_WHO_AM_I, 1, buffer, I2CDEV_DEFAULT_READ_TIMEOUT);
+        I2CdevreadBytes(MPU6050_DEFAULT_ADDRESS, MPU6050_RA_WHO_AM_I, I2CDEV_BUFFER_LENGTH + 1, buffer, I2CDEV_DEFAULT_READ_TIMEOUT);
+        while (I2CdeverrlogRead(&e)) {
+            if (logged == 0) failed += expect(e.code == I2CDEV_ERROR_BUS && e.devAddr == 0x10, "bus error is logged");
+            logged++;
+        }
+        failed += expect(I2CdeverrlogTotal() - total == 1001, "every error is counted");
+        failed += expect(logged == I2CDEV_ERRLOG_RATE && I2CdeverrlogSuppressed() - suppressed == 1001 - logged, "storm is rate limited");
+    }
+#endif
+
+    // the cached scales follow the range only if the device took it
+    I2CsimStart(&fast);
+    MPUsetFullScaleAccelRange(MPU6050_ACCEL_FS_8);
+    MPUsetFullScaleGyroRange(MPU6050_GYRO_FS_1000);
+    I2CsimNack(2);
+    MPUsetFullScaleAccelRange(MPU6050_ACCEL_FS_16);
+    MPUsetFullScaleGyroRange(MPU6050_GYRO_FS_2000);
+    failed += expect(MPUgetFullScaleAccelRange() == MPU6050_ACCEL_FS_8 && MPUgetAccelScale() == MPUgetAccelScaleForRange(MPU6050_ACCEL_FS_8)
+        && MPUgetFullScaleGyroRange() == MPU6050_GYRO_FS_1000 && MPUgetGyroScale() == MPUgetGyroScaleForRange(MPU6050_GYRO_FS_1000), "failed range write keeps the scales");
+
+#if I2CDEV_ARBITER
+    // a BULK device is read in slices that stop at page boundaries, CRITICAL in one go
+    {
+        I2CsimStats stats;
+        I2CdevArbStats arb;
+        uint8_t whole[32], sliced[32];
+        int i;
+        I2CsimStart(&fast);
+        I2CsimResetStats();
+        I2CdevreadBytes(MPU6050_DEFAULT_ADDRESS, MPU6050_RA_SELF_TEST_X, sizeof(whole), whole, I2CDEV_DEFAULT_READ_TIMEOUT);
+        I2CsimGetStats(&stats);
+        failed += expect(stats.transactions == 1, "critical read is one transaction");
+        I2CdevarbResetStats();
+        failed += expect(I2CdevarbSetDevice(MPU6050_DEFAULT_ADDRESS, I2CDEV_CLASS_BULK, 16, 8, 0), "device registers as bulk");
+        I2CsimResetStats();
+        failed += expect(I2CdevreadBytes(MPU6050_DEFAULT_ADDRESS, MPU6050_RA_SELF_TEST_X, sizeof(sliced), sliced, I2CDEV_DEFAULT_READ_TIMEOUT), "sliced read succeeds");
+        I2CsimGetStats(&stats);
+        I2CdevarbGetStats(I2CDEV_CLASS_BULK, &arb);
+        // 0x0D: 3 bytes to the page end at 0x10, then 8, 8, 8 and 5
+        failed += expect(stats.transactions == 5 && arb.slices == 5 && arb.transfers == 1, "read is split at page boundaries");
+        failed += expect(memcmp(whole, sliced, sizeof(whole)) == 0, "slices return the same data");
+        for (i = 0; i < (int)sizeof(sliced); i++) sliced[i] = (uint8_t)(0xA0 + i);
+        I2CsimResetStats();
+        failed += expect(I2CdevwriteBytes(MPU6050_DEFAULT_ADDRESS, MPU6050_RA_SELF_TEST_X, sizeof(sliced), sliced), "sliced write succeeds");
+        I2CsimGetStats(&stats);
+        failed += expect(stats.transactions == 5, "write is split at page boundaries");
+        I2CdevarbSetDevice(MPU6050_DEFAULT_ADDRESS, I2CDEV_CLASS_CRITICAL, 0, 0, 0);
+        I2CsimResetStats();
+        I2CdevreadBytes(MPU6050_DEFAULT_ADDRESS, MPU6050_RA_SELF_TEST_X, sizeof(whole), whole, I2CDEV_DEFAULT_READ_TIMEOUT);
+        I2CsimGetStats(&stats);
+        failed += expect(stats.transactions == 1, "removed device is critical again");
+        failed += expect(memcmp(whole, sliced, sizeof(whole)) == 0, "slices write every byte");
+    }
+    // a full 64 byte page is written in slices, only a slice has to fit the scratch buffer
+    {
+        I2CsimStats stats;
+        uint8_t page[64], back[64];
+        int i;
+        I2CsimStart(&fast);
+        for (i = 0; i < (int)sizeof(page); i++) page[i] = (uint8_t)(0x40 + i);
+        failed += expect(!I2CdevwriteBytes(MPU6050_DEFAULT_ADDRESS, 0x00, sizeof(page), page), "critical 64 byte write does not fit");
+        I2CdevarbSetDevice(MPU6050_DEFAULT_ADDRESS, I2CDEV_CLASS_BULK, 32, 64, 0);
+        I2CsimResetStats();
+        failed += expect(I2CdevwriteBytes(MPU6050_DEFAULT_ADDRESS, 0x00, sizeof(page), page), "64 byte page write succeeds");
+        I2CsimGetStats(&stats);
+        failed += expect(stats.transactions == 2 && stats.bytes == 64, "page write is two slices");
+        I2CdevarbSetDevice(MPU6050_DEFAULT_ADDRESS, I2CDEV_CLASS_BULK, 0, 64, 0);
+        failed += expect(!I2CdevwriteBytes(MPU6050_DEFAULT_ADDRESS, 0x00, sizeof(page), page), "unsliced 64 byte page does not fit");
+        I2CdevarbSetDevice(MPU6050_DEFAULT_ADDRESS, I2CDEV_CLASS_CRITICAL, 0, 0, 0);
+        I2CdevreadBytes(MPU6050_DEFAULT_ADDRESS, 0x00, sizeof(back), back, I2CDEV_DEFAULT_READ_TIMEOUT);
+        back[MPU6050_RA_INT_STATUS] = page[MPU6050_RA_INT_STATUS];     // read-only in the simulator
+        failed += expect(memcmp(page, back, sizeof(page)) == 0, "page write stores every byte");
+    }
+    // a NACKing device is polled with the bus released, up to busyMs
+    {
+        I2CsimStats stats;
+        I2CdevArbStats arb;
+        uint8_t data[8];
+        uint32_t slept;
+        I2CsimStart(&fast);
+        I2CdevarbSetDevice(MPU6050_DEFAULT_ADDRESS, I2CDEV_CLASS_BULK, 0, 0, 10);
+        I2CdevarbResetStats();
+        I2CsimNack(3);
+        slept = chHostSleptMs();
+        failed += expect(I2CdevreadBytes(MPU6050_DEFAULT_ADDRESS, MPU6050_RA_SELF_TEST_X, sizeof(data), data, I2CDEV_DEFAULT_READ_TIMEOUT), "busy device is read after its write cycle");
+        I2CsimGetStats(&stats);
+        I2CdevarbGetStats(I2CDEV_CLASS_BULK, &arb);
+        failed += expect(arb.retries == 3 && arb.slices == 4 && stats.failed == 3 && chHostSleptMs() - slept == 3, "each NACK is one retry and one poll interval");
+        I2CdevarbResetStats();
+        I2CsimNack(100);
+        failed += expect(!I2CdevreadBytes(MPU6050_DEFAULT_ADDRESS, MPU6050_RA_SELF_TEST_X, sizeof(data), data, I2CDEV_DEFAULT_READ_TIMEOUT), "device busy for too long fails");
+        I2CdevarbGetStats(I2CDEV_CLASS_BULK, &arb);
+        // one poll interval plus the failed attempt per retry
+        failed += expect(arb.retries >= 5 && arb.retries < 10, "retries stop after busyMs");
+        I2CdevarbSetDevice(MPU6050_DEFAULT_ADDRESS, I2CDEV_CLASS_BULK, 0, 0, 0);
+        I2CdevarbResetStats();
+        I2CsimNack(1);
+        failed += expect(!I2CdevreadBytes(MPU6050_DEFAULT_ADDRESS, MPU6050_RA_SELF_TEST_X, sizeof(data), data, I2CDEV_DEFAULT_READ_TIMEOUT), "NACK fails at once without busyMs");
+        I2CdevarbGetStats(I2CDEV_CLASS_BULK, &arb);
+        failed += expect(arb.retries == 0 && arb.slices == 1, "no retry without busyMs");
+        I2CsimNack(0);
+    }
+#if I2CDEV_ARB_TEST
+    // a critical transfer waits for at most one slice of a bulk transfer
+    {
+        I2CsimTiming crawl = I2CSIM_TIMING_400K;
+        I2CsimStats stats;
+        I2CdevArbStats bulk, critical;
+        uint8_t whole[32], sliced[32];
+        uint32_t sliceTicks, wholeTicks;
+        crawl.stretchByteNs = 1000000;          // 1ms per byte, far above the tick
+        I2CsimStart(&crawl);
+        I2CdevarbSetDevice(MPU6050_DEFAULT_ADDRESS, I2CDEV_CLASS_CRITICAL, 0, 0, 0);
+        I2CdevreadBytes(MPU6050_DEFAULT_ADDRESS, MPU6050_RA_SELF_TEST_X, sizeof(whole), whole, I2CDEV_DEFAULT_READ_TIMEOUT);
+        I2CsimGetStats(&stats);
+        wholeTicks = (uint32_t)(stats.busNs / (1000000000 / CH_FREQUENCY));
+        I2CdevarbSetDevice(MPU6050_DEFAULT_ADDRESS, I2CDEV_CLASS_BULK, 8, 0, 0);
+        I2CsimResetStats();
+        I2CdevreadBytes(MPU6050_DEFAULT_ADDRESS, MPU6050_RA_SELF_TEST_X, 8, sliced, I2CDEV_DEFAULT_READ_TIMEOUT);
+        I2CsimGetStats(&stats);
+        sliceTicks = (uint32_t)(stats.busNs / (1000000000 / CH_FREQUENCY)) + 1;
+        I2CdevarbResetStats();
+        I2CsimSetHook(arbCriticalArrives);
+        chHostSetReleaseHook(arbCriticalRuns);
+        failed += expect(I2CdevreadBytes(MPU6050_DEFAULT_ADDRESS, MPU6050_RA_SELF_TEST_X, sizeof(sliced), sliced, I2CDEV_DEFAULT_READ_TIMEOUT), "bulk read around a critical one succeeds");
+        chHostSetReleaseHook(NULL);
+        I2CsimSetHook(NULL);
+        I2CdevarbGetStats(I2CDEV_CLASS_BULK, &bulk);
+        I2CdevarbGetStats(I2CDEV_CLASS_CRITICAL, &critical);
+        failed += expect(bulk.yields == 1 && bulk.slices == 4 && critical.transfers == 1, "bulk yields once to the waiting critical transfer");
+        failed += expect(critical.maxWait > 0 && critical.maxWait <= sliceTicks && sliceTicks < wholeTicks / 2, "critical wait is bounded by one slice");
+        failed += expect(memcmp(whole, sliced, sizeof(whole)) == 0, "yielding keeps the data");
+        I2CdevarbSetDevice(MPU6050_DEFAULT_ADDRESS, I2CDEV_CLASS_CRITICAL, 0, 0, 0);
+    }
+#endif
+#endif
+
+    // compare: identical passes, 2% more bus time fails, CPU noise is ignored by default
+    b = a;
+    failed += expect(compareResults(&a, 1, &b, 1, 1.0, -1.0) == 0, "compare accepts identical results");
+    b.cpuNs = a.cpuNs * 3;
+    failed += expect(compareResults(&a, 1, &b, 1, 1.0, -1.0) == 0, "compare ignores CPU time by default");
+    b.busUs = a.busUs * 1.02;
+    failed += expect(compareResults(&a, 1, &b, 1, 1.0, -1.0) == 1, "compare flags 2% more bus time");
+    failed += expect(parseResult("{\"bench\":\"x\",\"bus_hz\":400000,\"calls\":1,\"transactions\":1.000,\"bytes\":2.000,"
+        "\"bus_us\":3.000,\"elapsed_us\":4.000,\"cpu_ns\":5.0}", &c) && c.busHz == 400000 && c.cpuNs == 5.0, "results parse back");
+
+    printf(failed ? "i2cbench check failed\n" : "i2cbench check passed\n");
+    return failed;
+}
+
+int main(int argc, char **argv) {
+    static const I2CsimTiming standard[] = { I2CSIM_TIMING_100K, I2CSIM_TIMING_400K, I2CSIM_TIMING_1M };
+    I2CsimTiming custom;
+
+    MPU6050(MPU6050_DEFAULT_ADDRESS);
+#if MPU6050_STATIC_SCRATCH
+    MPUsetScratch(&mpuScratch);
+#endif
+#if I2CDEV_STATIC_SCRATCH
+    I2CdevsetScratch(&i2cScratch);
+#endif
+    if (argc == 2 && strcmp(argv[1], "check") == 0) return check() ? 1 : 0;
+    if (argc >= 4 && strcmp(argv[1], "compare") == 0) return compare(argc, argv);
+    if (argc == 5) {
+        custom.busHz = strtoul(argv[1], NULL, 0);
+        custom.conditionClocks = (uint8_t)strtoul(argv[2], NULL, 0);
+        custom.stretchNs = strtoul(argv[3], NULL, 0);
+        custom.stretchByteNs = strtoul(argv[4], NULL, 0);
+        if (custom.busHz == 0) {
+            fprintf(stderr, "busHz must not be 0\n");
+            return 2;
+        }
+        return runAll(&custom, 1);
+    }
+    if (argc == 1) return runAll(standard, 3);
+    fprintf(stderr, "usage: %s [check | compare old new [tolerance [cpuTolerance]] | busHz conditionClocks stretchNs stretchByteNs]\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,237 @@
+/* Host replay of I2C traces recorded with I2CDEV_TRACE
+ * Runs the unchanged drivers against a capture: DMP initialization, FIFO
+ * drain and packet decoding are re-executed and timed deterministically.
+ *
+ * Build and run on the host:
+ *     gcc -O2 -Wall -Wno-unused-function -DI2CDEV_TRACE=TRUE -I../i2cdev_chibi/host -I../i2cdev_chibi -I../MPU6050 -o i2creplay \
+ *         i2creplay.c ../i2cdev_chibi/host/chhost.c ../i2cdev_chibi/host/i2cdev_replay.c ../i2cdev_chibi/i2cdev_chibi.c \
+ *         ../MPU6050/MPU6050.c ../MPU6050/MPU6050_6Axis_MotionApps20.c ../MPU6050/MPU6050_Calibration.c -lm
+ *     ./i2creplay check
+ *     ./i2creplay dump trace.bin
+ *     ./i2creplay dmp trace.bin
+ *
+ * 'dmp' expects a capture of the standard sequence: MPUinitialize(),
+ * MPUdmpInitialize(), MPUsetDMPEnabled(TRUE), then FIFO_COUNT polls each
+ * followed by one MPUgetFIFOBytes() per complete packet.
+ */
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 host tools are placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "i2cdev_chibi.h"
+#include "i2cdev_replay.h"
+#include "MPU6050.h"
+#include "MPU6050_6Axis_MotionApps20.h"
+#include "toolcheck.h"
+
+#define MAX_TRACE       (16 * 1024 * 1024)
+
+static uint8_t rerecorded[8192];
+
+static double hostSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint8_t *loadTrace(const char *path, uint32_t *length) {
+    uint8_t *data = malloc(MAX_TRACE);
+    FILE *f = fopen(path, "rb");
+    if (f == 0 || data == 0) {
+        perror(path);
+        exit(1);
+    }
+    *length = (uint32_t)fread(data, 1, MAX_TRACE, f);
+    fclose(f);
+    return data;
+}
+
+static void printRecord(uint32_t index, const I2CdevTraceRecord *record) {
+    uint8_t i;
+    printf("%6lu +%5u %s 0x%02X reg 0x%02X len %3u %s", (unsigned long)index, record -> delta, record -> read ? "R" : "W",
+           record -> devAddr, record -> regAddr, record -> length,
+           record -> result == I2CDEV_TRACE_OK ? "ok " : record -> result == I2CDEV_TRACE_TIMEOUT ? "tmo" : "rst");
+    for (i = 0; record -> payload && i < record -> length && i < 16; i++) printf(" %02X", record -> payload[i]);
+    if (record -> payload && record -> length > 16) printf(" ...");
+    printf("\n");
+}
+
+static int report(void) {
+    I2CdevTraceRecord expected, actual;
+    uint8_t status = I2CreplayGetStatus();
+    printf("records         %lu consumed\n", (unsigned long)I2CreplayGetIndex());
+    printf("write mismatch  %lu\n", (unsigned long)I2CreplayGetWriteMismatches());
+    printf("trace time      %lu ticks\n", (unsigned long)chTimeNow());
+    if (status == I2CREPLAY_DIVERGED) {
+        I2CreplayGetDivergence(&expected, &actual);
+        printf("DIVERGED at record %lu\n  expected: ", (unsigned long)I2CreplayGetIndex());
+        printRecord(I2CreplayGetIndex(), &expected);
+        printf("  actual:   ");
+        printRecord(I2CreplayGetIndex(), &actual);
+        return 1;
+    }
+    return 0;
+}
+
+static int dump(const char *path) {
+    I2CdevTraceRecord record;
+    uint32_t length, pos = 0, index = 0;
+    uint16_t size;
+    uint8_t *data = loadTrace(path, &length);
+    while ((size = i2cdevTraceDecode(data + pos, length - pos, &record)) != 0) {
+        printRecord(index++, &record);
+        pos += size;
+    }
+    if (pos != length) printf("%lu trailing bytes\n", (unsigned long)(length - pos));
+    free(data);
+    return 0;
+}
+
+static int dmp(const char *path) {
+    uint8_t packet[64];
+    uint16_t count, packetSize;
+    uint32_t length, packets = 0;
+    double start, init, drain;
+    Quaternion q;
+    uint8_t *data = loadTrace(path, &length);
+
+    I2CreplayStart(data, length);
+    start = hostSeconds();
+    MPUinitialize();
+    MPUdmpInitialize();
+    MPUsetDMPEnabled(TRUE);
+    init = hostSeconds() - start;
+    packetSize = MPUdmpGetFIFOPacketSize();
+    if (I2CreplayGetStatus() != I2CREPLAY_RUNNING) {
+        printf("trace ended or diverged during initialization\n");
+        report();
+        free(data);
+        return 1;
+    }
+
+    start = hostSeconds();
+    while (I2CreplayGetStatus() == I2CREPLAY_RUNNING) {
+        count = MPUgetFIFOCount();
+        while (count >= packetSize && I2CreplayGetStatus() == I2CREPLAY_RUNNING) {
+            MPUgetFIFOBytes(packet, (uint8_t)packetSize);
+            MPUdmpGetQuaternion(&q, packet);
+            count -= packetSize;
+            packets++;
+        }
+    }
+    drain = hostSeconds() - start;
+
+    printf("init            %.3fms host\n", init * 1e3);
+    printf("drain           %.3fms host, %lu packets, %.2fus/packet\n", drain * 1e3, (unsigned long)packets, packets ? drain * 1e6 / packets : 0.0);
+    if (packets) printf("last quaternion %.4f %.4f %.4f %.4f\n", q.w, q.x, q.y, q.z);
+    free(data);
+    return report();
+}
+
+static uint32_t append(uint8_t *trace, uint32_t pos, uint8_t read, uint8_t reg, uint8_t length, uint16_t delta, const uint8_t *payload) {
+    I2CdevTraceRecord record;
+    record.devAddr = MPU6050_DEFAULT_ADDRESS;
+    record.regAddr = reg;
+    record.read = read;
+    record.length = length;
+    record.result = I2CDEV_TRACE_OK;
+    record.delta = delta;
+    i2cdevTraceEncodeHeader(trace + pos, &record);
+    memcpy(trace + pos + I2CDEV_TRACE_HEADER, payload, length);
+    return pos + I2CDEV_TRACE_HEADER + length;
+}
+
+static int check(void) {
+    static const uint8_t whoAmI[1] = { 0x68 }, rate[1] = { 4 }, accel[6] = { 0x01, 0x02, 0xFF, 0xFE, 0x40, 0x00 };
+    uint8_t trace[256];
+    uint32_t length = 0;
+    I2CdevTraceRecord record;
+    uint16_t dumped, size;
+    uint32_t pos, last = 0;
+    int16_t x, y, z;
+    int failures = 0, i;
+
+    length = append(trace, length, 1, MPU6050_RA_WHO_AM_I, 1, 0, whoAmI);
+    length = append(trace, length, 0, MPU6050_RA_SMPLRT_DIV, 1, 5, rate);
+    length = append(trace, length, 1, MPU6050_RA_ACCEL_XOUT_H, 6, 300, accel);
+
+    // replaying while recording gives the input back
+    I2CdevtraceClear();
+    I2CdevtraceEnable(TRUE);
+    I2CreplayStart(trace, length);
+    failures += expect(MPUtestConnection(), "WHO_AM_I from the trace");
+    MPUsetRate(4);
+    MPUgetAcceleration(&x, &y, &z);
+    failures += expect(x == 0x0102 && y == -2 && z == 0x4000, "payload returned");
+    failures += expect(I2CreplayGetStatus() == I2CREPLAY_END, "trace consumed");
+    failures += expect(I2CreplayGetWriteMismatches() == 0, "no write mismatch");
+    failures += expect(chTimeNow() == 305, "trace clock");
+    I2CdevtraceEnable(FALSE);
+    dumped = I2CdevtraceDump(rerecorded, sizeof(rerecorded));
+    failures += expect(dumped == length && memcmp(rerecorded, trace, length) == 0, "re-recorded trace identical");
+
+    // a changed write payload is counted, a different transfer stops the replay
+    I2CreplayStart(trace, length);
+    MPUtestConnection();
+    MPUsetRate(9);
+    failures += expect(I2CreplayGetWriteMismatches() == 1, "write mismatch counted");
+    MPUgetRotation(&x, &y, &z);
+    failures += expect(I2CreplayGetStatus() == I2CREPLAY_DIVERGED, "divergence detected");
+    failures += expect(I2CreplayGetIndex() == 2, "divergence index");
+
+    // the ring keeps the newest whole records
+    I2CdevtraceClear();
+    I2CdevtraceEnable(TRUE);
+    for (i = 0; i < 1000; i++) {
+        I2CreplayStart(trace, length);
+        MPUtestConnection();
+        MPUsetRate(4);
+        MPUgetAcceleration(&x, &y, &z);
+    }
+    I2CdevtraceEnable(FALSE);
+    dumped = I2CdevtraceDump(rerecorded, sizeof(rerecorded));
+    failures += expect(I2CdevtraceDropped() > 0 && dumped <= I2CDEV_TRACE_SIZE && dumped > I2CDEV_TRACE_SIZE - length, "ring overwrites");
+    for (pos = 0; (size = i2cdevTraceDecode(rerecorded + pos, dumped - pos, &record)) != 0; pos += size) last = pos;
+    failures += expect(pos == dumped, "ring dump holds whole records");
+    failures += expect(dumped - last == I2CDEV_TRACE_HEADER + 6 && memcmp(rerecorded + last + 1, trace + length - I2CDEV_TRACE_HEADER - 6 + 1, I2CDEV_TRACE_HEADER + 5) == 0, "newest record last");
+
+    printf("%s\n", failures ? "i2creplay check FAILED" : "i2creplay check passed");
+    return failures;
+}
+
+int main(int argc, char **argv) {
+    MPU6050(MPU6050_DEFAULT_ADDRESS);
+    if (argc == 2 && strcmp(argv[1], "check") == 0) return check() ? 1 : 0;
+    if (argc == 3 && strcmp(argv[1], "dump") == 0) return dump(argv[2]);
+    if (argc == 3 && strcmp(argv[1], "dmp") == 0) return dmp(argv[2]);
+    fprintf(stderr, "usage: i2creplay check | dump trace.bin | dmp trace.bin\n");
+    return 2;
+}
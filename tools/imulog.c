@@ -0,0 +1,318 @@
+/* Host reader for MPU6050/helper_imulog.h
+ * Verifies and dumps sample logs written on the MCU, generates synthetic
+ * logs, and checks the format round-trip with the same code the MCU runs.
+ *
+ * Build and run on the host:
+ *     gcc -O2 -Wall -o imulog imulog.c -lm
+ *     ./imulog check
+ *     ./imulog dump in.log                      CSV: time, one column per channel
+ *     ./imulog stats in.log
+ *     ./imulog synth out.log motion6|dmp seconds [rateHz]
+ */
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 host tools are placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../MPU6050/helper_imulog.h"
+#include "toolcheck.h"
+
+#define SYNTH_MOTION6   0
+#define SYNTH_DMP       1
+
+typedef struct {
+        uint32_t blocks;
+        uint32_t bad;               // damaged blocks skipped
+        uint32_t skipped;           // bytes skipped while resynchronizing
+        uint64_t samples;
+        uint64_t bytes;
+        uint8_t channels;
+} LogStats;
+
+static uint32_t seed = 1;
+
+static int32_t noise(int32_t amplitude) {
+    seed = seed * 1103515245 + 12345;
+    return (int32_t)((seed >> 16) % (2 * amplitude + 1)) - amplitude;
+}
+
+static void putLong(uint8_t *out, int32_t value) {
+    out[0] = (uint8_t)((uint32_t)value >> 24);
+    out[1] = (uint8_t)((uint32_t)value >> 16);
+    out[2] = (uint8_t)((uint32_t)value >> 8);
+    out[3] = (uint8_t)value;
+}
+
+/* One sample of a slow wobble: accel near 1g, gyro noise of a few LSB,
+ * as a motion6 sample or as a DMP packet (q30 quaternion, gyro/accel in the
+ * upper words) split into words. */
+static uint8_t synthSample(uint8_t kind, uint32_t index, uint32_t rateHz, int16_t *words) {
+    double t = (double)index / rateHz, angle = 0.3 * sin(2 * M_PI * 0.5 * t), rate = 0.3 * M_PI * cos(2 * M_PI * 0.5 * t);
+    int16_t ax = (int16_t)(16384 * sin(angle) + noise(20)), az = (int16_t)(16384 * cos(angle) + noise(20));
+    int16_t gx = (int16_t)(rate * 180 / M_PI * 131 + noise(4));
+    uint8_t packet[2 * IMULOG_DMP_CHANNELS];
+
+    if (kind == SYNTH_MOTION6) {
+        words[0] = ax;
+        words[1] = (int16_t)noise(20);
+        words[2] = az;
+        words[3] = gx;
+        words[4] = (int16_t)noise(4);
+        words[5] = (int16_t)noise(4);
+        return IMULOG_MOTION6_CHANNELS;
+    }
+    memset(packet, 0, sizeof(packet));
+    putLong(packet + 0, (int32_t)(cos(angle / 2) * 1073741824.0));
+    putLong(packet + 4, (int32_t)(sin(angle / 2) * 1073741824.0));
+    putLong(packet + 16, (int32_t)gx << 16);
+    putLong(packet + 20, noise(4) << 16);
+    putLong(packet + 24, noise(4) << 16);
+    putLong(packet + 28, (int32_t)(ax / 4) << 16);
+    putLong(packet + 32, noise(5) << 16);
+    putLong(packet + 36, (int32_t)(az / 4) << 16);
+    imuLogPacketToWords(packet, words, IMULOG_DMP_CHANNELS);
+    return IMULOG_DMP_CHANNELS;
+}
+
+/* Encode samples into blocks of IMULOG_BLOCK_SIZE the way the MCU does.
+ * Returns the log length, out must hold samples * (header + max sample). */
+static uint32_t synthLog(uint8_t kind, uint32_t samples, uint32_t rateHz, uint8_t *out) {
+    uint8_t block[IMULOG_BLOCK_SIZE], channels = 0;
+    int16_t words[IMULOG_MAX_CHANNELS];
+    ImuLogWriter writer;
+    uint32_t i, length = 0;
+    uint16_t n;
+
+    for (i = 0; i < samples; i++) {
+        channels = synthSample(kind, i, rateHz, words);
+        if (i == 0) imuLogBegin(&writer, block, sizeof(block), channels);
+        if (imuLogAdd(&writer, i * (1000000 / rateHz), words) == IMULOG_FULL) {
+            n = imuLogFinish(&writer);
+            memcpy(out + length, block, n);
+            length += n;
+            imuLogBegin(&writer, block, sizeof(block), channels);
+            imuLogAdd(&writer, i * (1000000 / rateHz), words);
+        }
+    }
+    n = imuLogFinish(&writer);
+    memcpy(out + length, block, n);
+    return length + n;
+}
+
+/* Walk a log block by block, skipping damaged ones. The callback gets each
+ * decoded block; it may be 0 to only count. */
+static void walk(const uint8_t *data, uint32_t length, LogStats *stats, void (*callback)(const ImuLogBlock *, const uint32_t *, const int16_t *)) {
+    static uint32_t times[IMULOG_BLOCK_SIZE];
+    static int16_t words[IMULOG_BLOCK_SIZE * IMULOG_MAX_CHANNELS];
+    ImuLogBlock block;
+    uint32_t offset = 0, next;
+
+    memset(stats, 0, sizeof(*stats));
+    stats -> bytes = length;
+    while (offset < length) {
+        if (imuLogCheck(data + offset, length - offset, &block) != IMULOG_OK
+            || block.count > IMULOG_BLOCK_SIZE
+            || imuLogDecode(data + offset, &block, times, words) != IMULOG_OK) {
+            next = offset + 1 + imuLogFind(data + offset + 1, length - offset - 1);
+            if (data[offset] == IMULOG_MAGIC0 && offset + 1 < length && data[offset + 1] == IMULOG_MAGIC1) stats -> bad++;
+            stats -> skipped += next - offset;
+            offset = next;
+            continue;
+        }
+        stats -> blocks++;
+        stats -> samples += block.count;
+        stats -> channels = block.channels;
+        if (callback != 0) callback(&block, times, words);
+        offset += block.length;
+    }
+}
+
+static void printBlock(const ImuLogBlock *block, const uint32_t *times, const int16_t *words) {
+    uint16_t s;
+    uint8_t c;
+    for (s = 0; s < block -> count; s++) {
+        printf("%u", times[s]);
+        for (c = 0; c < block -> channels; c++) printf(",%d", words[s * block -> channels + c]);
+        printf("\n");
+    }
+}
+
+static uint8_t *readFile(const char *path, uint32_t *length) {
+    uint8_t *data;
+    long size;
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    data = malloc(size > 0 ? size : 1);
+    *length = (uint32_t)fread(data, 1, size, f);
+    fclose(f);
+    return data;
+}
+
+static void printStats(const LogStats *stats) {
+    double raw = (double)stats -> samples * (4 + 2 * stats -> channels);
+    printf("%u blocks, %u damaged, %u bytes skipped\n", stats -> blocks, stats -> bad, stats -> skipped);
+    printf("%llu samples of %u channels, %.2f bytes/sample\n", (unsigned long long)stats -> samples, stats -> channels,
+        stats -> samples ? (double)stats -> bytes / stats -> samples : 0.0);
+    printf("%.2fx smaller than raw words with a 32 bit timestamp\n", stats -> bytes ? raw / stats -> bytes : 0.0);
+}
+
+static int checkKind(uint8_t kind, uint32_t samples, uint8_t *log, int16_t *expected, double *ratio, double *textRatio) {
+    static uint32_t times[IMULOG_BLOCK_SIZE];
+    static int16_t words[IMULOG_BLOCK_SIZE * IMULOG_MAX_CHANNELS];
+    ImuLogBlock block;
+    uint32_t length, offset = 0, i = 0, textBytes = 0;
+    uint8_t channels = 0, c;
+    int failed = 0;
+    char line[256];
+    uint16_t s;
+
+    for (i = 0; i < samples; i++) channels = synthSample(kind, i, 1000, expected + i * channels);
+    seed = 1;
+    length = synthLog(kind, samples, 1000, log);
+    for (i = 0; i < samples; i++) {
+        int n = snprintf(line, sizeof(line), "%u", i * 1000);
+        for (c = 0; c < channels; c++) n += snprintf(line + n, sizeof(line) - n, ",%d", expected[i * channels + c]);
+        textBytes += n + 1;
+    }
+    i = 0;
+    while (offset < length && !failed) {
+        failed += expect(imuLogCheck(log + offset, length - offset, &block) == IMULOG_OK, "blocks verify");
+        failed += expect(block.length <= IMULOG_BLOCK_SIZE, "blocks fit a sector");
+        failed += expect(imuLogDecode(log + offset, &block, times, words) == IMULOG_OK, "blocks decode");
+        for (s = 0; s < block.count && !failed; s++, i++) {
+            failed += expect(times[s] == i * 1000, "timestamps round-trip");
+            failed += expect(memcmp(&words[s * channels], &expected[i * channels], channels * 2) == 0, "samples round-trip");
+        }
+        offset += block.length;
+    }
+    failed += expect(i == samples, "all samples decoded");
+    *ratio = (double)samples * (4 + 2 * channels) / length;
+    *textRatio = (double)textBytes / length;
+    return failed;
+}
+
+static int check(void) {
+    enum { SAMPLES = 5000 };
+    static uint8_t log[SAMPLES * (IMULOG_HEADER_SIZE + IMULOG_MAX_SAMPLE_BYTES(IMULOG_MAX_CHANNELS) + IMULOG_CRC_SIZE)];
+    static int16_t expected[SAMPLES * IMULOG_MAX_CHANNELS];
+    uint8_t buffer[64], packet[2 * IMULOG_DMP_CHANNELS];
+    int16_t extreme[IMULOG_MAX_CHANNELS], back[IMULOG_MAX_CHANNELS];
+    uint32_t times[4], length;
+    ImuLogWriter writer;
+    ImuLogBlock block;
+    LogStats stats;
+    double ratio, textRatio;
+    int failed = 0, i;
+
+    seed = 1;
+    failed += checkKind(SYNTH_MOTION6, SAMPLES, log, expected, &ratio, &textRatio);
+    printf("motion6: %.2fx vs binary, %.2fx vs CSV text\n", ratio, textRatio);
+    failed += expect(ratio > 1.8 && textRatio > 4.0, "motion6 compresses");
+    seed = 1;
+    failed += checkKind(SYNTH_DMP, SAMPLES, log, expected, &ratio, &textRatio);
+    printf("dmp:     %.2fx vs binary, %.2fx vs CSV text\n", ratio, textRatio);
+    failed += expect(ratio > 1.5, "dmp packets compress");
+    imuLogWordsToPacket(expected, packet, IMULOG_DMP_CHANNELS);
+    imuLogPacketToWords(packet, back, IMULOG_DMP_CHANNELS);
+    failed += expect(memcmp(back, expected, sizeof(back)) == 0 && packet[0] == 0x40, "packets rebuild from words");
+
+    // full-scale jumps and wrapping timestamps survive, worst case fits the bound
+    for (i = 0; i < IMULOG_MAX_CHANNELS; i++) extreme[i] = (i & 1) ? -32768 : 32767;
+    imuLogBegin(&writer, buffer, sizeof(buffer), 2);
+    failed += expect(imuLogAdd(&writer, 0xFFFFFFF0, extreme) == IMULOG_OK, "first sample fits");
+    failed += expect(imuLogAdd(&writer, 0x00000010, extreme + 1) == IMULOG_OK, "second sample fits");
+    failed += expect(imuLogAdd(&writer, 0x80000000, extreme) == IMULOG_OK, "third sample fits");
+    failed += expect(writer.length - IMULOG_HEADER_SIZE <= 3 * IMULOG_MAX_SAMPLE_BYTES(2), "worst case stays within the bound");
+    length = imuLogFinish(&writer);
+    failed += expect(imuLogCheck(buffer, length, &block) == IMULOG_OK && imuLogDecode(buffer, &block, times, back) == IMULOG_OK, "extremes decode");
+    failed += expect(times[0] == 0xFFFFFFF0 && times[1] == 0x10 && times[2] == 0x80000000, "timestamps wrap");
+    failed += expect(back[0] == 32767 && back[1] == -32768 && back[2] == -32768 && back[3] == 32767, "full-scale deltas");
+    while (imuLogAdd(&writer, 0, extreme) == IMULOG_OK);
+    failed += expect((size_t)(writer.length + IMULOG_CRC_SIZE) <= sizeof(buffer), "a full block stays in the buffer");
+
+    // damage: a flipped bit costs one block, the rest resynchronizes
+    seed = 1;
+    length = synthLog(SYNTH_MOTION6, SAMPLES, 1000, log);
+    walk(log, length, &stats, 0);
+    failed += expect(stats.bad == 0 && stats.samples == SAMPLES, "clean log walks");
+    imuLogCheck(log, length, &block);
+    log[block.length + 40] ^= 0x10;
+    walk(log, length, &stats, 0);
+    failed += expect(stats.bad == 1 && stats.blocks > 1, "damaged block is skipped");
+    failed += expect(imuLogCheck(log, 5, &block) == IMULOG_BAD_LENGTH, "truncated block is rejected");
+
+    printf(failed ? "imulog check failed\n" : "imulog check passed\n");
+    return failed;
+}
+
+static int synth(int argc, char **argv) {
+    uint8_t kind = (strcmp(argv[3], "dmp") == 0) ? SYNTH_DMP : SYNTH_MOTION6;
+    uint32_t rate = (argc > 5) ? strtoul(argv[5], NULL, 0) : 1000, samples = strtoul(argv[4], NULL, 0) * rate, done = 0, chunk, length;
+    uint8_t *log = malloc(65536 * (IMULOG_HEADER_SIZE + IMULOG_MAX_SAMPLE_BYTES(IMULOG_MAX_CHANNELS) + IMULOG_CRC_SIZE));
+    FILE *f = fopen(argv[2], "wb");
+
+    if (f == NULL || log == NULL || rate == 0 || rate > 1000000) {
+        fprintf(stderr, "cannot write %s\n", argv[2]);
+        return 2;
+    }
+    // in chunks, each chunk starts a new block and the clock restarts
+    while (done < samples) {
+        chunk = (samples - done < 65536) ? samples - done : 65536;
+        length = synthLog(kind, chunk, rate, log);
+        fwrite(log, 1, length, f);
+        done += chunk;
+    }
+    fclose(f);
+    free(log);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    LogStats stats;
+    uint32_t length;
+    uint8_t *data;
+
+    if (argc == 2 && strcmp(argv[1], "check") == 0) return check() ? 1 : 0;
+    if ((argc == 5 || argc == 6) && strcmp(argv[1], "synth") == 0) return synth(argc, argv);
+    if (argc == 3 && (strcmp(argv[1], "dump") == 0 || strcmp(argv[1], "stats") == 0)) {
+        if ((data = readFile(argv[2], &length)) == NULL) return 2;
+        walk(data, length, &stats, (argv[1][0] == 'd') ? printBlock : 0);
+        if (argv[1][0] == 's') printStats(&stats);
+        free(data);
+        return stats.bad ? 1 : 0;
+    }
+    fprintf(stderr, "usage: %s check | dump file | stats file | synth file motion6|dmp seconds [rateHz]\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,488 @@
+/* Offline batch analytics for logs written with MPU6050/helper_imulog.h
+ * Maps the log into memory, splits it into one byte range per core and
+ * decodes the blocks of each range with imuLogDecode(). DMP samples go
+ * through the firmware's own MPUdmpGet* functions: quaternion to Euler
+ * angles, gravity removal and world-frame acceleration. Gyro bias is
+ * estimated over the samples where the board was at rest.
+ *
+ * Build and run on the host:
+ *     gcc -O2 -Wall -Wno-unused-function -pthread -I../i2cdev_chibi/host -I../i2cdev_chibi -I../MPU6050 -o imuscan \
+ *         imuscan.c ../i2cdev_chibi/host/chhost.c ../i2cdev_chibi/host/i2cdev_sim.c ../i2cdev_chibi/i2cdev_chibi.c \
+ *         ../MPU6050/MPU6050.c ../MPU6050/MPU6050_6Axis_MotionApps20.c ../MPU6050/MPU6050_Calibration.c -lm
+ *     ./imuscan check
+ *     ./imuscan in.log [threads [accelG gyroDps]]
+ *
+ * A block belongs to the range it starts in. A thread resynchronizes at the
+ * start of its range with imuLogCheck(), so it may lock onto a false magic
+ * inside the previous range's last block; the merge detects that from the
+ * block offsets and rescans the range from the correct position.
+ *
+ * motion6 logs carry raw counts and are converted with the firmware's
+ * MPUconvert*Block() at the full scales given on the command line
+ * (default +/-2g and +/-250 deg/s), DMP logs use the DMP scales
+ * (MPU6050_DMP_ACCEL_LSB_PER_G, +/-2000 deg/s).
+ */
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 host tools are placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ch.h"
+#include "MPU6050.h"
+#include "MPU6050_6Axis_MotionApps20.h"
+#define IMULOG_CRC_TABLE        1
+#include "helper_imulog.h"
+#include "toolcheck.h"
+
+#define MAX_THREADS             64
+#define DMP_GYRO_LSB_PER_DPS    16.4f
+#define REST_GYRO_DPS           3.0f    // below this on every axis ...
+#define REST_ACCEL_G            0.05f   // ... and |a| within 1g +/- this counts as at rest
+
+typedef struct {
+        uint64_t n;
+        double sum;
+        double sumSquares;
+        double min;
+        double max;
+} Stat;
+
+typedef struct {
+        Stat channel[IMULOG_MAX_CHANNELS];  // raw words
+        Stat euler[3];                      // deg: psi, theta, phi
+        Stat worldAccel[3];                 // g, gravity removed, world frame
+        Stat restGyro[3];                   // deg/s, samples at rest only
+        uint64_t samples;
+        uint32_t blocks;
+        uint32_t skipped;                   // bytes between blocks of this range
+        uint32_t timeGaps;                  // sample intervals over twice the block median
+        uint8_t channels;
+        int8_t mixed;                       // blocks with different channel counts
+} Analysis;
+
+typedef struct {
+        const uint8_t *data;
+        uint64_t length;
+        uint64_t begin;                     // range [begin, end) of block starts
+        uint64_t end;
+        uint64_t first;                     // first block found, end if none
+        uint64_t stop;                      // end of the last block
+        Analysis result;
+} Range;
+
+static void statAdd(Stat *s, double value) {
+    if (s -> n == 0 || value < s -> min) s -> min = value;
+    if (s -> n == 0 || value > s -> max) s -> max = value;
+    s -> n++;
+    s -> sum += value;
+    s -> sumSquares += value * value;
+}
+
+static void statMerge(Stat *to, const Stat *from) {
+    if (from -> n == 0) return;
+    if (to -> n == 0 || from -> min < to -> min) to -> min = from -> min;
+    if (to -> n == 0 || from -> max > to -> max) to -> max = from -> max;
+    to -> n += from -> n;
+    to -> sum += from -> sum;
+    to -> sumSquares += from -> sumSquares;
+}
+
+static double statMean(const Stat *s) {
+    return s -> n ? s -> sum / s -> n : 0.0;
+}
+
+static double statStd(const Stat *s) {
+    double mean = statMean(s), var;
+    if (s -> n < 2) return 0.0;
+    var = (s -> sumSquares - s -> n * mean * mean) / (s -> n - 1);
+    return var > 0 ? sqrt(var) : 0.0;
+}
+
+static int atRest(const float *gyroDps, const float *accelG) {
+    float norm = sqrtf(accelG[0] * accelG[0] + accelG[1] * accelG[1] + accelG[2] * accelG[2]);
+    return fabsf(gyroDps[0]) < REST_GYRO_DPS && fabsf(gyroDps[1]) < REST_GYRO_DPS && fabsf(gyroDps[2]) < REST_GYRO_DPS
+        && fabsf(norm - 1.0f) < REST_ACCEL_G;
+}
+
+// full scales of motion6 logs, MPU6050_ACCEL_FS_* and MPU6050_GYRO_FS_*; set before the scan threads start
+static void setRanges(uint8_t accelRange, uint8_t gyroRange) {
+    MPUaccelRange = accelRange;
+    MPUgyroRange = gyroRange;
+    MPUaccelScale = MPUgetAccelScaleForRange(accelRange);
+    MPUgyroScale = MPUgetGyroScaleForRange(gyroRange);
+}
+
+static void analyzeMotion6(Analysis *a, const int16_t *w) {
+    float gyro[3], accel[3];
+    uint8_t i;
+    MPUconvertAccelBlock(w, accel, 3);
+    MPUconvertGyroBlock(w + 3, gyro, 3);
+    for (i = 0; i < 3; i++) {
+        accel[i] /= MPU6050_STANDARD_GRAVITY;
+        gyro[i] /= MPU6050_DEG_TO_RAD;
+    }
+    if (atRest(gyro, accel)) {
+        for (i = 0; i < 3; i++) statAdd(&a -> restGyro[i], gyro[i]);
+    }
+}
+
+static void analyzeDMP(Analysis *a, const int16_t *w) {
+    uint8_t packet[2 * IMULOG_DMP_CHANNELS];
+    int16_t raw[3], rawGyro[3];
+    float euler[3], gyro[3], accel[3];
+    Quaternion q;
+    VectorFloat gravity;
+    VectorInt16 aa, aaReal, aaWorld;
+    uint8_t i;
+
+    imuLogWordsToPacket(w, packet, IMULOG_DMP_CHANNELS);
+    MPUdmpGetQuaternion(&q, packet);
+    MPUdmpGetEulerMode(euler, &q, MPU6050_TRIG_FLOAT);
+    MPUdmpGetGravityVect(&gravity, &q);
+    MPUdmpGetAccel16(raw, packet);
+    MPUdmpGetGyro16(rawGyro, packet);
+    aa.x = raw[0];
+    aa.y = raw[1];
+    aa.z = raw[2];
+    MPUdmpGetLinearAccelVect(&aaReal, &aa, &gravity);
+    MPUdmpGetLinearAccelInWorldVect(&aaWorld, &aaReal, &q);
+
+    for (i = 0; i < 3; i++) statAdd(&a -> euler[i], euler[i] * 180.0 / M_PI);
+    statAdd(&a -> worldAccel[0], aaWorld.x / (float)MPU6050_DMP_ACCEL_LSB_PER_G);
+    statAdd(&a -> worldAccel[1], aaWorld.y / (float)MPU6050_DMP_ACCEL_LSB_PER_G);
+    statAdd(&a -> worldAccel[2], aaWorld.z / (float)MPU6050_DMP_ACCEL_LSB_PER_G);
+    for (i = 0; i < 3; i++) {
+        accel[i] = raw[i] / (float)MPU6050_DMP_ACCEL_LSB_PER_G;
+        gyro[i] = rawGyro[i] / DMP_GYRO_LSB_PER_DPS;
+    }
+    if (atRest(gyro, accel)) {
+        for (i = 0; i < 3; i++) statAdd(&a -> restGyro[i], gyro[i]);
+    }
+}
+
+static void analyzeBlock(Analysis *a, const ImuLogBlock *block, const uint32_t *times, const int16_t *words) {
+    uint32_t period;
+    uint16_t s;
+    uint8_t c;
+
+    if (a -> blocks > 0 && a -> channels != block -> channels) a -> mixed = 1;
+    a -> channels = block -> channels;
+    a -> blocks++;
+    a -> samples += block -> count;
+    // nominal period from the middle of the block, robust against one gap
+    period = (block -> count > 2) ? times[block -> count / 2] - times[block -> count / 2 - 1] : 0;
+    for (s = 0; s < block -> count; s++) {
+        const int16_t *w = words + s * block -> channels;
+        if (s > 0 && period > 0 && times[s] - times[s - 1] > 2 * period) a -> timeGaps++;
+        for (c = 0; c < block -> channels; c++) statAdd(&a -> channel[c], w[c]);
+        if (block -> channels == IMULOG_MOTION6_CHANNELS) analyzeMotion6(a, w);
+        else if (block -> channels == IMULOG_DMP_CHANNELS) analyzeDMP(a, w);
+    }
+}
+
+static void *scanRange(void *arg) {
+    Range *r = (Range *)arg;
+    uint32_t *times = malloc(sizeof(uint32_t) * IMULOG_BLOCK_SIZE * 8);
+    int16_t *words = malloc(sizeof(int16_t) * IMULOG_BLOCK_SIZE * 8 * IMULOG_MAX_CHANNELS);
+    uint64_t offset = r -> begin, available;
+    ImuLogBlock block;
+
+    memset(&r -> result, 0, sizeof(r -> result));
+    r -> first = r -> stop = r -> end;
+    while (offset < r -> end) {
+        available = r -> length - offset;
+        if (available > 0xFFFFFFFF) available = 0xFFFFFFFF;
+        // larger blocks than 8 sectors are not written by the MCU, treat as damage
+        if (imuLogCheck(r -> data + offset, (uint32_t)available, &block) != IMULOG_OK
+            || block.count > IMULOG_BLOCK_SIZE * 8
+            || imuLogDecode(r -> data + offset, &block, times, words) != IMULOG_OK) {
+            if (r -> first != r -> end) r -> result.skipped++;
+            offset++;
+            continue;
+        }
+        if (r -> first == r -> end) r -> first = offset;
+        analyzeBlock(&r -> result, &block, times, words);
+        offset += block.length;
+        r -> stop = offset;
+    }
+    // skipped counts bytes after the last block too, the merge owns that gap
+    if (r -> first != r -> end) r -> result.skipped -= (uint32_t)(offset - r -> stop);
+    free(times);
+    free(words);
+    return NULL;
+}
+
+static void merge(Analysis *to, const Analysis *from) {
+    uint8_t i;
+    if (from -> blocks == 0) return;
+    if (to -> blocks > 0 && to -> channels != from -> channels) to -> mixed = 1;
+    to -> channels = from -> channels;
+    to -> mixed |= from -> mixed;
+    for (i = 0; i < IMULOG_MAX_CHANNELS; i++) statMerge(&to -> channel[i], &from -> channel[i]);
+    for (i = 0; i < 3; i++) {
+        statMerge(&to -> euler[i], &from -> euler[i]);
+        statMerge(&to -> worldAccel[i], &from -> worldAccel[i]);
+        statMerge(&to -> restGyro[i], &from -> restGyro[i]);
+    }
+    to -> samples += from -> samples;
+    to -> blocks += from -> blocks;
+    to -> skipped += from -> skipped;
+    to -> timeGaps += from -> timeGaps;
+}
+
+/* Scan data with the given number of threads. Returns the number of
+ * ranges that had to be rescanned after a false resynchronization. */
+static uint32_t scan(const uint8_t *data, uint64_t length, uint32_t threads, Analysis *out) {
+    static Range ranges[MAX_THREADS];
+    pthread_t tid[MAX_THREADS];
+    uint64_t chunk, previous = 0;
+    uint32_t i, rescans = 0;
+
+    if (threads < 1) threads = 1;
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+    chunk = (length + threads - 1) / threads;
+    for (i = 0; i < threads; i++) {
+        ranges[i].data = data;
+        ranges[i].length = length;
+        ranges[i].begin = (uint64_t)i * chunk < length ? (uint64_t)i * chunk : length;
+        ranges[i].end = ranges[i].begin + chunk < length ? ranges[i].begin + chunk : length;
+        pthread_create(&tid[i], NULL, scanRange, &ranges[i]);
+    }
+    for (i = 0; i < threads; i++) pthread_join(tid[i], NULL);
+
+    memset(out, 0, sizeof(*out));
+    for (i = 0; i < threads; i++) {
+        Range *r = &ranges[i];
+        // the previous range's last block reaches into this one: whatever
+        // was found before its end is payload, rescan from the right place
+        if (previous > r -> begin && r -> first != previous && r -> first != r -> end) {
+            r -> begin = previous;
+            if (r -> begin < r -> end) scanRange(r);
+            else r -> first = r -> stop = r -> end;
+            rescans++;
+        }
+        if (r -> first != r -> end) {
+            if (r -> first > previous) out -> skipped += (uint32_t)(r -> first - previous);
+            previous = r -> stop;
+        }
+        merge(out, &r -> result);
+    }
+    if (length > previous) out -> skipped += (uint32_t)(length - previous);
+    return rescans;
+}
+
+static void printStat(const char *name, const Stat *s) {
+    printf("  %-12s mean %10.4f  std %9.4f  min %10.4f  max %10.4f\n", name, statMean(s), statStd(s), s -> min, s -> max);
+}
+
+static void report(const Analysis *a, double seconds, uint64_t length) {
+    static const char *axis[3] = { "x", "y", "z" };
+    static const char *angle[3] = { "psi (z)", "theta (y)", "phi (x)" };
+    char name[16];
+    uint8_t i;
+
+    printf("%u blocks, %llu samples, %u channels%s, %u bytes skipped, %u timestamp gaps\n", a -> blocks,
+        (unsigned long long)a -> samples, a -> channels, a -> mixed ? " (mixed)" : "", a -> skipped, a -> timeGaps);
+    printf("%.3f s, %.1f MB/s, %.1f Msamples/s\n", seconds, length / seconds / 1e6, a -> samples / seconds / 1e6);
+    if (a -> mixed) return;
+    if (a -> channels == IMULOG_DMP_CHANNELS) {
+        printf("euler angles (deg):\n");
+        for (i = 0; i < 3; i++) printStat(angle[i], &a -> euler[i]);
+        printf("world-frame linear acceleration (g):\n");
+        for (i = 0; i < 3; i++) printStat(axis[i], &a -> worldAccel[i]);
+    } else {
+        if (a -> channels == IMULOG_MOTION6_CHANNELS)
+            printf("motion6 at +/-%ug, +/-%u deg/s\n", 2 << MPUaccelRange, 250 << MPUgyroRange);
+        printf("channels (raw):\n");
+        for (i = 0; i < a -> channels; i++) {
+            snprintf(name, sizeof(name), "%u", i);
+            printStat(name, &a -> channel[i]);
+        }
+    }
+    if (a -> channels == IMULOG_DMP_CHANNELS || a -> channels == IMULOG_MOTION6_CHANNELS) {
+        printf("gyro bias at rest (deg/s, %llu samples):\n", (unsigned long long)a -> restGyro[0].n);
+        for (i = 0; i < 3; i++) printStat(axis[i], &a -> restGyro[i]);
+    }
+}
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Build a log: gyro bias (20, -10, 5) LSB at rest with 1g = oneG counts
+ * (motion6), a yaw turn through the DMP quaternion in the second half,
+ * 5ms of missing samples after a third. */
+static uint64_t buildLog(uint8_t *out, uint32_t samples, uint8_t channels, int16_t oneG) {
+    uint8_t block[IMULOG_BLOCK_SIZE], packet[2 * IMULOG_DMP_CHANNELS];
+    int16_t words[IMULOG_MAX_CHANNELS];
+    ImuLogWriter writer;
+    uint64_t length = 0;
+    uint32_t i, time;
+    uint16_t n;
+    float yaw;
+
+    imuLogBegin(&writer, block, sizeof(block), channels);
+    for (i = 0; i < samples; i++) {
+        if (channels == IMULOG_MOTION6_CHANNELS) {
+            int16_t sample[6] = { (int16_t)(i % 7 - 3), 2, oneG, 20, -10, 5 };
+            memcpy(words, sample, sizeof(sample));
+        } else {
+            yaw = (i < samples / 2) ? 0.0f : (float)M_PI / 2;
+            memset(packet, 0, sizeof(packet));
+            packet[0] = (uint8_t)((int16_t)(cosf(yaw / 2) * 16384) >> 8);
+            packet[1] = (uint8_t)((int16_t)(cosf(yaw / 2) * 16384));
+            packet[12] = (uint8_t)((int16_t)(sinf(yaw / 2) * 16384) >> 8);
+            packet[13] = (uint8_t)((int16_t)(sinf(yaw / 2) * 16384));
+            packet[16] = 0;                     // gyro x = 4 LSB, 0.24 deg/s
+            packet[17] = 4;
+            packet[36] = MPU6050_DMP_ACCEL_LSB_PER_G >> 8;
+            imuLogPacketToWords(packet, words, IMULOG_DMP_CHANNELS);
+        }
+        time = i * 1000 + ((i >= samples / 3) ? 5000 : 0);
+        if (imuLogAdd(&writer, time, words) == IMULOG_FULL) {
+            n = imuLogFinish(&writer);
+            memcpy(out + length, block, n);
+            length += n;
+            imuLogBegin(&writer, block, sizeof(block), channels);
+            imuLogAdd(&writer, time, words);
+        }
+    }
+    n = imuLogFinish(&writer);
+    memcpy(out + length, block, n);
+    return length + n;
+}
+
+static int check(void) {
+    enum { SAMPLES = 20000 };
+    static uint8_t log[SAMPLES * (IMULOG_MAX_SAMPLE_BYTES(IMULOG_MAX_CHANNELS) + IMULOG_HEADER_SIZE)];
+    Analysis one, many;
+    uint64_t length;
+    uint32_t threads, rescans = 0;
+    int failed = 0;
+
+    setRanges(MPU6050_ACCEL_FS_2, MPU6050_GYRO_FS_250);
+    length = buildLog(log, SAMPLES, IMULOG_MOTION6_CHANNELS, 16384);
+    scan(log, length, 1, &one);
+    failed += expect(one.samples == SAMPLES && one.skipped == 0, "motion6 log scans completely");
+    failed += expect(one.timeGaps == 1, "timestamp gap is found");
+    failed += expect(fabs(statMean(&one.restGyro[0]) - 20 / 131.0) < 1e-4
+        && fabs(statMean(&one.restGyro[1]) + 10 / 131.0) < 1e-4, "gyro bias at rest");
+    for (threads = 2; threads <= 13; threads++) {
+        rescans += scan(log, length, threads, &many);
+        failed += expect(many.samples == one.samples && many.blocks == one.blocks && many.skipped == 0
+            && many.timeGaps == one.timeGaps && many.channel[0].sum == one.channel[0].sum, "threads agree with one thread");
+    }
+
+    // the same counts at +/-8g read 4g: never at rest
+    setRanges(MPU6050_ACCEL_FS_8, MPU6050_GYRO_FS_1000);
+    scan(log, length, 3, &many);
+    failed += expect(many.samples == SAMPLES && many.restGyro[0].n == 0, "accel range is applied");
+    length = buildLog(log, SAMPLES, IMULOG_MOTION6_CHANNELS, 4096);
+    scan(log, length, 3, &many);
+    failed += expect(many.restGyro[0].n == SAMPLES && fabs(statMean(&many.restGyro[0]) - 20 / 32.8) < 1e-4
+        && fabs(statMean(&many.restGyro[2]) - 5 / 32.8) < 1e-4, "gyro range is applied");
+    setRanges(MPU6050_ACCEL_FS_2, MPU6050_GYRO_FS_250);
+
+    length = buildLog(log, SAMPLES, IMULOG_DMP_CHANNELS, 0);
+    scan(log, length, 4, &many);
+    failed += expect(many.samples == SAMPLES && many.channels == IMULOG_DMP_CHANNELS, "dmp log scans completely");
+    failed += expect(fabs(statMean(&many.euler[0]) + 45.0) < 0.5 && fabs(many.euler[0].min + 90.0) < 0.5, "yaw from the firmware decoder");
+    failed += expect(fabs(statMean(&many.worldAccel[2])) < 0.01, "gravity removed in the world frame");
+    failed += expect(many.restGyro[0].n == SAMPLES && fabs(statMean(&many.restGyro[0]) - 4 / DMP_GYRO_LSB_PER_DPS) < 1e-4, "dmp gyro bias");
+
+    // a damaged block in the middle is skipped by whichever thread owns it
+    log[length / 2] ^= 0x01;
+    scan(log, length, 1, &one);
+    scan(log, length, 7, &many);
+    failed += expect(one.samples < SAMPLES && one.skipped > 0, "damaged block is skipped");
+    failed += expect(many.samples == one.samples && many.skipped == one.skipped, "threads agree on damage");
+
+    printf("%u rescans\n", rescans);
+    printf(failed ? "imuscan check failed\n" : "imuscan check passed\n");
+    return failed;
+}
+
+// full scale argument to its range code, lowest the value of code 0; -1 if invalid
+static int fullScale(const char *arg, unsigned long lowest) {
+    unsigned long value = strtoul(arg, NULL, 0);
+    int range;
+    for (range = 0; range < 4; range++) {
+        if (value == lowest << range) return range;
+    }
+    return -1;
+}
+
+int main(int argc, char **argv) {
+    struct stat st;
+    const uint8_t *data;
+    Analysis analysis;
+    uint32_t threads;
+    double start;
+    int fd, accelRange = MPU6050_ACCEL_FS_2, gyroRange = MPU6050_GYRO_FS_250;
+
+    if (argc == 2 && strcmp(argv[1], "check") == 0) return check() ? 1 : 0;
+    if (argc == 5) {
+        accelRange = fullScale(argv[3], 2);
+        gyroRange = fullScale(argv[4], 250);
+    }
+    if ((argc != 2 && argc != 3 && argc != 5) || accelRange < 0 || gyroRange < 0) {
+        fprintf(stderr, "usage: %s check | file [threads [accelG gyroDps]]\n", argv[0]);
+        fprintf(stderr, "    accelG 2, 4, 8 or 16, gyroDps 250, 500, 1000 or 2000 (motion6 logs)\n");
+        return 2;
+    }
+    setRanges((uint8_t)accelRange, (uint8_t)gyroRange);
+    threads = (argc >= 3) ? strtoul(argv[2], NULL, 0) : (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
+    if ((fd = open(argv[1], O_RDONLY)) < 0 || fstat(fd, &st) != 0) {
+        perror(argv[1]);
+        return 2;
+    }
+    if (st.st_size == 0) {
+        fprintf(stderr, "%s is empty\n", argv[1]);
+        return 2;
+    }
+    data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        perror("mmap");
+        return 2;
+    }
+    madvise((void *)data, st.st_size, MADV_SEQUENTIAL);
+    start = now();
+    scan(data, st.st_size, threads, &analysis);
+    report(&analysis, now() - start, st.st_size);
+    munmap((void *)data, st.st_size);
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,133 @@
+/* Host front end for MPU6050/helper_rateplan.h
+ * Plans SMPLRT_DIV, DLPF and the FIFO drain period for a target before
+ * flashing, and checks the planner against known-good configurations.
+ *
+ * Build and run on the host:
+ *     gcc -O2 -Wall -o rateplan rateplan.c
+ *     ./rateplan check
+ *     ./rateplan rateHz bandwidthHz maxLatencyUs [packetSize [busHz]]
+ */
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 host tools are placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../MPU6050/helper_rateplan.h"
+#include "toolcheck.h"
+
+static const char *statusName(uint8_t status) {
+    switch (status) {
+        case RATEPLAN_OK:           return "ok";
+        case RATEPLAN_BAD_ARGUMENT: return "bad argument";
+        case RATEPLAN_NO_BANDWIDTH: return "bandwidth above 256Hz";
+        case RATEPLAN_LATENCY:      return "latency budget too small";
+        case RATEPLAN_BUS_OVERLOAD: return "bus overloaded";
+    }
+    return "unknown";
+}
+
+static uint8_t solve(uint32_t rate, uint16_t bandwidth, uint32_t latency, uint8_t packet, RatePlan *plan) {
+    RatePlanRequest request;
+    request.rateHz = rate;
+    request.bandwidthHz = bandwidth;
+    request.maxLatencyUs = latency;
+    request.packetSize = packet;
+    request.busHz = 400000;
+    return rateplanSolve(&request, plan);
+}
+
+static int check(void) {
+    RatePlan plan;
+    int failures = 0;
+    uint32_t latency, lastWatermark = 0;
+
+    // the MotionApps defaults: 200Hz, DLPF_BW_42
+    failures += expect(solve(200, 40, 20000, 42, &plan) == RATEPLAN_OK, "dmp default solves");
+    failures += expect(plan.dlpf == 3 && plan.divider == 4, "dmp default is rate 4, DLPF_BW_42");
+
+    // full rate paths
+    failures += expect(solve(1000, 150, 10000, 12, &plan) == RATEPLAN_OK && plan.dlpf == 1 && plan.divider == 0, "1kHz, DLPF_BW_188");
+    failures += expect(solve(8000, 250, 10000, 12, &plan) != RATEPLAN_BAD_ARGUMENT && plan.dlpf == 0 && plan.divider == 0, "8kHz, DLPF off");
+    failures += expect(plan.flags & RATEPLAN_ACCEL_REPEATS, "8kHz flags repeated accel");
+    failures += expect(solve(100, 5, 100000, 12, &plan) == RATEPLAN_OK && plan.dlpf == 6 && plan.divider == 9, "100Hz, DLPF_BW_5");
+    failures += expect(solve(4, 5, 1000000, 12, &plan) == RATEPLAN_OK && plan.divider == 249, "4Hz, divider 249");
+
+    // errors
+    failures += expect(solve(200, 300, 20000, 12, &plan) == RATEPLAN_NO_BANDWIDTH, "bandwidth above 256Hz");
+    failures += expect(solve(200, 40, 5000, 12, &plan) == RATEPLAN_LATENCY, "budget below the filter delay");
+    failures += expect(solve(0, 40, 5000, 12, &plan) == RATEPLAN_BAD_ARGUMENT, "zero rate");
+
+    // the batch grows with the budget and the latency stays inside it
+    for (latency = 15000; latency <= 200000; latency += 5000) {
+        if (solve(200, 40, latency, 12, &plan) != RATEPLAN_OK) {
+            failures += expect(0, "200Hz solves for every budget");
+            break;
+        }
+        failures += expect(plan.latencyUs <= latency, "latency within budget");
+        failures += expect(plan.watermark >= lastWatermark, "watermark monotonic");
+        failures += expect(plan.watermark * 12 <= RATEPLAN_FIFO_SIZE / RATEPLAN_FIFO_HEADROOM, "batch fits the FIFO");
+        lastWatermark = plan.watermark;
+    }
+
+    printf("%s\n", failures ? "rateplan check FAILED" : "rateplan check passed");
+    return failures;
+}
+
+static int plan(int argc, char **argv) {
+    RatePlanRequest request;
+    RatePlan plan;
+    uint8_t status;
+
+    if (argc < 4 || argc > 6) {
+        fprintf(stderr, "usage: rateplan rateHz bandwidthHz maxLatencyUs [packetSize [busHz]]\n");
+        return 2;
+    }
+    request.rateHz = strtoul(argv[1], 0, 0);
+    request.bandwidthHz = (uint16_t)strtoul(argv[2], 0, 0);
+    request.maxLatencyUs = strtoul(argv[3], 0, 0);
+    request.packetSize = (argc > 4) ? (uint8_t)strtoul(argv[4], 0, 0) : 12;
+    request.busHz = (argc > 5) ? strtoul(argv[5], 0, 0) : 400000;
+
+    status = rateplanSolve(&request, &plan);
+    printf("status          %s\n", statusName(status));
+    if (status != RATEPLAN_OK && status != RATEPLAN_BUS_OVERLOAD) return 1;
+    printf("DLPF_CFG        %d (%dHz, %luus delay)\n", plan.dlpf, plan.bandwidthHz, (unsigned long)plan.filterDelayUs);
+    printf("SMPLRT_DIV      %d (%.2fHz)\n", plan.divider, plan.rateHz);
+    printf("watermark       %d packets (%d bytes)\n", plan.watermark, plan.watermark * request.packetSize);
+    printf("drain period    %luus\n", (unsigned long)plan.drainPeriodUs);
+    printf("transfer        %luus per drain\n", (unsigned long)plan.transferUs);
+    printf("latency         %luus worst case\n", (unsigned long)plan.latencyUs);
+    printf("bus utilization %.1f%%\n", plan.busUtilization * 100.0f);
+    if (plan.flags & RATEPLAN_ACCEL_REPEATS) printf("warning         accel is 1kHz, samples repeat\n");
+    if (plan.flags & RATEPLAN_ALIASING) printf("warning         DLPF bandwidth above Nyquist, aliasing\n");
+    return status == RATEPLAN_OK ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 2 && strcmp(argv[1], "check") == 0) return check() ? 1 : 0;
+    return plan(argc, argv);
+}
@@ -0,0 +1,450 @@
+/* Worst-case stack report per entry point
+ * Reads the call graph files GCC writes with -fcallgraph-info=su (GCC 10 or
+ * later, arm-none-eabi-gcc included), merges them across translation units
+ * and reports for every global function the deepest stack over all call
+ * chains below it, with the chain that reaches it.
+ *
+ * Build and run on the host:
+ *     gcc -O2 -Wall -o stackreport stackreport.c
+ *     ./stackreport check
+ *     ./stackreport [-p prefix]... [-l limit] file.ci...
+ *
+ * For the firmware, add -fcallgraph-info=su to USE_COPT in the ChibiOS
+ * Makefile; every object gets a .ci file next to it. Pass the .ci files of
+ * ChibiOS and the HAL too, otherwise their functions count as 0 bytes.
+ * Example for a 256 byte reader thread:
+ *     ./stackreport -p MPU -p I2Cdev -l 256 $(find build -name "*.ci")
+ *
+ * Flags after the byte count mark results that are only a lower bound:
+ *     D  a function on some chain allocates a variable amount (VLA, alloca)
+ *     U  a callee without a .ci definition (counted as 0 bytes)
+ *     I  an indirect call (function pointer, callback)
+ *     R  recursion
+ * The numbers are frames only; the port's interrupt and context switch
+ * overhead comes on top. 'limit' makes the tool exit with 1 if any reported
+ * entry point needs more.
+ */
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 host tools are placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "toolcheck.h"
+
+#define MAX_PREFIXES            16
+#define INDIRECT_TITLE          "__indirect_call"
+
+#define FLAG_DYNAMIC            0x01
+#define FLAG_UNKNOWN            0x02
+#define FLAG_INDIRECT           0x04
+#define FLAG_RECURSION          0x08
+
+#define STATE_NEW               0
+#define STATE_ACTIVE            1
+#define STATE_DONE              2
+
+typedef struct {
+        char *title;            // unique across files, "file:name" for static functions
+        char *name;
+        long bytes;             // own frame, -1 until a definition is seen
+        uint8_t dynamic;        // variable frame without a bound
+        uint8_t indirect;       // makes an indirect call
+        uint32_t *callees;
+        uint32_t calleeCount;
+        uint32_t calleeSize;
+        uint8_t state;
+        uint8_t flags;          // FLAG_*, over all chains below
+        long worst;             // own frame plus deepest callee chain
+        int32_t next;           // callee on the deepest chain, -1 at the end
+} Node;
+
+typedef struct {
+        Node *nodes;
+        uint32_t count;
+        uint32_t size;
+        uint32_t *hash;         // node index + 1, 0 = empty
+        uint32_t hashSize;
+} Graph;
+
+static uint32_t hashString(const char *s) {
+    uint32_t h = 2166136261u;
+    while (*s) h = (h ^ (uint8_t)*s++) * 16777619u;
+    return h;
+}
+
+static void *allocOrDie(void *p, size_t size) {
+    p = realloc(p, size);
+    if (p == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(2);
+    }
+    return p;
+}
+
+static void graphInit(Graph *graph) {
+    memset(graph, 0, sizeof(*graph));
+    graph -> hashSize = 1024;
+    graph -> hash = calloc(graph -> hashSize, sizeof(uint32_t));
+}
+
+static void graphFree(Graph *graph) {
+    uint32_t i;
+    for (i = 0; i < graph -> count; i++) {
+        free(graph -> nodes[i].title);
+        free(graph -> nodes[i].name);
+        free(graph -> nodes[i].callees);
+    }
+    free(graph -> nodes);
+    free(graph -> hash);
+}
+
+static void graphRehash(Graph *graph) {
+    uint32_t i, h;
+    free(graph -> hash);
+    graph -> hashSize *= 2;
+    graph -> hash = calloc(graph -> hashSize, sizeof(uint32_t));
+    for (i = 0; i < graph -> count; i++) {
+        h = hashString(graph -> nodes[i].title) & (graph -> hashSize - 1);
+        while (graph -> hash[h] != 0) h = (h + 1) & (graph -> hashSize - 1);
+        graph -> hash[h] = i + 1;
+    }
+}
+
+/** Look up a node by title, creating an undefined one if it is new.
+ * @return Node index
+ */
+static uint32_t graphNode(Graph *graph, const char *title) {
+    uint32_t h = hashString(title) & (graph -> hashSize - 1), index;
+    Node *node;
+
+    while (graph -> hash[h] != 0) {
+        if (strcmp(graph -> nodes[graph -> hash[h] - 1].title, title) == 0) return graph -> hash[h] - 1;
+        h = (h + 1) & (graph -> hashSize - 1);
+    }
+    if (graph -> count == graph -> size) {
+        graph -> size = graph -> size ? graph -> size * 2 : 256;
+        graph -> nodes = allocOrDie(graph -> nodes, graph -> size * sizeof(Node));
+    }
+    index = graph -> count++;
+    node = &graph -> nodes[index];
+    memset(node, 0, sizeof(*node));
+    node -> title = strdup(title);
+    node -> name = strdup(title);
+    node -> bytes = -1;
+    node -> next = -1;
+    graph -> hash[h] = index + 1;
+    if (graph -> count * 2 > graph -> hashSize) graphRehash(graph);
+    return index;
+}
+
+static void graphEdge(Graph *graph, uint32_t from, uint32_t to) {
+    Node *node = &graph -> nodes[from];
+    uint32_t i;
+    for (i = 0; i < node -> calleeCount; i++) {
+        if (node -> callees[i] == to) return;
+    }
+    if (node -> calleeCount == node -> calleeSize) {
+        node -> calleeSize = node -> calleeSize ? node -> calleeSize * 2 : 4;
+        node -> callees = allocOrDie(node -> callees, node -> calleeSize * sizeof(uint32_t));
+    }
+    node -> callees[node -> calleeCount++] = to;
+}
+
+/** Copy the quoted value after 'key' in a VCG line.
+ * @return Pointer behind the closing quote, NULL if the key is missing
+ */
+static const char *field(const char *line, const char *key, char *out, size_t size) {
+    const char *p = strstr(line, key), *end;
+    size_t length;
+    if (p == NULL) return NULL;
+    p += strlen(key);
+    if ((end = strchr(p, '"')) == NULL) return NULL;
+    length = (size_t)(end - p);
+    if (length >= size) length = size - 1;
+    memcpy(out, p, length);
+    out[length] = 0;
+    return end + 1;
+}
+
+/* A label is "name\nfile:line:col\nN bytes (static|dynamic|dynamic,bounded)"
+ * for definitions, external declarations stop after the location. The \n
+ * are literal backslash-n in the file. */
+static void parseNode(Graph *graph, const char *line) {
+    char title[512], label[1024], *sep, *sizeText;
+    uint32_t index;
+    Node *node;
+
+    if (!field(line, "title: \"", title, sizeof(title)) || !field(line, "label: \"", label, sizeof(label))) return;
+    if (strcmp(title, INDIRECT_TITLE) == 0) return;
+    // graphNode() may move the node array
+    index = graphNode(graph, title);
+    node = &graph -> nodes[index];
+    if ((sep = strstr(label, "\\n")) != NULL) {
+        *sep = 0;
+        free(node -> name);
+        node -> name = strdup(label);
+        sizeText = strstr(sep + 2, "\\n");
+        if (sizeText != NULL && node -> bytes < 0) {
+            node -> bytes = strtol(sizeText + 2, NULL, 10);
+            node -> dynamic = strstr(sizeText, "(dynamic)") != NULL;
+        }
+    }
+}
+
+static void parseEdge(Graph *graph, const char *line) {
+    char source[512], target[512];
+    uint32_t from, to;
+
+    if (!field(line, "sourcename: \"", source, sizeof(source)) || !field(line, "targetname: \"", target, sizeof(target))) return;
+    from = graphNode(graph, source);
+    if (strcmp(target, INDIRECT_TITLE) == 0) {
+        graph -> nodes[from].indirect = 1;
+        return;
+    }
+    to = graphNode(graph, target);
+    graphEdge(graph, from, to);
+}
+
+static void parseFile(Graph *graph, FILE *f) {
+    char *line = NULL;
+    size_t size = 0;
+    while (getline(&line, &size, f) > 0) {
+        if (strncmp(line, "node:", 5) == 0) parseNode(graph, line);
+        else if (strncmp(line, "edge:", 5) == 0) parseEdge(graph, line);
+    }
+    free(line);
+}
+
+/* Depth first with memoization. A callee that is still active closes a
+ * cycle: the caller gets FLAG_RECURSION and the cycle counts once. */
+static void analyze(Graph *graph, uint32_t index) {
+    Node *node = &graph -> nodes[index], *callee;
+    long best = 0;
+    uint8_t flags = 0;
+    uint32_t i;
+
+    node -> state = STATE_ACTIVE;
+    if (node -> bytes < 0) flags |= FLAG_UNKNOWN;
+    if (node -> dynamic) flags |= FLAG_DYNAMIC;
+    if (node -> indirect) flags |= FLAG_INDIRECT;
+    for (i = 0; i < node -> calleeCount; i++) {
+        callee = &graph -> nodes[node -> callees[i]];
+        if (callee -> state == STATE_ACTIVE) {
+            flags |= FLAG_RECURSION;
+            continue;
+        }
+        if (callee -> state == STATE_NEW) analyze(graph, node -> callees[i]);
+        flags |= callee -> flags;
+        if (callee -> worst > best || node -> next < 0) {
+            best = callee -> worst;
+            node -> next = node -> callees[i];
+        }
+    }
+    node -> worst = (node -> bytes > 0 ? node -> bytes : 0) + best;
+    node -> flags = flags;
+    node -> state = STATE_DONE;
+}
+
+static void flagText(uint8_t flags, char *out) {
+    *out++ = (flags & FLAG_DYNAMIC) ? 'D' : '-';
+    *out++ = (flags & FLAG_UNKNOWN) ? 'U' : '-';
+    *out++ = (flags & FLAG_INDIRECT) ? 'I' : '-';
+    *out++ = (flags & FLAG_RECURSION) ? 'R' : '-';
+    *out = 0;
+}
+
+/* Global definitions only: static functions are titled "file:name". */
+static int isEntry(const Node *node, char **prefixes, uint8_t prefixCount) {
+    uint8_t i;
+    if (node -> bytes < 0 || strchr(node -> title, ':') != NULL) return 0;
+    if (prefixCount == 0) return 1;
+    for (i = 0; i < prefixCount; i++) {
+        if (strncmp(node -> name, prefixes[i], strlen(prefixes[i])) == 0) return 1;
+    }
+    return 0;
+}
+
+static Graph *sortGraph;
+
+static int byWorst(const void *a, const void *b) {
+    const Node *x = &sortGraph -> nodes[*(const uint32_t *)a], *y = &sortGraph -> nodes[*(const uint32_t *)b];
+    if (x -> worst != y -> worst) return (x -> worst < y -> worst) ? 1 : -1;
+    return strcmp(x -> name, y -> name);
+}
+
+/** Print the report.
+ * @return Number of entry points above limit (limit < 0: none)
+ */
+static uint32_t report(Graph *graph, char **prefixes, uint8_t prefixCount, long limit) {
+    uint32_t *entries = allocOrDie(NULL, (graph -> count + 1) * sizeof(uint32_t));
+    uint32_t count = 0, over = 0, i;
+    int32_t step;
+    char flags[5];
+
+    for (i = 0; i < graph -> count; i++) {
+        if (graph -> nodes[i].state == STATE_NEW) analyze(graph, i);
+    }
+    for (i = 0; i < graph -> count; i++) {
+        if (isEntry(&graph -> nodes[i], prefixes, prefixCount)) entries[count++] = i;
+    }
+    sortGraph = graph;
+    qsort(entries, count, sizeof(uint32_t), byWorst);
+
+    for (i = 0; i < count; i++) {
+        const Node *node = &graph -> nodes[entries[i]];
+        flagText(node -> flags, flags);
+        if (limit >= 0 && node -> worst > limit) over++;
+        printf("%6ld %s %c %s:", node -> worst, flags, (limit >= 0 && node -> worst > limit) ? '!' : ' ', node -> name);
+        for (step = entries[i]; step >= 0; step = graph -> nodes[step].next) {
+            if (graph -> nodes[step].bytes < 0) printf(" %s(?)", graph -> nodes[step].name);
+            else printf(" %s(%ld)", graph -> nodes[step].name, graph -> nodes[step].bytes);
+        }
+        printf("\n");
+    }
+    if (limit >= 0) printf("%u of %u entry points above %ld bytes\n", over, count, limit);
+    free(entries);
+    return over;
+}
+
+static const Node *lookup(Graph *graph, const char *title) {
+    uint32_t index = graphNode(graph, title);
+    return &graph -> nodes[index];
+}
+
+static void parseText(Graph *graph, const char *text) {
+    FILE *f = fmemopen((void *)text, strlen(text), "r");
+    parseFile(graph, f);
+    fclose(f);
+}
+
+/* Two translation units: 'read' calls into a second file, which is declared
+ * (ellipse) in the first and defined in the second, plus a static helper, a
+ * VLA, a callback, recursion and a callee that is never defined. */
+static int check(void) {
+    static const char *unitA =
+        "graph: { title: \"a.c\"\n"
+        "node: { title: \"read\" label: \"read\\na.c:10:6\\n32 bytes (static)\" }\n"
+        "node: { title: \"xfer\" label: \"xfer\\ni2c.h:5:8\" shape : ellipse }\n"
+        "edge: { sourcename: \"read\" targetname: \"xfer\" label: \"a.c:12:5\" }\n"
+        "node: { title: \"a.c:decode\" label: \"decode\\na.c:3:13\\n16 bytes (static)\" }\n"
+        "edge: { sourcename: \"read\" targetname: \"a.c:decode\" label: \"a.c:13:5\" }\n"
+        "node: { title: \"vla\" label: \"vla\\na.c:20:6\\n24 bytes (dynamic)\" }\n"
+        "node: { title: \"poll\" label: \"poll\\na.c:30:6\\n8 bytes (static)\" }\n"
+        "node: { title: \"__indirect_call\" label: \"Indirect Call Placeholder\" shape : ellipse }\n"
+        "edge: { sourcename: \"poll\" targetname: \"__indirect_call\" label: \"a.c:31:5\" }\n"
+        "edge: { sourcename: \"poll\" targetname: \"read\" label: \"a.c:32:5\" }\n"
+        "node: { title: \"walk\" label: \"walk\\na.c:40:6\\n48 bytes (static)\" }\n"
+        "edge: { sourcename: \"walk\" targetname: \"walk\" label: \"a.c:41:5\" }\n"
+        "node: { title: \"ext\" label: \"ext\\nx.h:1:6\" shape : ellipse }\n"
+        "node: { title: \"log\" label: \"log\\na.c:50:6\\n8 bytes (static)\" }\n"
+        "edge: { sourcename: \"log\" targetname: \"ext\" label: \"a.c:51:5\" }\n"
+        "}\n";
+    static const char *unitB =
+        "graph: { title: \"i2c.c\"\n"
+        "node: { title: \"xfer\" label: \"xfer\\ni2c.c:40:8\\n80 bytes (dynamic,bounded)\" }\n"
+        "node: { title: \"lock\" label: \"lock\\nos.h:9:6\" shape : ellipse }\n"
+        "edge: { sourcename: \"xfer\" targetname: \"lock\" label: \"i2c.c:44:2\" }\n"
+        "}\n";
+    static const char *unitOS =
+        "graph: { title: \"os.c\"\n"
+        "node: { title: \"lock\" label: \"lock\\nos.c:9:6\\n16 bytes (static)\" }\n"
+        "}\n";
+    Graph graph;
+    const Node *node;
+    char *prefix = "re";
+    int failed = 0;
+
+    graphInit(&graph);
+    parseText(&graph, unitA);
+    parseText(&graph, unitB);
+    node = lookup(&graph, "read");
+    analyze(&graph, graphNode(&graph, "read"));
+    failed += expect(node -> worst == 32 + 80, "worst case over two files");
+    failed += expect(node -> flags == FLAG_UNKNOWN, "undefined callee flagged");
+    failed += expect(strcmp(graph.nodes[node -> next].name, "xfer") == 0, "deepest chain");
+    graphFree(&graph);
+
+    graphInit(&graph);
+    parseText(&graph, unitA);
+    parseText(&graph, unitOS);
+    parseText(&graph, unitB);
+    for (node = graph.nodes; node < graph.nodes + graph.count; node++) {
+        if (node -> state == STATE_NEW) analyze(&graph, node - graph.nodes);
+    }
+    failed += expect(lookup(&graph, "read") -> worst == 32 + 80 + 16, "definition after declaration");
+    failed += expect(lookup(&graph, "read") -> flags == 0, "all callees resolved");
+    failed += expect(lookup(&graph, "vla") -> flags == FLAG_DYNAMIC, "unbounded frame");
+    failed += expect(lookup(&graph, "xfer") -> flags == 0, "bounded frame is exact");
+    failed += expect(lookup(&graph, "poll") -> worst == 8 + 128 && lookup(&graph, "poll") -> flags == FLAG_INDIRECT, "indirect call");
+    failed += expect(lookup(&graph, "walk") -> worst == 48 && lookup(&graph, "walk") -> flags == FLAG_RECURSION, "recursion");
+    failed += expect(lookup(&graph, "log") -> flags == FLAG_UNKNOWN, "external callee");
+    failed += expect(isEntry(lookup(&graph, "read"), &prefix, 1) && !isEntry(lookup(&graph, "a.c:decode"), NULL, 0), "entry points");
+    failed += expect(report(&graph, &prefix, 1, 100) == 1, "limit");
+    graphFree(&graph);
+
+    printf(failed ? "stackreport check failed\n" : "stackreport check passed\n");
+    return failed;
+}
+
+int main(int argc, char **argv) {
+    char *prefixes[MAX_PREFIXES];
+    uint8_t prefixCount = 0;
+    long limit = -1;
+    Graph graph;
+    FILE *f;
+    int i, files = 0;
+    uint32_t over;
+
+    if (argc == 2 && strcmp(argv[1], "check") == 0) return check() ? 1 : 0;
+    graphInit(&graph);
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-p") == 0 && i + 1 < argc && prefixCount < MAX_PREFIXES) {
+            prefixes[prefixCount++] = argv[++i];
+        } else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+            limit = strtol(argv[++i], NULL, 0);
+        } else if (argv[i][0] == '-') {
+            files = 0;
+            break;
+        } else {
+            if ((f = fopen(argv[i], "r")) == NULL) {
+                perror(argv[i]);
+                return 2;
+            }
+            parseFile(&graph, f);
+            fclose(f);
+            files++;
+        }
+    }
+    if (files == 0) {
+        fprintf(stderr, "usage: %s check | [-p prefix]... [-l limit] file.ci...\n", argv[0]);
+        return 2;
+    }
+    over = report(&graph, prefixes, prefixCount, limit);
+    graphFree(&graph);
+    return over > 0 ? 1 : 0;
+}
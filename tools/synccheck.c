@@ -0,0 +1,257 @@
+/* Host checks for the sync group (MPU6050/MPU6050_Sync.c)
+ * Serves several MPU6050 FIFOs from i2cdev_fsync.c instead of
+ * i2cdev_sim.c (which has one device and no FSYNC) and feeds them
+ * synthetic records: sensors starting late, marks arriving early and
+ * late, a missed strobe, FIFO overflows and a sensor dropping off the bus.
+ * Every record carries the tick it was sampled at, so alignment is
+ * checked directly: frames at a strobe hold the same tick everywhere.
+ *
+ * Build and run on the host:
+ *     gcc -O2 -Wall -Wno-unused-function -I../i2cdev_chibi/host -I../i2cdev_chibi -I../MPU6050 -o synccheck \
+ *         synccheck.c ../i2cdev_chibi/host/chhost.c ../i2cdev_chibi/host/i2cdev_fsync.c ../i2cdev_chibi/i2cdev_chibi.c \
+ *         ../MPU6050/MPU6050.c ../MPU6050/MPU6050_Sync.c -lm
+ *     ./synccheck check
+ */
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 host tools are placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "MPU6050.h"
+#include "MPU6050_Sync.h"
+#include "i2cdev_fsync.h"
+#include "toolcheck.h"
+
+#define DEVICES                 I2CFSYNC_DEVICES
+#define MAX_FRAMES              64
+
+static MPUSyncFrame frames[MAX_FRAMES];
+
+static void setup(MPUSyncGroup *group) {
+    static const uint8_t addresses[DEVICES] = { MPU6050_DEFAULT_ADDRESS, MPU6050_DEFAULT_ADDRESS + 1, MPU6050_DEFAULT_ADDRESS + 2 };
+    static const MPUSyncConfig config = { 0, MPU6050_CLOCK_PLL_EXT32K, MPU6050_EXT_SYNC_TEMP_OUT_L, 0, MPU6050_DLPF_BW_188 };
+
+    I2CfsyncStart();
+    MPUsyncInit(group, addresses, DEVICES, &config);
+    MPUsyncStart(group);
+}
+
+/* Poll and check the frames: at a strobe every sensor with data was
+ * sampled at the same tick. The mark may be missing on a sensor that
+ * missed the strobe, never on all of them. Returns the number of frames,
+ * -1 on a misaligned one. */
+static int pollAligned(MPUSyncGroup *group) {
+    int n = MPUsyncPoll(group, frames, MAX_FRAMES), i, dev, first, marked;
+    for (i = 0; i < n; i++) {
+        if (frames[i].index != 0) continue;
+        first = -1;
+        marked = 0;
+        for (dev = 0; dev < DEVICES; dev++) {
+            const MPUSyncSample *s = &frames[i].sample[dev];
+            if (s -> status != MPU6050_SYNC_OK) continue;
+            if (s -> accel[1] != dev) return -1;
+            if (first < 0) first = s -> accel[0];
+            else if (s -> accel[0] != first) return -1;
+            if (s -> fsync) marked++;
+        }
+        if (first >= 0 && !marked) return -1;
+    }
+    return n;
+}
+
+static int checkDecode(void) {
+    static const uint8_t offsets[8] = { 0, 7, 9, 11, 13, 1, 3, 5 };
+    uint8_t raw[MPU6050_SYNC_SAMPLE_SIZE];
+    int16_t expected[7], got[7];
+    MPUSyncSample sample;
+    int failed = 0, set, i, ok;
+    char what[64];
+
+    for (set = 0; set < 8; set++) {
+        for (i = 0; i < MPU6050_SYNC_SAMPLE_SIZE; i++) raw[i] = (uint8_t)(0x10 + 2 * i);     // all bit 0 clear
+        for (i = 0; i < 7; i++) expected[i] = (int16_t)((raw[2 * i] << 8) | raw[2 * i + 1]);
+        if (set) raw[offsets[set]] |= 1;
+        MPUsyncDecode(raw, (uint8_t)set, &sample);
+        for (i = 0; i < 3; i++) {
+            got[i] = sample.accel[i];
+            got[4 + i] = sample.gyro[i];
+        }
+        got[3] = sample.temp;
+        ok = sample.fsync == (set != 0) && sample.status == MPU6050_SYNC_OK && memcmp(got, expected, sizeof(got)) == 0;
+        snprintf(what, sizeof(what), "EXT_SYNC_SET %d: flag found and cleared", set);
+        failed += expect(ok, what);
+    }
+    // the flag bit itself is data when frame sync is disabled
+    raw[7] |= 1;
+    MPUsyncDecode(raw, MPU6050_EXT_SYNC_DISABLED, &sample);
+    failed += expect(!sample.fsync && (sample.temp & 1), "disabled frame sync keeps bit 0");
+    return failed;
+}
+
+static int checkLock(void) {
+    MPUSyncGroup group;
+    int failed = 0, n, total = 0, i, bad = 0;
+
+    // sensor 1 starts two samples late, sensor 2 one sample late
+    setup(&group);
+    for (i = 0; i < 3; i++) {
+        I2CfsyncPush(0, 0);
+        if (i >= 2) I2CfsyncPush(1, 0); else I2CfsyncDevices[1].tick++;
+        if (i >= 1) I2CfsyncPush(2, 0); else I2CfsyncDevices[2].tick++;
+    }
+    failed += expect(MPUsyncPoll(&group, frames, MAX_FRAMES) == 0, "no frames before the first strobe");
+    I2CfsyncTick(1);
+    for (i = 0; i < 9; i++) I2CfsyncTick(0);
+    n = pollAligned(&group);
+    failed += expect(n == 10 && frames[0].index == 0 && frames[9].index == 9, "group locks at the first strobe");
+    failed += expect(group.stats.dropped == 6, "samples before the strobe are dropped");
+
+    // sensor 2 runs fast: one extra sample before the next strobe, its mark lags
+    for (i = 0; i < 5; i++) I2CfsyncTick(0);
+    I2CfsyncPush(2, 0);
+    I2CfsyncDevices[2].tick--;
+    I2CfsyncTick(1);
+    for (i = 0; i < 4; i++) I2CfsyncTick(0);
+    n = pollAligned(&group);
+    if (n < 0) bad++;
+    total += n;
+    // sensor 0 runs slow: it misses one sample, its mark leads
+    for (i = 0; i < 5; i++) {
+        if (i == 2) {
+            I2CfsyncPush(1, 0);
+            I2CfsyncPush(2, 0);
+            I2CfsyncDevices[0].tick++;
+        } else {
+            I2CfsyncTick(0);
+        }
+    }
+    I2CfsyncTick(1);
+    for (i = 0; i < 4; i++) I2CfsyncTick(0);
+    n = pollAligned(&group);
+    if (n < 0) bad++;
+    total += n;
+    failed += expect(bad == 0 && group.stats.slips == 2 && group.stats.missed == 0, "lagging and leading marks are realigned");
+
+    // sensor 1 misses a strobe: counted, nothing dropped, the next strobe is aligned again
+    for (i = 0; i < 5; i++) I2CfsyncTick(0);
+    I2CfsyncPush(0, 1);
+    I2CfsyncPush(1, 0);
+    I2CfsyncPush(2, 1);
+    for (i = 0; i < 5; i++) I2CfsyncTick(0);
+    I2CfsyncTick(1);
+    I2CfsyncTick(0);
+    n = pollAligned(&group);
+    failed += expect(n == 13 && group.stats.missed == 1 && group.stats.slips == 2, "missed strobe is counted and emitted");
+    failed += expect(frames[5].index == 0 && frames[5].sample[0].fsync && !frames[5].sample[1].fsync, "missed strobe keeps the other marks");
+    failed += expect(frames[11].index == 0 && frames[12].index == 1 && frames[11].sample[1].fsync, "next strobe is aligned");
+    return failed;
+}
+
+static int checkOverflow(void) {
+    MPUSyncGroup group;
+    int failed = 0, n, i, waited = 0;
+
+    setup(&group);
+    I2CfsyncTick(1);
+    I2CfsyncTick(0);
+    failed += expect(pollAligned(&group) == 2, "group locks");
+
+    // sensor 2 overflows while the queues of the others are full
+    for (i = 0; i < 20; i++) I2CfsyncTick(0);
+    for (i = 0; i < 80; i++) I2CfsyncPush(2, 0);
+    n = pollAligned(&group);
+    failed += expect(n >= 0 && group.stats.overflows == 1, "overflow is seen");
+    failed += expect(group.state[2] == MPU6050_SYNC_WAIT && I2CfsyncDevices[2].count == 0, "overflowing sensor is reset");
+    for (i = 0; i < n; i++) {
+        if (frames[i].sample[2].status == MPU6050_SYNC_NO_DATA) waited++;
+    }
+    failed += expect(waited > 0 && frames[n - 1].sample[2].status == MPU6050_SYNC_NO_DATA, "frames go on without it");
+    // it rejoins at the next strobe with the others
+    I2CfsyncDevices[2].tick = I2CfsyncDevices[0].tick;
+    I2CfsyncTick(0);
+    I2CfsyncTick(1);
+    I2CfsyncTick(0);
+    n = pollAligned(&group);
+    failed += expect(n == 3 && frames[0].sample[2].status == MPU6050_SYNC_NO_DATA && frames[1].sample[2].status == MPU6050_SYNC_OK &&
+        frames[1].index == 0 && frames[2].sample[2].status == MPU6050_SYNC_OK, "overflowed sensor rejoins at the next strobe");
+
+    // every FIFO overflows: all relock
+    for (i = 0; i < 80; i++) I2CfsyncTick(0);
+    n = pollAligned(&group);
+    failed += expect(group.stats.overflows == 4, "every overflow is seen");
+    I2CfsyncTick(0);
+    failed += expect(MPUsyncPoll(&group, frames, MAX_FRAMES) == 0, "no frames until the next strobe");
+    I2CfsyncTick(1);
+    failed += expect(pollAligned(&group) == 1 && frames[0].sample[0].status == MPU6050_SYNC_OK && frames[0].sample[2].status == MPU6050_SYNC_OK, "group relocks");
+    return failed;
+}
+
+static int checkBusError(void) {
+    MPUSyncGroup group;
+    int failed = 0, n, i, stale = 0;
+
+    setup(&group);
+    I2CfsyncTick(1);
+    I2CfsyncTick(0);
+    failed += expect(pollAligned(&group) == 2, "group locks");
+
+    // sensor 1 stops answering: no data is made up for it, the others go on
+    I2CfsyncDevices[1].dead = 1;
+    for (i = 0; i < 5; i++) I2CfsyncTick(0);
+    n = pollAligned(&group);
+    for (i = 0; i < n; i++) {
+        if (frames[i].sample[1].status != MPU6050_SYNC_BUS_ERROR || frames[i].sample[1].accel[0] != 0) stale++;
+    }
+    failed += expect(n == 5 && stale == 0, "lost sensor reports a bus error instead of samples");
+    failed += expect(group.stats.busErrors == 1 && group.state[1] == MPU6050_SYNC_LOST, "bus error is counted once");
+    for (i = 0; i < 3; i++) I2CfsyncTick(0);
+    failed += expect(pollAligned(&group) == 3 && group.stats.busErrors == 1, "lost sensor does not hold the others back");
+
+    // back on the bus: FIFO reset, no data until the next strobe, then aligned
+    I2CfsyncDevices[1].dead = 0;
+    for (i = 0; i < 2; i++) I2CfsyncTick(0);
+    n = pollAligned(&group);
+    failed += expect(n == 2 && group.state[1] == MPU6050_SYNC_WAIT && frames[1].sample[1].status == MPU6050_SYNC_NO_DATA, "sensor waits after it answers again");
+    I2CfsyncTick(0);
+    I2CfsyncTick(1);
+    n = pollAligned(&group);
+    failed += expect(n == 2 && frames[1].index == 0 && frames[1].sample[1].status == MPU6050_SYNC_OK, "sensor rejoins aligned");
+    return failed;
+}
+
+static int check(void) {
+    int failed = checkDecode() + checkLock() + checkOverflow() + checkBusError();
+    printf(failed ? "synccheck check failed\n" : "synccheck check passed\n");
+    return failed;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 2 && strcmp(argv[1], "check") == 0) return check() ? 1 : 0;
+    fprintf(stderr, "usage: %s check\n", argv[0]);
+    return 2;
+}
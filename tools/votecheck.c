@@ -0,0 +1,292 @@
+/* Host checks for redundancy voting (MPU6050/MPU6050_Vote.c)
+ * Feeds MPUvoteUpdate() synthetic sync frames: a common signal that
+ * changes every frame plus per-sensor offsets and faults. MPUvoteCheck()
+ * runs against the FIFO model of i2cdev_fsync.c, a sync group of three.
+ *
+ * Build and run on the host:
+ *     gcc -O2 -Wall -Wno-unused-function -I../i2cdev_chibi/host -I../i2cdev_chibi -I../MPU6050 -o votecheck \
+ *         votecheck.c ../i2cdev_chibi/host/chhost.c ../i2cdev_chibi/host/i2cdev_fsync.c ../i2cdev_chibi/i2cdev_chibi.c \
+ *         ../MPU6050/MPU6050.c ../MPU6050/MPU6050_Sync.c ../MPU6050/MPU6050_Vote.c \
+ *         ../MPU6050/MPU6050_SelfTest.c ../MPU6050/MPU6050_Calibration.c -lm
+ *     ./votecheck check
+ */
+
+/* ============================================
+ChibiOS I2Cdev MPU6050 host tools are placed under the MIT license
+Copyright (c) 2012 Jan Schlemminger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "MPU6050.h"
+#include "MPU6050_Vote.h"
+#include "i2cdev_fsync.h"
+#include "toolcheck.h"
+
+static const MPUVoteConfig config = { 500, 200, 300, 100, 3, 5 };
+
+// the common signal at frame k, every sensor starts from it
+static void frameAt(MPUSyncFrame *frame, uint32_t k, uint8_t count) {
+    uint8_t s, axis;
+    memset(frame, 0, sizeof(*frame));
+    frame -> index = k;
+    for (s = 0; s < count; s++) {
+        for (axis = 0; axis < 3; axis++) {
+            frame -> sample[s].accel[axis] = (int16_t)(1000 * axis + 7 * (k % 50));
+            frame -> sample[s].gyro[axis] = (int16_t)(-100 * axis + 3 * (k % 50));
+        }
+        frame -> sample[s].status = MPU6050_SYNC_OK;
+    }
+}
+
+static int checkInit(void) {
+    MPUVote vote;
+    MPUVoteConfig bad = config;
+    int failed = 0;
+
+    failed += expect(MPUvoteInit(&vote, 3, &config), "valid config accepted");
+    failed += expect(!MPUvoteInit(&vote, 0, &config) && !MPUvoteInit(&vote, MPU6050_SYNC_MAX_SENSORS + 1, &config), "sensor count out of range rejected");
+    bad.persist = 0;
+    failed += expect(!MPUvoteInit(&vote, 3, &bad), "persist 0 rejected");
+    bad = config;
+    bad.stuckSamples = 0;
+    failed += expect(!MPUvoteInit(&vote, 3, &bad), "stuckSamples 0 rejected");
+    return failed;
+}
+
+static int checkMedian(void) {
+    static const int16_t offsets[4] = { -40, 200, 0, 900 };
+    MPUVote vote;
+    MPUSyncFrame frame;
+    MPUVoteOutput out;
+    int failed = 0;
+    uint8_t s;
+
+    // odd count: the middle one
+    MPUvoteInit(&vote, 3, &config);
+    frameAt(&frame, 1, 3);
+    for (s = 0; s < 3; s++) frame.sample[s].accel[0] += offsets[s];
+    failed += expect(MPUvoteUpdate(&vote, &frame, &out) && out.used == 3 && out.accel[0] == 7, "median of three");
+    failed += expect(out.accel[1] == 1007 && out.gyro[2] == -197 && out.agreed, "unchanged axes pass through");
+    // even count: mean of the two middle values
+    MPUvoteInit(&vote, 4, &config);
+    frameAt(&frame, 1, 4);
+    for (s = 0; s < 4; s++) frame.sample[s].accel[0] += offsets[s];
+    failed += expect(MPUvoteUpdate(&vote, &frame, &out) && out.used == 4 && out.accel[0] == 7 + 100, "median of four");
+    failed += expect(out.outliers == 0x08, "far sensor is an outlier");
+    MPUvoteInit(&vote, 2, &config);
+    frameAt(&frame, 1, 2);
+    frame.sample[0].gyro[1] += 100;
+    failed += expect(MPUvoteUpdate(&vote, &frame, &out) && out.used == 2 && out.gyro[1] == -97 + 50 && out.agreed, "two sensors average");
+    return failed;
+}
+
+/* Run a group for frames, the last sensor disturbed by the callback.
+ * Returns the frame its fault appeared in, 0 if never. */
+static uint32_t runFault(MPUVote *vote, uint8_t count, void (*disturb)(MPUSyncSample *sample, uint32_t k), uint32_t frames, int *steps) {
+    MPUSyncFrame frame;
+    MPUVoteOutput out;
+    uint32_t k;
+
+    MPUvoteInit(vote, count, &config);
+    *steps = 0;
+    for (k = 1; k <= frames; k++) {
+        frameAt(&frame, k, count);
+        disturb(&frame.sample[count - 1], k);
+        MPUvoteUpdate(vote, &frame, &out);
+        // the vote follows the common signal while the sensor fails
+        if (count >= 3 && (out.accel[0] != frame.sample[0].accel[0] || out.gyro[0] != frame.sample[0].gyro[0])) (*steps)++;
+        if (vote -> fault[count - 1]) return k;
+    }
+    return 0;
+}
+
+// frozen at frame 1, close enough to the signal for the residual limits
+static void stuck(MPUSyncSample *sample, uint32_t k) {
+    MPUSyncFrame first;
+    (void)k;
+    frameAt(&first, 1, 1);
+    *sample = first.sample[0];
+}
+
+static void saturated(MPUSyncSample *sample, uint32_t k) {
+    (void)k;
+    sample -> gyro[2] = 32767;
+}
+
+static void offset(MPUSyncSample *sample, uint32_t k) {
+    (void)k;
+    sample -> accel[2] += 800;
+}
+
+static void noisy(MPUSyncSample *sample, uint32_t k) {
+    sample -> gyro[0] += (k & 1) ? 150 : -150;
+}
+
+static void healthy(MPUSyncSample *sample, uint32_t k) {
+    sample -> accel[1] += (k & 1) ? 30 : -30;
+    sample -> gyro[1] += 20;
+}
+
+static int checkIsolation(void) {
+    MPUVote vote;
+    uint32_t k;
+    int failed = 0, steps;
+
+    k = runFault(&vote, 3, stuck, 100, &steps);
+    // frame 1 sets the history, then stuckSamples identical frames
+    failed += expect(k == 1 + (uint32_t)config.stuckSamples && vote.fault[2] == MPU6050_VOTE_STUCK, "stuck sensor isolated");
+    k = runFault(&vote, 3, saturated, 100, &steps);
+    failed += expect(k != 0 && k <= config.persist && MPUvoteHealthy(&vote) == 0x03, "saturated sensor isolated");
+    // out of two the residual checks are off, saturation alone isolates
+    k = runFault(&vote, 2, saturated, 100, &steps);
+    failed += expect(k == (uint32_t)config.persist && vote.fault[1] == MPU6050_VOTE_SATURATED, "saturated sensor isolated out of two");
+    k = runFault(&vote, 3, offset, 100, &steps);
+    failed += expect(k == (uint32_t)config.persist && vote.fault[2] == MPU6050_VOTE_RESIDUAL, "offset sensor isolated by residual");
+    failed += expect(steps == 0 && vote.stats.failovers == 1 && MPUvoteHealthy(&vote) == 0x03, "output does not step at the failover");
+    k = runFault(&vote, 3, noisy, 100, &steps);
+    failed += expect(k > 1 && vote.fault[2] == MPU6050_VOTE_NOISY, "noisy sensor isolated");
+    k = runFault(&vote, 3, healthy, 1000, &steps);
+    failed += expect(k == 0 && vote.stats.failovers == 0, "sensor within the limits stays in");
+    return failed;
+}
+
+static int checkTwo(void) {
+    MPUVote vote;
+    MPUSyncFrame frame;
+    MPUVoteOutput out;
+    uint32_t k;
+    int failed = 0, agreed = 0;
+
+    MPUvoteInit(&vote, 2, &config);
+    for (k = 1; k <= 50; k++) {
+        frameAt(&frame, k, 2);
+        frame.sample[1].accel[2] += 1200;
+        MPUvoteUpdate(&vote, &frame, &out);
+        if (out.agreed) agreed++;
+    }
+    failed += expect(agreed == 0 && vote.stats.disagreed == 50 && out.used == 2 && out.outliers == 0x03, "two disagreeing sensors are flagged");
+    failed += expect(MPUvoteHealthy(&vote) == 0x03 && out.accel[2] == frame.sample[0].accel[2] + 600, "neither is isolated on a residual");
+    for (k = 51; k <= 60; k++) {
+        frameAt(&frame, k, 2);
+        frame.sample[1].accel[0] = frame.sample[1].accel[1] = frame.sample[1].accel[2] = 5;
+        frame.sample[1].gyro[0] = frame.sample[1].gyro[1] = frame.sample[1].gyro[2] = 5;
+        MPUvoteUpdate(&vote, &frame, &out);
+    }
+    failed += expect(vote.fault[1] == MPU6050_VOTE_STUCK && out.used == 1 && out.agreed && out.accel[0] == frame.sample[0].accel[0], "stuck sensor isolated out of two");
+    return failed;
+}
+
+static int checkBus(void) {
+    MPUVote vote;
+    MPUSyncFrame frame;
+    MPUVoteOutput out;
+    int failed = 0;
+    bool_t ok;
+
+    MPUvoteInit(&vote, 3, &config);
+    frameAt(&frame, 1, 3);
+    frame.sample[0].accel[0] += 300;
+    MPUvoteUpdate(&vote, &frame, &out);
+
+    // relocking after an overflow: out of this frame only
+    frameAt(&frame, 2, 3);
+    frame.sample[0].accel[0] += 300;
+    frame.sample[1].status = MPU6050_SYNC_NO_DATA;
+    ok = MPUvoteUpdate(&vote, &frame, &out);
+    failed += expect(ok && out.used == 2 && out.accel[0] == frame.sample[2].accel[0] + 150 && vote.fault[1] == 0, "sensor without data sits the frame out");
+
+    // bus error: faulted in the same frame, its empty sample never votes
+    frameAt(&frame, 3, 3);
+    frame.sample[1].status = MPU6050_SYNC_BUS_ERROR;
+    memset(frame.sample[1].accel, 0, sizeof(frame.sample[1].accel));
+    memset(frame.sample[1].gyro, 0, sizeof(frame.sample[1].gyro));
+    ok = MPUvoteUpdate(&vote, &frame, &out);
+    failed += expect(ok && vote.fault[1] == MPU6050_VOTE_NO_ANSWER && out.used == 2 && out.accel[1] == frame.sample[0].accel[1], "bus error faults the sensor in the same frame");
+    failed += expect(vote.stats.failovers == 1 && MPUvoteHealthy(&vote) == 0x05, "bus error counted as a failover");
+
+    // nothing left: the last output is held
+    frameAt(&frame, 4, 3);
+    frame.sample[0].status = MPU6050_SYNC_BUS_ERROR;
+    frame.sample[2].status = MPU6050_SYNC_BUS_ERROR;
+    ok = MPUvoteUpdate(&vote, &frame, &out);
+    failed += expect(!ok && out.used == 0 && !out.agreed && vote.stats.outages == 1 && out.accel[1] == 1007 + 14, "outage holds the last output");
+    return failed;
+}
+
+/* A self-test restarts only the tested sensor's FIFO: the others stay
+ * locked and keep voting, it rejoins at the next strobe. The FIFO model
+ * does not sample while the self-test waits, so the test itself fails
+ * for lack of data and the sensor stays out of the vote. */
+static int checkRecheck(void) {
+    static const uint8_t addresses[3] = { MPU6050_DEFAULT_ADDRESS, MPU6050_DEFAULT_ADDRESS + 1, MPU6050_DEFAULT_ADDRESS + 2 };
+    static const MPUSyncConfig syncConfig = { 0, MPU6050_CLOCK_PLL_EXT32K, MPU6050_EXT_SYNC_TEMP_OUT_L, 0, MPU6050_DLPF_BW_188 };
+    MPUSyncGroup group;
+    MPUSyncFrame frames[8];
+    MPUVote vote;
+    MPUVoteOutput out;
+    int failed = 0, n, i, voted = 0, waiting = 0;
+
+    I2CfsyncStart();
+    MPUsyncInit(&group, addresses, 3, &syncConfig);
+    MPUsyncStart(&group);
+    MPUvoteInit(&vote, 3, &config);
+    I2CfsyncTick(1);
+    I2CfsyncTick(0);
+    n = MPUsyncPoll(&group, frames, 8);
+    for (i = 0; i < n; i++) if (MPUvoteUpdate(&vote, &frames[i], &out) && out.used == 3) voted++;
+    failed += expect(n == 2 && voted == 2, "group locks and votes");
+
+    failed += expect(MPUvoteCheck(&vote, &group, 1, TRUE) == MPU6050_VOTE_SELFTEST, "self-test without samples fails");
+    failed += expect(group.state[0] == MPU6050_SYNC_LOCKED && group.state[1] == MPU6050_SYNC_WAIT && group.state[2] == MPU6050_SYNC_LOCKED,
+        "only the tested sensor restarts");
+    voted = 0;
+    for (i = 0; i < 4; i++) I2CfsyncTick(0);
+    n = MPUsyncPoll(&group, frames, 8);
+    for (i = 0; i < n; i++) {
+        if (MPUvoteUpdate(&vote, &frames[i], &out) && out.used == 2 && out.agreed) voted++;
+        if (frames[i].sample[1].status == MPU6050_SYNC_NO_DATA) waiting++;
+    }
+    failed += expect(n == 4 && voted == 4 && waiting == 4, "the others keep voting before the next strobe");
+
+    I2CfsyncTick(1);
+    I2CfsyncTick(0);
+    n = MPUsyncPoll(&group, frames, 8);
+    failed += expect(n == 2 && frames[0].index == 0 && frames[0].sample[1].status == MPU6050_SYNC_OK &&
+        frames[0].sample[1].accel[0] == frames[0].sample[0].accel[0], "tested sensor rejoins aligned at the strobe");
+    return failed;
+}
+
+static int check(void) {
+    int failed = checkInit() + checkMedian() + checkIsolation() + checkTwo() + checkBus() + checkRecheck();
+    printf(failed ? "votecheck check failed\n" : "votecheck check passed\n");
+    return failed;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 2 && strcmp(argv[1], "check") == 0) return check() ? 1 : 0;
+    fprintf(stderr, "usage: %s check\n", argv[0]);
+    return 2;
+}